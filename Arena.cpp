@@ -0,0 +1,66 @@
+#include "Arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+
+namespace falcon_ui {
+
+namespace {
+
+std::byte* AlignUp(std::byte* p, size_t alignment) {
+    const auto value = reinterpret_cast<uintptr_t>(p);
+    return reinterpret_cast<std::byte*>((value + alignment - 1) & ~(uintptr_t{ alignment } - 1));
+}
+
+}  // namespace
+
+Arena& Arena::operator=(Arena&& other) noexcept {
+    if (this == &other) return *this;
+    Reset();
+    std::swap(last_block_, other.last_block_);
+    std::swap(block_count_, other.block_count_);
+    std::swap(cursor_, other.cursor_);
+    std::swap(end_, other.end_);
+    std::swap(bytes_used_, other.bytes_used_);
+    return *this;
+}
+
+void Arena::Reserve(size_t bytes) {
+    const auto available = static_cast<size_t>(end_ - cursor_);
+    if (available >= bytes + alignof(std::max_align_t)) return;
+    AddBlock(bytes + alignof(std::max_align_t));
+}
+
+void Arena::Reset() {
+    while (last_block_ != nullptr) {
+        auto* previous = last_block_->previous;
+        ::operator delete(last_block_);
+        last_block_ = previous;
+    }
+    block_count_ = 0;
+    cursor_ = end_ = nullptr;
+    bytes_used_ = 0;
+}
+
+void* Arena::Allocate(size_t bytes, size_t alignment) {
+    auto* p = AlignUp(cursor_, alignment);
+    if (cursor_ == nullptr || p + bytes > end_) {
+        // Does not fit, continue in a new block. The rest of the current one is wasted.
+        AddBlock(std::max(bytes + alignment, kMinBlockSize));
+        p = AlignUp(cursor_, alignment);
+    }
+    cursor_ = p + bytes;
+    bytes_used_ += bytes;
+    return p;
+}
+
+void Arena::AddBlock(size_t bytes) {
+    auto* memory = static_cast<std::byte*>(::operator new(sizeof(Block) + bytes));
+    last_block_ = new (memory) Block{ last_block_ };
+    ++block_count_;
+    cursor_ = memory + sizeof(Block);
+    end_ = cursor_ + bytes;
+}
+
+}  // namespace falcon_ui
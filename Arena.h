@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace falcon_ui {
+
+// Bump allocator. Everything allocated lives until the arena is reset or destroyed, and is released at once
+// (objects are never destroyed one by one, so only trivially destructible types are allowed).
+// Reserve() the expected size up front and the whole arena is a single allocation.
+class Arena {
+public:
+    Arena() = default;
+    ~Arena() { Reset(); }
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&& other) noexcept { *this = std::move(other); }
+    Arena& operator=(Arena&& other) noexcept;
+
+    // Makes sure the next bytes (plus alignment padding) come from one block.
+    void Reserve(size_t bytes);
+
+    // Releases all blocks.
+    void Reset();
+
+    void* Allocate(size_t bytes, size_t alignment);
+
+    template <typename T, typename... Args>
+    T* New(Args&&... args) {
+        static_assert(std::is_trivially_destructible_v<T>, "Arena objects are never destroyed");
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Uninitialized storage for count Ts.
+    template <typename T>
+    T* AllocateArray(size_t count) {
+        static_assert(std::is_trivially_destructible_v<T>, "Arena objects are never destroyed");
+        if (count == 0) return nullptr;
+        return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Bytes handed out so far.
+    size_t BytesUsed() const { return bytes_used_; }
+    size_t BlockCount() const { return block_count_; }
+
+private:
+    static constexpr size_t kMinBlockSize = 4096;
+
+    // Blocks are chained through a header at their start, so a single block is a single allocation.
+    struct Block {
+        Block* previous;
+    };
+
+    void AddBlock(size_t bytes);
+
+    Block* last_block_ = nullptr;
+    size_t block_count_ = 0;
+    std::byte* cursor_ = nullptr;
+    std::byte* end_ = nullptr;
+    size_t bytes_used_ = 0;
+};
+
+}  // namespace falcon_ui
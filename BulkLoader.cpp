@@ -0,0 +1,101 @@
+#include "BulkLoader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "ParallelFor.h"
+#include "Tracing.h"
+
+
+namespace falcon_ui {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Lists every window of the theater. Only reads the small .lst files, the windows are loaded later in parallel.
+void AddTheaterWindows(const std::string& install_dir, const std::string& theater, UiType ui_type, std::vector<LoadedWindow>& windows) {
+    FALCON_UI_TRACE_SCOPE_DETAIL("AddTheaterWindows", theater);
+    const auto data_dir = install_dir + DataDirForTheater(theater);
+    for (const auto& ui_set : ListUISets(data_dir, ui_type)) {
+        for (auto& window_path : GetWindowList(data_dir, ui_set, ui_type)) {
+            auto& window = windows.emplace_back();
+            window.install_dir = install_dir;
+            window.theater = theater;
+            window.ui_set = ui_set;
+            window.full_path = NativePath(data_dir + "\\" + window_path);
+            window.window_path = std::move(window_path);
+        }
+    }
+}
+
+void AddInstallationWindows(const std::string& install_dir, UiType ui_type, std::vector<LoadedWindow>& windows) {
+    for (const auto& theater : ListTheaters(install_dir)) {
+        AddTheaterWindows(install_dir, theater, ui_type, windows);
+    }
+}
+
+std::shared_ptr<const BulkLoadResult> LoadWindows(std::vector<LoadedWindow> windows, const BulkLoadOptions& options) {
+    auto result = std::make_shared<BulkLoadResult>();
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    result->thread_count = static_cast<unsigned>(std::min<size_t>(options.thread_count != 0 ? options.thread_count : cores, std::max<size_t>(windows.size(), 1)));
+
+    FALCON_UI_TRACE_SCOPE("LoadWindows");
+    std::atomic<size_t> loaded{ 0 };
+    const auto start = Clock::now();
+    ParallelFor(windows.size(), result->thread_count, "Loader", [&windows, &options, &loaded](size_t i, unsigned worker) {
+        auto& window = windows[i];
+        if (options.cancel.Cancelled()) return;
+        FALCON_UI_TRACE_SCOPE_DETAIL("LoadWindow", window.full_path);
+        const auto window_start = Clock::now();
+        if (options.cache != nullptr) {
+            options.cache->Load(window.full_path, window.window);
+        } else {
+            window.window.SetupFromFile(window.full_path);
+        }
+        window.load_time = Clock::now() - window_start;
+        window.worker = worker;
+        FALCON_UI_TRACE_COUNTER("Windows loaded", loaded.fetch_add(1, std::memory_order_relaxed) + 1);
+    });
+    result->wall_time = Clock::now() - start;
+
+    for (const auto& window : windows) {
+        result->busy_time += window.load_time;
+    }
+    result->windows = std::move(windows);
+    return result;
+}
+
+}  // namespace
+
+std::shared_ptr<const BulkLoadResult> LoadTheater(const std::string& install_dir, const std::string& theater, const BulkLoadOptions& options) {
+    std::vector<LoadedWindow> windows;
+    AddTheaterWindows(install_dir, theater, options.ui_type, windows);
+    return LoadWindows(std::move(windows), options);
+}
+
+std::shared_ptr<const BulkLoadResult> LoadTheaters(const std::vector<TheaterLocation>& theaters, const BulkLoadOptions& options) {
+    std::vector<LoadedWindow> windows;
+    for (const auto& location : theaters) {
+        AddTheaterWindows(location.install_dir, location.theater, options.ui_type, windows);
+    }
+    return LoadWindows(std::move(windows), options);
+}
+
+std::shared_ptr<const BulkLoadResult> LoadInstallation(const std::string& install_dir, const BulkLoadOptions& options) {
+    std::vector<LoadedWindow> windows;
+    AddInstallationWindows(install_dir, options.ui_type, windows);
+    return LoadWindows(std::move(windows), options);
+}
+
+std::shared_ptr<const BulkLoadResult> LoadAllInstallations(const BulkLoadOptions& options) {
+    std::vector<LoadedWindow> windows;
+    for (const auto& installation : GetAllBMSInstallations()) {
+        AddInstallationWindows(InstallDirForInstallation(installation), options.ui_type, windows);
+    }
+    return LoadWindows(std::move(windows), options);
+}
+
+}  // namespace falcon_ui
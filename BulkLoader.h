@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "FalconWindow.h"
+#include "Header.h"
+#include "JobSystem.h"
+#include "ModelCache.h"
+
+
+namespace falcon_ui {
+
+// One window loaded by the bulk loader, with where it came from and how long it took.
+struct LoadedWindow {
+    std::string install_dir;
+    std::string theater;
+    std::string ui_set;
+    // As listed in the UI set window list (relative to the theater data dir).
+    std::string window_path;
+    std::string full_path;
+    Window window;
+    std::chrono::nanoseconds load_time{};
+    // Thread which loaded it (0 based), for load balancing analysis.
+    unsigned worker = 0;
+};
+
+// The result of a bulk load. It is never modified after the load, so it can be shared between threads.
+struct BulkLoadResult {
+    std::vector<LoadedWindow> windows;
+    std::chrono::nanoseconds wall_time{};
+    // Sum of all load_time, compare with wall_time * thread_count for the parallel efficiency.
+    std::chrono::nanoseconds busy_time{};
+    unsigned thread_count = 0;
+};
+
+struct BulkLoadOptions {
+    UiType ui_type = UiType::FHD;
+    // 0 uses one thread per core.
+    unsigned thread_count = 0;
+    // Optional, windows are loaded through it when set.
+    ModelCache* cache = nullptr;
+    // Once cancelled, the windows not loaded yet are left empty (not done).
+    CancellationToken cancel;
+};
+
+// Loads every window of every UI set of the theater.
+std::shared_ptr<const BulkLoadResult> LoadTheater(const std::string& install_dir, const std::string& theater, const BulkLoadOptions& options = {});
+
+// A theater of an installation.
+struct TheaterLocation {
+    std::string install_dir;
+    std::string theater;
+};
+
+// Loads every window of every UI set of the theaters, in one parallel load.
+std::shared_ptr<const BulkLoadResult> LoadTheaters(const std::vector<TheaterLocation>& theaters, const BulkLoadOptions& options = {});
+
+// Loads every window of every theater of the installation.
+std::shared_ptr<const BulkLoadResult> LoadInstallation(const std::string& install_dir, const BulkLoadOptions& options = {});
+
+// Loads every window of every theater of all BMS installations (see GetAllBMSInstallations).
+std::shared_ptr<const BulkLoadResult> LoadAllInstallations(const BulkLoadOptions& options = {});
+
+}  // namespace falcon_ui
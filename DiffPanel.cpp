@@ -0,0 +1,137 @@
+#include "DiffPanel.h"
+
+#include "imgui.h"
+#include "ScfSchema.h"
+#include "SymbolTable.h"
+#include "Tracing.h"
+
+
+namespace falcon_ui {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* DiffKindName(DiffKind kind) {
+    switch (kind) {
+        case DiffKind::ADDED: return "Added";
+        case DiffKind::REMOVED: return "Removed";
+        case DiffKind::CHANGED: return "Changed";
+    }
+    return "";
+}
+
+// "[BUTTON] IA_MAIN_CTRL" for an element of window.
+std::string ElementName(const Window& window, uint32_t index) {
+    const auto& model = window.Model();
+    const auto& element = model.elements[index];
+    const auto* spec = SpecForTag(element.tag);
+    std::string name(spec != nullptr ? spec->name : "?");
+    for (const auto& attribute : model.attributes.subspan(element.first_attribute, element.attribute_count)) {
+        if (attribute.tag != Tag::SETUP) continue;
+        name += ' ';
+        name += SymbolTable::Global().Name(attribute.setup.label);
+        break;
+    }
+    return name;
+}
+
+double Milliseconds(std::chrono::nanoseconds duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+}  // namespace
+
+void DiffPanel::DrawSide(const char* id, Side& side, const std::vector<std::string>& installations, DiscoveryCatalog& catalog) {
+    ImGui::PushID(id);
+    ImGui::SetNextItemWidth(ImGui::GetFontSize() * 14.0f);
+    if (ImGui::BeginCombo("Installation", side.installation.c_str())) {
+        for (const auto& installation : installations) {
+            if (ImGui::Selectable(installation.c_str(), installation == side.installation)) {
+                side.installation = installation;
+                side.install_dir = InstallDirForInstallation(installation);
+                side.theater = "Default";
+            }
+        }
+        ImGui::EndCombo();
+    }
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(ImGui::GetFontSize() * 10.0f);
+    if (ImGui::BeginCombo("Theater", side.theater.c_str())) {
+        if (!side.install_dir.empty()) {
+            for (const auto& theater : catalog.Theaters(side.install_dir)) {
+                if (ImGui::Selectable(theater.c_str(), theater == side.theater)) side.theater = theater;
+            }
+        }
+        ImGui::EndCombo();
+    }
+    ImGui::PopID();
+}
+
+void DiffPanel::Compare() {
+    if (Comparing() || left_.install_dir.empty() || right_.install_dir.empty()) return;
+    pending_ = JobSystem::Get().Submit(JobPriority::BACKGROUND, [left = left_, right = right_, cache = cache_](const CancellationToken& token) {
+        auto comparison = std::make_unique<Comparison>();
+        BulkLoadOptions options;
+        options.cache = cache;
+        options.cancel = token;
+        const auto start = Clock::now();
+        comparison->left = LoadTheater(left.install_dir, left.theater, options);
+        comparison->right = LoadTheater(right.install_dir, right.theater, options);
+        // Nobody waits for the result anymore.
+        if (token.Cancelled()) return comparison;
+        const auto loaded = Clock::now();
+        comparison->diff = DiffTrees(*comparison->left, *comparison->right);
+        comparison->load_time = loaded - start;
+        comparison->diff_time = Clock::now() - loaded;
+        return comparison;
+    });
+}
+
+void DiffPanel::FinishComparing() {
+    if (!pending_.Ready()) return;
+    comparison_ = pending_.Get();
+}
+
+void DiffPanel::Draw(bool* open, const std::vector<std::string>& installations, DiscoveryCatalog& catalog) {
+    FinishComparing();
+    if (!ImGui::Begin("Compare Theaters", open)) {
+        ImGui::End();
+        return;
+    }
+    DrawSide("Left", left_, installations, catalog);
+    DrawSide("Right", right_, installations, catalog);
+    ImGui::BeginDisabled(Comparing() || left_.install_dir.empty() || right_.install_dir.empty());
+    if (ImGui::Button("Compare")) Compare();
+    ImGui::EndDisabled();
+    if (Comparing()) {
+        ImGui::SameLine();
+        ImGui::TextUnformatted("Comparing...");
+    }
+    if (comparison_ != nullptr) DrawComparison();
+    ImGui::End();
+}
+
+void DiffPanel::DrawComparison() const {
+    const auto& diff = comparison_->diff;
+    ImGui::Text("%zu identical, %zu different windows. Loaded in %.0f ms, compared in %.1f ms", diff.identical_windows, diff.windows.size(), Milliseconds(comparison_->load_time), Milliseconds(comparison_->diff_time));
+    if (!ImGui::BeginChild("Windows")) {
+        ImGui::EndChild();
+        return;
+    }
+    for (const auto& window_diff : diff.windows) {
+        const auto flags = window_diff.elements.empty() ? ImGuiTreeNodeFlags_Leaf : ImGuiTreeNodeFlags_None;
+        if (!ImGui::TreeNodeEx(window_diff.window_path.c_str(), flags, "%s %s", DiffKindName(window_diff.kind), window_diff.window_path.c_str())) continue;
+        for (const auto& element_diff : window_diff.elements) {
+            // Added elements only exist on the right, the others are named from the left.
+            const bool from_right = element_diff.left == ElementDiff::kNone;
+            const auto& window = from_right ? comparison_->right->windows[window_diff.right].window : comparison_->left->windows[window_diff.left].window;
+            const auto name = ElementName(window, from_right ? element_diff.right : element_diff.left);
+            ImGui::BulletText("%s %s", DiffKindName(element_diff.kind), name.c_str());
+        }
+        ImGui::TreePop();
+    }
+    ImGui::EndChild();
+}
+
+}  // namespace falcon_ui
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BulkLoader.h"
+#include "DiscoveryCatalog.h"
+#include "JobSystem.h"
+#include "ModelCache.h"
+#include "TreeDiff.h"
+
+
+namespace falcon_ui {
+
+// ImGui window comparing the windows of two theaters, of the same installation (a theater against the default one) or
+// of two installations. Both sides are loaded and diffed on a background thread. Used from the UI thread.
+class DiffPanel {
+public:
+    // cache is optional, and must outlive the panel.
+    explicit DiffPanel(ModelCache* cache) : cache_(cache) {}
+
+    // True while comparing, the UI must keep drawing frames to pick up the result.
+    bool Comparing() const { return pending_.Valid(); }
+
+    // installations are the names of the BMS installations, catalog lists their theaters.
+    void Draw(bool* open, const std::vector<std::string>& installations, DiscoveryCatalog& catalog);
+
+private:
+    struct Side {
+        std::string installation;
+        std::string install_dir;
+        std::string theater;
+    };
+
+    struct Comparison {
+        std::shared_ptr<const BulkLoadResult> left;
+        std::shared_ptr<const BulkLoadResult> right;
+        TreeDiff diff;
+        std::chrono::nanoseconds load_time{};
+        std::chrono::nanoseconds diff_time{};
+    };
+
+    void DrawSide(const char* id, Side& side, const std::vector<std::string>& installations, DiscoveryCatalog& catalog);
+    void Compare();
+    // Swaps in the comparison done in the background, if it is done.
+    void FinishComparing();
+    void DrawComparison() const;
+
+    ModelCache* cache_;
+    Side left_;
+    Side right_;
+    std::unique_ptr<Comparison> comparison_;
+    // Its destructor cancels the comparison and waits for it.
+    JobFuture<std::unique_ptr<Comparison>> pending_;
+};
+
+}  // namespace falcon_ui
@@ -0,0 +1,68 @@
+#include "DiscoveryCatalog.h"
+
+
+namespace falcon_ui {
+
+DiscoveryCatalog::DiscoveryCatalog(FileWatcher* watcher, UiType ui_type) : watcher_(watcher), ui_type_(ui_type) {}
+
+DiscoveryCatalog::~DiscoveryCatalog() {
+    if (watcher_ == nullptr) return;
+    for (const auto& [path, list] : lists_) {
+        if (!list.watched) continue;
+        if (list.directory) {
+            watcher_->UnwatchDirectory(path);
+        } else {
+            watcher_->Unwatch(path);
+        }
+    }
+}
+
+template <typename Read>
+const std::vector<std::string>& DiscoveryCatalog::Get(const std::string& path, bool directory, const Read& read) {
+    auto& list = lists_[path];
+    if (list.valid) return list.items;
+
+    // Watched before reading, so a change made while reading is not missed.
+    if (watcher_ != nullptr && !list.watched) {
+        list.directory = directory;
+        list.watched = directory ? watcher_->WatchDirectory(path) : watcher_->Watch(path);
+    }
+    list.items = read();
+    list.valid = true;
+    return list.items;
+}
+
+const std::vector<std::string>& DiscoveryCatalog::Theaters(const std::string& install_dir) {
+    return Get(TheaterListPath(install_dir), false, [&install_dir] { return ListTheaters(install_dir); });
+}
+
+const std::vector<std::string>& DiscoveryCatalog::UISets(const std::string& theater_data_dir) {
+    return Get(ArtDirForTheater(theater_data_dir), true, [this, &theater_data_dir] { return ListUISets(theater_data_dir, ui_type_); });
+}
+
+const std::vector<std::string>& DiscoveryCatalog::Windows(const std::string& theater_data_dir, const std::string& ui_set) {
+    return Get(WindowListPath(theater_data_dir, ui_set, ui_type_), false, [this, &theater_data_dir, &ui_set] { return GetWindowList(theater_data_dir, ui_set, ui_type_); });
+}
+
+const std::optional<WindowHeader>& DiscoveryCatalog::Header(const std::string& window_path) {
+    // A stat per call, the pick screen asks for the header of the selected window every frame.
+    const auto key = StatFile(window_path);
+    const auto [it, added] = headers_.try_emplace(window_path);
+    auto& cached = it->second;
+    if (added || cached.key != key) {
+        cached.key = key;
+        cached.header = key.has_value() ? ReadWindowHeader(window_path) : std::nullopt;
+    }
+    return cached.header;
+}
+
+bool DiscoveryCatalog::Invalidate(const std::string& path) {
+    headers_.erase(path);
+    const auto it = lists_.find(path);
+    if (it == lists_.end()) return false;
+    // Still watched, the list is read again the next time it is asked for.
+    it->second.valid = false;
+    return true;
+}
+
+}  // namespace falcon_ui
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "FalconWindow.h"
+#include "FileUtil.h"
+#include "FileWatcher.h"
+#include "Header.h"
+
+
+namespace falcon_ui {
+
+// In memory copy of the lists the pick screens show: the theaters of an installation, the UI sets of a theater (from
+// the window lists in its Art folder) and the windows of a UI set. Each list is read from disk the first time it is
+// asked for and kept until the file (or folder) it was read from changes, so showing the lists does no file I/O.
+// The headers of the windows are kept the same way, read from the first bytes of their files (see ReadWindowHeader).
+// Used from the UI thread only. The returned references stay valid, a list changes when it is read again.
+class DiscoveryCatalog {
+public:
+    // Lists are refreshed when watcher reports a change (see Invalidate). Without a watcher they are never refreshed.
+    explicit DiscoveryCatalog(FileWatcher* watcher = nullptr, UiType ui_type = UiType::FHD);
+    ~DiscoveryCatalog();
+    DiscoveryCatalog(const DiscoveryCatalog&) = delete;
+    DiscoveryCatalog& operator=(const DiscoveryCatalog&) = delete;
+
+    const std::vector<std::string>& Theaters(const std::string& install_dir);
+    const std::vector<std::string>& UISets(const std::string& theater_data_dir);
+    const std::vector<std::string>& Windows(const std::string& theater_data_dir, const std::string& ui_set);
+    // The header of the window file at path, nullopt if it is not a valid window. The files are not watched: a header is
+    // read again when the size or modification time of its file changed, or once its path is passed to Invalidate.
+    const std::optional<WindowHeader>& Header(const std::string& window_path);
+
+    // Marks the list read from path (a change from FileWatcher::PollChanges) to be read again. Returns true if path was
+    // one of the lists. Also drops the header of the window at path, which does not count as a list.
+    bool Invalidate(const std::string& path);
+
+private:
+    struct List {
+        std::vector<std::string> items;
+        bool valid = false;
+        bool watched = false;
+        bool directory = false;
+    };
+
+    struct CachedHeader {
+        // Of the file when the header was read, nullopt if it could not be.
+        std::optional<FileKey> key;
+        std::optional<WindowHeader> header;
+    };
+
+    template <typename Read>
+    const std::vector<std::string>& Get(const std::string& path, bool directory, const Read& read);
+
+    FileWatcher* watcher_;
+    UiType ui_type_;
+    // Lists by the path of the file (or folder for the UI sets) they are read from.
+    std::map<std::string, List> lists_;
+    std::map<std::string, CachedHeader> headers_;
+};
+
+}  // namespace falcon_ui
@@ -1,259 +1,567 @@
 #include "FalconWindow.h"
 
-#include <algorithm> 
-#include <cctype>
+#include <algorithm>
 #include <fstream>
-#include <functional> 
-#include <locale>
-#include <sstream>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <type_traits>
+#include <vector>
 
+#include "FrameProfiler.h"
 #include "imgui.h"
+#include "ScfSchema.h"
+#include "TextureCache.h"
+#include "Tracing.h"
 
 namespace falcon_ui {
 
 namespace {
 
-const char* kSeparators = " \t\n\r\f\v";
+// Returns the [SETUP] record of attributes, if it is the first one and has at least int_count integers.
+const SetupRecord* FirstSetup(std::span<const AttributeRecord> attributes, int int_count) {
+    if (attributes.empty() || attributes.front().tag != Tag::SETUP) return nullptr;
+    const auto& setup = attributes.front().setup;
+    return setup.int_count >= int_count ? &setup : nullptr;
+}
+
+// The header of a root window with attributes, if they start with a [SETUP] with a size within the limits.
+std::optional<WindowHeader> RootHeader(std::span<const AttributeRecord> attributes) {
+    // Sample: [SETUP] UI_MAIN_SCREEN C_TYPE_NORMAL 1024 768
+    const auto* setup = FirstSetup(attributes, 2);
+    if (setup == nullptr) return std::nullopt;
+    const WindowHeader header{ setup->label, setup->ctype, setup->ints[0], setup->ints[1] };
+    if (header.width <= 0 || header.height <= 0 || header.width >= kMaxX || header.height >= kMaxY) return std::nullopt;
+    return header;
+}
 
-// trim from end of string (right)
-std::string& rtrim(std::string& s, const char* t = kSeparators) {
-    s.erase(s.find_last_not_of(t) + 1);
-    return s;
+// Returns true if line (trimmed) starts a new element.
+bool IsElementStart(std::string_view line) {
+    const auto* spec = FindTag(line);
+    return spec != nullptr && spec->starts_element;
 }
 
-// trim from beginning of string (left)
-std::string& ltrim(std::string& s, const char* t = kSeparators) {
-    s.erase(0, s.find_first_not_of(t));
-    return s;
+//---------
+// Elements
+//---------
+
+// Setup of each element type, from the attributes of the element. Returns false if the element fails its setup.
+bool SetupWindowElement(std::span<const AttributeRecord> attributes, WindowElement& window) {
+    const auto header = RootHeader(attributes);
+    if (!header.has_value()) return false;
+    window = { header->width, header->height };
+    return true;
 }
 
-// trim from both ends of string (right then left)
-std::string& TrimLine(std::string& s, const char* t = kSeparators) {
-    return ltrim(rtrim(s, t), t);
+bool SetupButtonElement(std::span<const AttributeRecord> attributes, uint32_t index, ButtonElement& button) {
+    // Sample: [SETUP] IA_MAIN_CTRL C_TYPE_NORMAL 12 14
+    const auto* setup = FirstSetup(attributes, 2);
+    if (setup == nullptr) return false;
+    button = { setup->ints[0], setup->ints[1], index };
+    return button.x > -kMaxX && button.y > -kMaxY && button.x < kMaxX && button.y < kMaxY;
 }
 
-bool IsComment(const std::string& line) {
-    return !line.empty() && line[0] == '#';
+bool SetupBitmapElement(std::span<const AttributeRecord> attributes, uint32_t index, BitmapElement& bitmap) {
+    // Sample: [SETUP] NID C_TYPE_NORMAL 191 687 TACTICAL_CANCEL_4
+    const auto* setup = FirstSetup(attributes, 2);
+    if (setup == nullptr || setup->resource.empty()) return false;
+    bitmap = { setup->ints[0], setup->ints[1], setup->resource, index };
+    return bitmap.x > -kMaxX && bitmap.y > -kMaxY && bitmap.x < kMaxX && bitmap.y < kMaxY;
 }
 
-constexpr int kMaxX = 10000;
-constexpr int kMaxY = 10000;
+// True for the tags the elements are made of. The window fails its build on any other element tag.
+bool IsElementType(Tag tag) {
+    return tag == Tag::WINDOW || tag == Tag::BUTTON || tag == Tag::BITMAP || tag == Tag::TILE;
+}
 
-//---------------
-// Window Element
-//---------------
-class WindowElement : public Element {
-public:
-    ElementType Type() const override { return ElementType::WINDOW; }
+void DrawButton(const ButtonElement& button) {
+    ImGui::SetCursorPos(ImVec2(static_cast<float>(button.x), static_cast<float>(button.y)));
+    ImGui::Button("BUTTONTEXT");
+}
 
-    bool Setup() override {
-        if (attributes_.empty()) return false;
-        if (attributes_.at(0).find("[SETUP]") != 0) return false;
-        // Sample: [SETUP] UI_MAIN_SCREEN C_TYPE_NORMAL 1024 768
-        std::string main_type, label, window_ctype;
-        std::stringstream ss(attributes_.at(0));
-        ss >> main_type >> label >> window_ctype >> width_ >> height_;
-        if (width_ <= 0 || height_ <= 0 || width_ >= kMaxX || height_ >= kMaxY) return false;
-        for (auto& child : children_) {
-            child->Setup();
+// The draw pass of the buttons, inside their window. ImGui would clip the buttons out of sight, but only after measuring
+// their label and hashing their id: they are skipped on their position instead, so the frame costs one read of the
+// position per hidden button and the ImGui calls of the visible ones only.
+void DrawButtons(std::span<const ButtonElement> buttons) {
+    if (buttons.empty()) return;
+    const auto& style = ImGui::GetStyle();
+    const ImVec2 label = ImGui::CalcTextSize("BUTTONTEXT");
+    const ImVec2 size(label.x + style.FramePadding.x * 2.0f, label.y + style.FramePadding.y * 2.0f);
+    // The clip rectangle of the draw list (the scissor of the GPU) in the coordinates of SetCursorPos, widened by a
+    // button so only the buttons wholly out of it are skipped (plus a pixel for the rounding). ImGui clips on the window
+    // rectangle, so it still draws the frames of the buttons past the screen edges, which never show.
+    const ImVec2 origin(ImGui::GetWindowPos().x - ImGui::GetScrollX(), ImGui::GetWindowPos().y - ImGui::GetScrollY());
+    auto* draw_list = ImGui::GetWindowDrawList();
+    const float min_x = draw_list->GetClipRectMin().x - origin.x - size.x - 1.0f;
+    const float min_y = draw_list->GetClipRectMin().y - origin.y - size.y - 1.0f;
+    const float max_x = draw_list->GetClipRectMax().x - origin.x + 1.0f;
+    const float max_y = draw_list->GetClipRectMax().y - origin.y + 1.0f;
+    const bool profiled = FrameProfiler::Get().Enabled();
+    int32_t extent_x = buttons.front().x, extent_y = buttons.front().y;
+    for (const auto& button : buttons) {
+        extent_x = std::max(extent_x, button.x);
+        extent_y = std::max(extent_y, button.y);
+        const auto x = static_cast<float>(button.x), y = static_cast<float>(button.y);
+        if (x < min_x || y < min_y || x > max_x || y > max_y) continue;
+        if (profiled) {
+            ScopedFrameTimer timer(FramePhase::ELEMENT_DRAW, button.index);
+            DrawButton(button);
+        } else {
+            DrawButton(button);
         }
-        return true;        
     }
+    // The skipped buttons still count in the content size, which sets the scroll bars.
+    ImGui::SetCursorPos(ImVec2(static_cast<float>(extent_x) + size.x, static_cast<float>(extent_y) + size.y));
+    ImGui::Dummy(ImVec2(0.0f, 0.0f));
+}
 
-    void Draw() const override {
-        ImGuiWindowFlags window_flags = 0;
-
-        /*window_flags |= ImGuiWindowFlags_NoTitleBar;
-        window_flags |= ImGuiWindowFlags_NoScrollbar;
-        window_flags |= ImGuiWindowFlags_MenuBar;
-        window_flags |= ImGuiWindowFlags_NoMove;
-        window_flags |= ImGuiWindowFlags_NoResize;
-        window_flags |= ImGuiWindowFlags_NoCollapse;
-        window_flags |= ImGuiWindowFlags_NoNav;
-        window_flags |= ImGuiWindowFlags_NoBackground;
-        window_flags |= ImGuiWindowFlags_NoBringToFrontOnFocus;
-        window_flags |= ImGuiWindowFlags_UnsavedDocument;
-        p_open = NULL; // Don't pass our bool* to Begin*/
+// Bitmaps whose image is not in the archives (or drawn without textures) show a placeholder of this size, the others
+// one of the image size until it is loaded.
+constexpr int32_t kPlaceholderSize = 32;
+constexpr ImU32 kPlaceholderFill = IM_COL32(128, 128, 128, 64);
+constexpr ImU32 kPlaceholderBorder = IM_COL32(128, 128, 128, 255);
 
+void DrawBitmap(ImDrawList* draw_list, const ImVec2& min, const ImVec2& max, const Texture* texture) {
+    if (texture != nullptr && texture->id != nullptr) {
+        draw_list->AddImage(texture->id, min, max, texture->uv0, texture->uv1);
+        return;
+    }
+    draw_list->AddRectFilled(min, max, kPlaceholderFill);
+    draw_list->AddRect(min, max, kPlaceholderBorder);
+}
 
-        // Main body of the Demo window starts here.
-        ImGui::SetNextWindowSize(ImVec2(width_, height_));
-        ImGui::Begin("WindowElement", nullptr, window_flags);
-        for (auto& child : children_) {
-            child->Draw();
+// The draw pass of the bitmaps, inside their window and before the other elements, which draw over them. Bitmaps take
+// no input, so they go straight to the draw list instead of being ImGui items. Every bitmap asks the cache for its
+// texture, so the images of the window load (and stay loaded) even when scrolled out of sight, only the visible ones
+// are drawn.
+void DrawBitmaps(std::span<const BitmapElement> bitmaps, std::string_view source, TextureCache* textures) {
+    if (bitmaps.empty()) return;
+    // The coordinates of SetCursorPos, on screen.
+    const ImVec2 origin(ImGui::GetWindowPos().x - ImGui::GetScrollX(), ImGui::GetWindowPos().y - ImGui::GetScrollY());
+    auto* draw_list = ImGui::GetWindowDrawList();
+    const ImVec2 clip_min = draw_list->GetClipRectMin();
+    const ImVec2 clip_max = draw_list->GetClipRectMax();
+    const bool profiled = FrameProfiler::Get().Enabled();
+    int32_t extent_x = 0, extent_y = 0;
+    for (const auto& bitmap : bitmaps) {
+        const auto* texture = textures != nullptr ? textures->Find(Resolve(source, bitmap.resource)) : nullptr;
+        const int32_t width = texture != nullptr ? texture->width : kPlaceholderSize;
+        const int32_t height = texture != nullptr ? texture->height : kPlaceholderSize;
+        extent_x = std::max(extent_x, bitmap.x + width);
+        extent_y = std::max(extent_y, bitmap.y + height);
+        const ImVec2 min(origin.x + bitmap.x, origin.y + bitmap.y);
+        const ImVec2 max(min.x + width, min.y + height);
+        if (max.x < clip_min.x || max.y < clip_min.y || min.x > clip_max.x || min.y > clip_max.y) continue;
+        if (profiled) {
+            ScopedFrameTimer timer(FramePhase::ELEMENT_DRAW, bitmap.index);
+            DrawBitmap(draw_list, min, max, texture);
+        } else {
+            DrawBitmap(draw_list, min, max, texture);
         }
-        ImGui::End();
     }
+    // They count in the content size, which sets the scroll bars.
+    ImGui::SetCursorPos(ImVec2(static_cast<float>(extent_x), static_cast<float>(extent_y)));
+    ImGui::Dummy(ImVec2(0.0f, 0.0f));
+}
+
+//-------------------------------------
+// Window (and its auxiliary functions).
+//-------------------------------------
 
-private:
-    int width_, height_;
+// Parse results before they are moved to the window arena. Reused by all windows parsed on the same thread, so once it
+// has grown parsing does not allocate.
+struct ParseScratch {
+    std::vector<ElementRecord> elements;
+    std::vector<AttributeRecord> attributes;
+    std::vector<TextSpan> comments;
+    std::vector<TextSpan> skipped;
 };
 
-class ButtonElement : public Element {
-public:
-    ElementType Type() const override { return ElementType::BUTTON; }
-
-    bool Setup() override {
-        if (attributes_.empty()) return false;
-        if (attributes_.at(0).find("[SETUP]") != 0) return false;
-        // Sample: [SETUP] IA_MAIN_CTRL C_TYPE_NORMAL 12 14
-        std::string main_type, label, window_ctype;
-        std::stringstream ss(attributes_.at(0));
-        ss >> main_type >> label >> window_ctype >> x_ >> y_;
-        if (x_ <= -kMaxX || y_ <= -kMaxY || x_ >= kMaxX || y_ >= kMaxY) return false;
-        return true;
-    }
+ParseScratch& ThreadParseScratch() {
+    thread_local ParseScratch scratch;
+    scratch.elements.clear();
+    scratch.attributes.clear();
+    scratch.comments.clear();
+    scratch.skipped.clear();
+    return scratch;
+}
+
+// Offset of the start of the line containing offset.
+size_t LineStart(std::string_view buffer, size_t offset) {
+    const auto newline = offset == 0 ? std::string_view::npos : buffer.rfind('\n', offset - 1);
+    return newline == std::string_view::npos ? 0 : newline + 1;
+}
 
-    void Draw() const override {
-        ImGui::SetCursorPos(ImVec2(x_, y_));
-        ImGui::Button("BUTTONTEXT");
+// Comments right before an element line are the element comments, the ones between attributes are not in the model
+// (they stay in the element source, and are lost if the element is edited).
+// Each element also gets its bytes of the buffer, from its first comment line to the next element, so every byte but
+// the blank lines before the first element belongs to one, and its subtree hash.
+// Attribute lines with a known tag which do not decode are skipped, the other bad lines fail the window. The attributes
+// get their line numbers, for the references and the diagnostics.
+// Returns false in case of error.
+bool ParseElements(std::string_view buffer, ParseScratch& scratch) {
+    Tokenizer tokenizer(buffer);
+    size_t pending_comments = 0;
+    // Lines end at '\n', one per NextLine.
+    uint32_t line_number = 0;
+    while (tokenizer.NextLine()) {
+        ++line_number;
+        const auto line = tokenizer.Line();
+        if (line.empty()) continue;
+        if (Tokenizer::IsComment(line)) {
+            scratch.comments.push_back(MakeSpan(buffer, line));
+            ++pending_comments;
+            continue;
+        }
+        if (IsElementStart(line)) {
+            const auto comment_count = static_cast<uint32_t>(pending_comments);
+            const auto first_comment = static_cast<uint32_t>(scratch.comments.size()) - comment_count;
+            const size_t start = LineStart(buffer, comment_count > 0 ? scratch.comments[first_comment].offset : tokenizer.LineOffset());
+            if (!scratch.elements.empty()) {
+                auto& previous = scratch.elements.back().source;
+                previous.length = static_cast<uint32_t>(start - previous.offset);
+            }
+            ElementRecord element{};
+            element.tag = FindTag(line)->tag;
+            element.first_attribute = static_cast<uint32_t>(scratch.attributes.size());
+            element.first_comment = first_comment;
+            element.comment_count = comment_count;
+            element.source.offset = static_cast<uint32_t>(start);
+            scratch.elements.push_back(element);
+            pending_comments = 0;
+            continue;
+        }
+        // Attributes before any element are an error.
+        if (scratch.elements.empty()) return false;
+        scratch.comments.resize(scratch.comments.size() - pending_comments);
+        pending_comments = 0;
+        auto record = DecodeAttribute(line, buffer);
+        if (!record.has_value()) {
+            const auto* spec = FindTag(Tokenizer::Tag(line));
+            if (spec == nullptr || !spec->is_attribute) return false;
+            scratch.skipped.push_back(MakeSpan(buffer, line));
+            continue;
+        }
+        record->line = line_number;
+        scratch.attributes.push_back(*record);
+        ++scratch.elements.back().attribute_count;
+    }
+    if (!scratch.elements.empty()) {
+        auto& last = scratch.elements.back().source;
+        last.length = static_cast<uint32_t>(buffer.size() - last.offset);
     }
+    HashElements(scratch.elements, scratch.attributes, buffer);
+    return true;
+}
 
-private:
-    int x_, y_;
-};
+// ReadWindowHeader reads this much, then twice as much until the header is complete or kMaxHeaderRead is reached.
+constexpr size_t kHeaderRead = 512;
+constexpr size_t kMaxHeaderRead = 64 * 1024;
 
-class PlaceholderElement : public Element {
-public:
-    bool Setup() override { return true; }
-    ElementType Type() const override { return ElementType::UNKNOWN; }
+enum class HeaderParse {
+    FOUND,
+    BAD,
+    // The source ends before the [SETUP] line is complete.
+    INCOMPLETE,
 };
 
-const std::unordered_map<std::string, Element::ElementType> kValidElementsMap = {
-     {"[WINDOW]", Element::ElementType::WINDOW}, {"[BITMAP]", Element::ElementType::BITMAP}, {"[TILE]", Element::ElementType::TILE}, {"[BUTTON]", Element::ElementType::BUTTON }
-};
+// Decodes the header from the first lines of source. Unless complete, source may end in the middle of a line, which is
+// then left for the next, longer, read.
+HeaderParse ParseHeader(std::string_view source, bool complete, WindowHeader& header) {
+    if (!complete) {
+        const auto end = source.rfind('\n');
+        source = end == std::string_view::npos ? std::string_view() : source.substr(0, end + 1);
+    }
+    Tokenizer tokenizer(source);
+    bool in_root = false;
+    while (tokenizer.NextLine()) {
+        const auto line = tokenizer.Line();
+        if (line.empty() || Tokenizer::IsComment(line)) continue;
+        const auto* spec = FindTag(line);
+        if (!in_root) {
+            if (spec == nullptr || spec->tag != Tag::WINDOW) return HeaderParse::BAD;
+            in_root = true;
+            continue;
+        }
+        // The first attribute of the root, which must be its [SETUP].
+        if (spec != nullptr && spec->starts_element) return HeaderParse::BAD;
+        const auto record = DecodeAttribute(line, source);
+        if (!record.has_value()) return HeaderParse::BAD;
+        const auto root_header = RootHeader({ &*record, 1 });
+        if (!root_header.has_value()) return HeaderParse::BAD;
+        header = *root_header;
+        return HeaderParse::FOUND;
+    }
+    return complete ? HeaderParse::BAD : HeaderParse::INCOMPLETE;
+}
 
 }  // namespace
 
-//--------
-// Element
-//--------
+std::optional<WindowHeader> ParseWindowHeader(std::string_view source) {
+    WindowHeader header;
+    if (ParseHeader(source, true, header) != HeaderParse::FOUND) return std::nullopt;
+    return header;
+}
 
-// Param line is updated with the last token read.
-// Returns true if successful.
-bool Element::Parse(std::string& line, std::istream& stream) {
-    while (std::getline(stream, line)) {
-        TrimLine(line);
-        if (line.empty()) continue;
-        if (IsComment(line)) continue;
-        if (kValidElementsMap.contains(line)) {
-            // A new element started. This is our end.
-            good_ = true;
-            return true;
-        }
-        if (!ParseSubElement(line)) {
-            // Error reading subelement.
-            return false;
-        }
+std::optional<WindowHeader> ReadWindowHeader(const std::string& filename) {
+    FALCON_UI_TRACE_SCOPE_DETAIL("ReadWindowHeader", filename);
+    std::ifstream file(filename, std::ios::binary);
+    if (!file) return std::nullopt;
+    std::string buffer;
+    for (size_t size = kHeaderRead; size <= kMaxHeaderRead; size *= 2) {
+        const size_t read = buffer.size();
+        buffer.resize(size);
+        file.read(buffer.data() + read, static_cast<std::streamsize>(size - read));
+        buffer.resize(read + static_cast<size_t>(file.gcount()));
+        // Only fails at the end of the file.
+        const bool complete = !file;
+        WindowHeader header;
+        const auto result = ParseHeader(buffer, complete, header);
+        if (result == HeaderParse::FOUND) return header;
+        if (result == HeaderParse::BAD) return std::nullopt;
     }
-    // File is over.
-    line.clear();
-    good_ = true;
-    return true;
+    return std::nullopt;
+}
+
+
+void Window::SetupFromFile(const std::string& filename) {
+    FALCON_UI_TRACE_SCOPE_DETAIL("Window::SetupFromFile", filename);
+    // Elements point inside the source, release them before it changes.
+    Reset();
+    if (!source_.Read(filename)) {
+        done_ = true;
+        return;
+    }
+    Setup();
+}
+
+void Window::SetupFromContents(std::string contents) {
+    Reset();
+    source_.Assign(std::move(contents));
+    Setup();
 }
 
-bool Element::ParseSubElement(const std::string& line) {
-    std::unordered_set<std::string> valid_subelements = { "[SETUP]", "[XY]", "[RANGES]", "[GROUP]", "[FLAGBITON]", "[DEPTH]", "[BITMAP]", "[TILE]", "[XYWH]", "[BUTTONIMAGE]", "[BUTTONTEXT]", "[SOUNDBITE]", "[CURSOR]" };
-    auto closing_bracket = line.find(']');
-    if (closing_bracket == std::string::npos || !valid_subelements.contains(line.substr(0, closing_bracket + 1))) {
-        return false;
+void Window::SetupHeaderFromFile(const std::string& filename) {
+    FALCON_UI_TRACE_SCOPE_DETAIL("Window::SetupHeaderFromFile", filename);
+    Reset();
+    if (!source_.Read(filename)) {
+        done_ = true;
+        return;
     }
-    attributes_.push_back(line);
-    return true;
+    SetupHeader();
 }
 
-//-------------------------------------
-// Window (and its auxiliary functions).
-//-------------------------------------
+void Window::SetupHeaderFromContents(std::string contents) {
+    Reset();
+    source_.Assign(std::move(contents));
+    SetupHeader();
+}
 
-namespace {
+void Window::SetupFromSource(SourceBuffer source) {
+    Reset();
+    source_ = std::move(source);
+    Setup();
+}
 
-// Returns nullptr in case of error. Updates line to be the same as the last line consumed.
-std::unique_ptr<Element> ParseElement(std::string& line, std::istream& stream) {
-    auto type_result = kValidElementsMap.find(line);
-    if (type_result == kValidElementsMap.end()) return {};
-    auto type = type_result->second;
-    std::unique_ptr<Element> element;
-    switch (type) {
-        case Element::ElementType::WINDOW: element = std::make_unique<WindowElement>(); break;
-        case Element::ElementType::BUTTON: element = std::make_unique<ButtonElement>(); break;
-        case Element::ElementType::UNKNOWN: break;
-        default: element = std::make_unique<PlaceholderElement>(); break;
-    }
-    if (element == nullptr) return nullptr;
-    if (!element->Parse(line, stream)) return nullptr;    
-    return std::move(element);
+void Window::SetupFromModel(SourceBuffer source, const WindowModel& model) {
+    Reset();
+    source_ = std::move(source);
+    header_ = ParseWindowHeader(source_.View());
+    done_ = true;
+    good_ = Build(model);
+    if (good_) SetupElements();
 }
 
-}  // namespace
+void Window::Reset() {
+    windows_ = {};
+    buttons_ = {};
+    bitmaps_ = {};
+    model_ = {};
+    arena_.Reset();
+    header_.reset();
+    lazy_.reset();
+    done_ = false;
+    good_ = false;
+}
 
+void Window::Setup() {
+    // Lazy windows have theirs already, which other threads may be reading.
+    if (lazy_ == nullptr) header_ = ParseWindowHeader(source_.View());
+    Parse(source_.View());
+    if (good_) SetupElements();
+}
 
-void Window::SetupFromFile(const std::string& filename) {
-    std::ifstream file(filename);
-    SetupFromContents(file);
-    file.close();
+void Window::SetupHeader() {
+    done_ = true;
+    header_ = ParseWindowHeader(source_.View());
+    lazy_ = std::make_unique<std::once_flag>();
 }
 
-void Window::SetupFromContents(std::istream& stream) {
-    Parse(stream);
+void Window::Materialize() const {
+    if (lazy_ == nullptr) return;
+    // Windows are never created const, only handed out as const once set up.
+    std::call_once(*lazy_, [this] {
+        FALCON_UI_TRACE_SCOPE("Window::Materialize");
+        const_cast<Window*>(this)->Setup();
+    });
+}
 
+void Window::SetupElements() {
+    FALCON_UI_TRACE_SCOPE("Element Setup");
+    const auto elements = model_.elements;
     // Sanity checks.
-    if (root_element_ == nullptr || root_element_->Type() != Element::ElementType::WINDOW) {
+    if (elements.empty() || elements.front().tag != Tag::WINDOW) {
         good_ = false;
         return;
     }
-    
-    if (!root_element_->Setup()) {
-        good_ = false; 
-        return;
-    }   
+
+    size_t window_count = 0, button_count = 0, bitmap_count = 0;
+    for (const auto& element : elements) {
+        window_count += element.tag == Tag::WINDOW;
+        button_count += element.tag == Tag::BUTTON;
+        bitmap_count += element.tag == Tag::BITMAP;
+    }
+    auto* windows = arena_.AllocateArray<WindowElement>(window_count);
+    auto* buttons = arena_.AllocateArray<ButtonElement>(button_count);
+    auto* bitmaps = arena_.AllocateArray<BitmapElement>(bitmap_count);
+    // One pass in file order, dispatching on the tag.
+    window_count = button_count = bitmap_count = 0;
+    for (size_t i = 0; i < elements.size(); ++i) {
+        const auto& element = elements[i];
+        const auto attributes = model_.attributes.subspan(element.first_attribute, element.attribute_count);
+        switch (element.tag) {
+            case Tag::WINDOW:
+                if (SetupWindowElement(attributes, windows[window_count])) {
+                    ++window_count;
+                } else if (i == 0) {
+                    good_ = false;
+                    return;
+                }
+                break;
+            case Tag::BUTTON:
+                button_count += SetupButtonElement(attributes, static_cast<uint32_t>(i), buttons[button_count]);
+                break;
+            case Tag::BITMAP:
+                bitmap_count += SetupBitmapElement(attributes, static_cast<uint32_t>(i), bitmaps[bitmap_count]);
+                break;
+            default:
+                break;
+        }
+    }
+    windows_ = { windows, window_count };
+    buttons_ = { buttons, button_count };
+    bitmaps_ = { bitmaps, bitmap_count };
 }
 
-void Window::Parse(std::istream& stream) {
+void Window::Parse(std::string_view buffer) {
+    FALCON_UI_TRACE_SCOPE("Window::Parse");
     done_ = true;
-    std::string line;
-    std::vector<std::string> comments;
-    if (!std::getline(stream, line)) return;
-
-    good_ = true;
-    while (true) {
-        TrimLine(line);
-        if (line.empty()) {
-            if (!std::getline(stream, line)) return;  // EOF.
-            continue;
-        }
-        if (IsComment(line)) {
-            comments.push_back(line);
-            if (!std::getline(stream, line)) return;  // EOF.
-            continue;
-        }
-        auto element = ParseElement(line, stream);
-        if (element == nullptr) {
-            // Some kind of error.
-            good_ = false;
-            return;
-        }
-        element->SetComments(comments);
-        comments.clear();
-        if (root_element_ == nullptr) {
-            root_element_ = std::move(element);
-        } else {
-            root_element_->AddChild(std::move(element));
-        }
-        if (line.empty()) return;  // An element only ends on a new element (not empty line) or EOF (empty line).
+    auto& scratch = ThreadParseScratch();
+    if (!ParseElements(buffer, scratch)) return;
+    good_ = Build({ scratch.elements, scratch.attributes, scratch.comments, scratch.skipped });
+}
+
+bool Window::Build(const WindowModel& model) {
+    FALCON_UI_TRACE_SCOPE("Window::Build");
+    const size_t element_count = model.elements.size();
+    if (element_count == 0) return false;
+    for (const auto& element : model.elements) {
+        if (!IsElementType(element.tag)) return false;
+        if (size_t{ element.first_attribute } + element.attribute_count > model.attributes.size()) return false;
+        if (size_t{ element.first_comment } + element.comment_count > model.comments.size()) return false;
+        if (size_t{ element.source.offset } + element.source.length > source_.View().size()) return false;
+    }
+    for (const auto& line : model.skipped) {
+        if (size_t{ line.offset } + line.length > source_.View().size()) return false;
     }
+
+    // Everything goes into a single arena block, with the element arrays of SetupElements (an element is in one at
+    // most).
+    arena_.Reserve(
+        element_count * (sizeof(ElementRecord) + std::max({ sizeof(WindowElement), sizeof(ButtonElement), sizeof(BitmapElement) })) +
+        model.attributes.size() * sizeof(AttributeRecord) + (model.comments.size() + model.skipped.size()) * sizeof(TextSpan) +
+        7 * alignof(std::max_align_t));
+    auto* element_records = arena_.AllocateArray<ElementRecord>(element_count);
+    std::copy(model.elements.begin(), model.elements.end(), element_records);
+    auto* attributes = arena_.AllocateArray<AttributeRecord>(model.attributes.size());
+    std::copy(model.attributes.begin(), model.attributes.end(), attributes);
+    auto* comments = arena_.AllocateArray<TextSpan>(model.comments.size());
+    std::copy(model.comments.begin(), model.comments.end(), comments);
+    auto* skipped = arena_.AllocateArray<TextSpan>(model.skipped.size());
+    std::copy(model.skipped.begin(), model.skipped.end(), skipped);
+    model_ = { { element_records, element_count }, { attributes, model.attributes.size() }, { comments, model.comments.size() }, { skipped, model.skipped.size() } };
+    return true;
 }
 
-void Window::Draw() const {
+void Window::Draw(TextureCache* textures) const {
+    Materialize();
     // We specify a default position/size in case there's no data in the .ini file.
     // We only do it to make the demo applications a little more welcoming, but typically this isn't required.
     const ImGuiViewport* main_viewport = ImGui::GetMainViewport();
     const int root_x = 200, root_y = 200;
     ImGui::SetNextWindowPos(ImVec2(main_viewport->WorkPos.x + root_x, main_viewport->WorkPos.y + root_y));
-    root_element_->Draw();
+    if (windows_.empty()) return;
+
+    ImGuiWindowFlags window_flags = 0;
+
+    /*window_flags |= ImGuiWindowFlags_NoTitleBar;
+    window_flags |= ImGuiWindowFlags_NoScrollbar;
+    window_flags |= ImGuiWindowFlags_MenuBar;
+    window_flags |= ImGuiWindowFlags_NoMove;
+    window_flags |= ImGuiWindowFlags_NoResize;
+    window_flags |= ImGuiWindowFlags_NoCollapse;
+    window_flags |= ImGuiWindowFlags_NoNav;
+    window_flags |= ImGuiWindowFlags_NoBackground;
+    window_flags |= ImGuiWindowFlags_NoBringToFrontOnFocus;
+    window_flags |= ImGuiWindowFlags_UnsavedDocument;
+    p_open = NULL; // Don't pass our bool* to Begin*/
+
+    // The draw pass, one type after the other. Each type draws with its own loop over its array, there is no per
+    // element dispatch.
+    const auto& root = windows_.front();
+    ImGui::SetNextWindowSize(ImVec2(static_cast<float>(root.width), static_cast<float>(root.height)));
+    ImGui::Begin("WindowElement", nullptr, window_flags);
+    DrawBitmaps(bitmaps_, source_.View(), textures);
+    DrawButtons(buttons_);
+    // Child windows are the same ImGui window, they only resize it.
+    for (const auto& window : windows_.subspan(1)) {
+        ImGui::SetNextWindowSize(ImVec2(static_cast<float>(window.width), static_cast<float>(window.height)));
+        ImGui::Begin("WindowElement", nullptr, window_flags);
+        ImGui::End();
+    }
+    ImGui::End();
+}
+
+bool Window::MoveElement(uint32_t element, int32_t x, int32_t y) {
+    Materialize();
+    if (!good_ || element == 0 || element >= model_.elements.size()) return false;
+    if (x <= -kMaxX || y <= -kMaxY || x >= kMaxX || y >= kMaxY) return false;
+    // The model arrays are in the window arena, only handed out as const.
+    auto* records = const_cast<ElementRecord*>(model_.elements.data());
+    auto* attributes = const_cast<AttributeRecord*>(model_.attributes.data());
+    auto& record = records[element];
+    if (record.attribute_count == 0) return false;
+    auto& setup = attributes[record.first_attribute];
+    if (setup.tag != Tag::SETUP || setup.setup.int_count < 2) return false;
+    setup.setup.ints[0] = x;
+    setup.setup.ints[1] = y;
+    record.edited = true;
+    HashElements({ records, model_.elements.size() }, model_.attributes, source_.View());
+
+    // The drawn element follows, elements are in their arrays in file order.
+    const auto move = [element, x, y](auto elements) {
+        const auto found = std::lower_bound(elements.begin(), elements.end(), element, [](const auto& drawn, uint32_t index) { return drawn.index < index; });
+        if (found == elements.end() || found->index != element) return;
+        auto& drawn = const_cast<std::remove_cvref_t<decltype(*found)>&>(*found);
+        drawn.x = x;
+        drawn.y = y;
+    };
+    move(buttons_);
+    move(bitmaps_);
+    return true;
+}
+
+bool Window::Edited() const {
+    const auto& elements = Model().elements;
+    return std::any_of(elements.begin(), elements.end(), [](const ElementRecord& element) { return element.edited; });
 }
 
 }  // namespace falcon_ui
\ No newline at end of file
@@ -1,65 +1,132 @@
 #pragma once
 
-#include <istream>
-#include <vector>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <string>
-#include <vector>
+#include <string_view>
 
+#include "Arena.h"
+#include "ScfRecords.h"
+#include "ScfTokenizer.h"
 
-namespace falcon_ui {
-
-class Element {
-public:
-    enum class ElementType {
-        UNKNOWN,
-        WINDOW,
-        BITMAP,
-        TILE,
-        BUTTON,
-    };
 
-    virtual ~Element() {}
-    // Parses the element, starting from line and then consuming stream. Assumes the first line (with type) has been consumed already.
-    // Param line is updated with the last line read from stream.
-    // Returns true if successful.
-    virtual bool Parse(std::string& line, std::istream& stream);
+namespace falcon_ui {
 
-    // Setup the element after it is parsed.
-    virtual bool Setup() = 0;
+class TextureCache;
 
-    // Set the high level comments for the element.
-    void SetComments(const std::vector<std::string>& comments) { comments_ = comments; }
+// Window sizes and element positions must be below these (in absolute value), or the element fails its setup.
+constexpr int kMaxX = 10000;
+constexpr int kMaxY = 10000;
 
-    virtual void Draw() const {}
+// Set up elements are plain records, in one array per type in the window arena: the setup pass fills them from the
+// model and the draw pass walks them in order, with no per element dispatch. [TILE] elements are not drawn yet, so they
+// have none.
 
-    // Returns the type of the element (WINDOW)
-    virtual ElementType Type() const = 0;
+// A [WINDOW] element, the root or a child window.
+struct WindowElement {
+    int32_t width;
+    int32_t height;
+};
 
-    void AddChild(std::unique_ptr<Element> element) { children_.push_back(std::move(element)); }
+struct ButtonElement {
+    int32_t x;
+    int32_t y;
+    // Index of the element in its window (the root is 0), for the frame timings.
+    uint32_t index;
+};
 
-protected:
-    std::vector<std::unique_ptr<Element>> children_; 
-    std::vector<std::string> attributes_;
-    bool good_ = false;
-    std::vector<std::string> comments_;
+struct BitmapElement {
+    int32_t x;
+    int32_t y;
+    // The image resource id, in the window source.
+    TextSpan resource;
+    uint32_t index;
+};
 
-private:
-    bool ParseSubElement(const std::string& line);
+// The [SETUP] line of the root [WINDOW] element, all the lists and previews show of a window.
+struct WindowHeader {
+    // Interned in SymbolTable::Global().
+    SymbolId label = kNoSymbol;
+    SymbolId ctype = kNoSymbol;
+    int32_t width = 0;
+    int32_t height = 0;
 };
 
+// Decodes the header at the start of a window source. Returns nullopt if the source does not start with a [WINDOW]
+// element whose first attribute is a [SETUP] passing the root window setup checks.
+std::optional<WindowHeader> ParseWindowHeader(std::string_view source);
+// Same from the file, reading only its first bytes (a few hundred usually, up to 64 KB of leading comments).
+std::optional<WindowHeader> ReadWindowHeader(const std::string& filename);
+
 class Window {
 public:
+    // Reads the file (see SourceBuffer::Read) and parses it in place.
     void SetupFromFile(const std::string& filename);
-    void SetupFromContents(std::istream& stream);
+    // Lazy versions of SetupFromFile and SetupFromContents: only parse the header, the children are parsed the first
+    // time they are needed, by Model(), Good() or Draw(). Listing windows does not pay for their children.
+    void SetupHeaderFromFile(const std::string& filename);
+    void SetupHeaderFromContents(std::string contents);
+    // Takes ownership of contents and parses it in place.
+    void SetupFromContents(std::string contents);
+    // Takes ownership of source and parses it in place.
+    void SetupFromSource(SourceBuffer source);
+    // Builds the window from a model taken from Model() of a window with the same source, skipping the parsing.
+    void SetupFromModel(SourceBuffer source, const WindowModel& model);
+
+    // The parsed model and the source its spans refer to. Empty if parsing failed.
+    const WindowModel& Model() const {
+        Materialize();
+        return model_;
+    }
+    std::string_view Source() const { return source_.View(); }
+    // Set once the header is parsed, even if the children fail to. Does not parse the children of lazy windows.
+    const std::optional<WindowHeader>& Header() const { return header_; }
 
     bool SetupDone() const { return done_; }
+    // True if the window parsed and set up without errors.
+    bool Good() const {
+        Materialize();
+        return good_;
+    }
     
-    void Draw() const;
+    // Draws the bitmaps with the textures of textures, or placeholders without it or until they are loaded.
+    void Draw(TextureCache* textures = nullptr) const;
 
-private:
-    void Parse(std::istream& stream);
+    // Edits change the model in place and mark the elements edited, for SaveWindow to write them from their records
+    // (see ScfWriter.h).
+    // Moves the child element to (x, y), the first two integers of its [SETUP]. Returns false if the element has no
+    // position or (x, y) is out of range.
+    bool MoveElement(uint32_t element, int32_t x, int32_t y);
+    // True if an element was edited since the window was set up.
+    bool Edited() const;
 
-    std::unique_ptr<Element> root_element_;
+private:
+    void Reset();
+    void Setup();
+    void SetupHeader();
+    // Parses the children of a lazy window, once. Safe to call from several threads.
+    void Materialize() const;
+    // The setup pass: fills the per type arrays from the model. Elements failing their setup are left out, the window
+    // is not good if the root does.
+    void SetupElements();
+    void Parse(std::string_view buffer);
+    // Copies model into the arena and creates the elements. Returns false if model is inconsistent.
+    bool Build(const WindowModel& model);
+
+    // Owns the bytes all elements point to.
+    SourceBuffer source_;
+    // Owns the model arrays and the element arrays.
+    Arena arena_;
+    WindowModel model_;
+    // The elements which draw, per type and in file order. The root window comes first.
+    std::span<const WindowElement> windows_;
+    std::span<const ButtonElement> buttons_;
+    std::span<const BitmapElement> bitmaps_;
+    std::optional<WindowHeader> header_;
+    // Set by SetupHeader, for Materialize. Behind a pointer to keep the window movable.
+    std::unique_ptr<std::once_flag> lazy_;
     bool done_ = false;
     bool good_ = false;
 };
@@ -0,0 +1,40 @@
+#include "FileUtil.h"
+
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+
+
+namespace falcon_ui {
+
+bool WriteFileAtomically(const std::filesystem::path& path, std::span<const char> bytes) {
+    std::error_code error;
+    auto temp_path = path;
+    temp_path += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.write(bytes.data(), static_cast<std::streamsize>(bytes.size())) || !file.flush()) {
+            file.close();
+            std::filesystem::remove(temp_path, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temp_path, path, error);
+    if (error) {
+        std::filesystem::remove(temp_path, error);
+        return false;
+    }
+    return true;
+}
+
+std::optional<FileKey> StatFile(const std::filesystem::path& path) {
+    std::error_code error;
+    const auto size = std::filesystem::file_size(path, error);
+    if (error) return std::nullopt;
+    const auto mtime = std::filesystem::last_write_time(path, error);
+    if (error) return std::nullopt;
+    return FileKey{ size, static_cast<int64_t>(mtime.time_since_epoch().count()) };
+}
+
+}  // namespace falcon_ui
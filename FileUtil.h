@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+
+
+namespace falcon_ui {
+
+// Writes bytes with one write to a temporary file next to path, which is then renamed over path, so readers (the game,
+// the file watcher, other instances loading a cache) never see a partial file. The temporary name is per thread, so
+// threads may save the same path concurrently, the last rename wins. Returns false on error, in which case path is
+// unchanged and the temporary file is removed.
+bool WriteFileAtomically(const std::filesystem::path& path, std::span<const char> bytes);
+
+// The size and modification time of a file. Caches and indexes store the key of their sources, and are used while it
+// is unchanged.
+struct FileKey {
+    uint64_t size;
+    int64_t mtime;
+
+    bool operator==(const FileKey&) const = default;
+};
+
+// Returns nullopt if path cannot be read.
+std::optional<FileKey> StatFile(const std::filesystem::path& path);
+
+// The binary files (ModelCache, TextSearchIndex) are a header and sections at aligned offsets, so the records are used
+// in place wherever the file is mapped.
+constexpr size_t kSectionAlignment = 8;
+
+constexpr size_t AlignSection(size_t offset) {
+    return (offset + kSectionAlignment - 1) & ~(kSectionAlignment - 1);
+}
+
+// True if the section of size bytes at offset is aligned and inside a file of file_size bytes.
+constexpr bool InBounds(uint64_t offset, uint64_t size, size_t file_size) {
+    return offset <= file_size && size <= file_size - offset && offset % kSectionAlignment == 0;
+}
+
+}  // namespace falcon_ui
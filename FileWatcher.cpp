@@ -0,0 +1,359 @@
+#include "FileWatcher.h"
+
+#include <algorithm>
+#include <cwctype>
+#include <thread>
+
+#ifdef _WIN32
+#define VC_EXTRALEAN
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#elif defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "Tracing.h"
+
+
+namespace falcon_ui {
+
+// Delivers the events of watched directories to the watcher. Directories are added once, however many of their files
+// are watched.
+class FileWatcher::Backend {
+public:
+    virtual ~Backend() = default;
+    virtual bool AddDirectory(const std::filesystem::path& directory) = 0;
+    virtual void RemoveDirectory(const std::filesystem::path& directory) = 0;
+};
+
+namespace {
+
+#ifdef _WIN32
+
+// One thread per directory, waiting on an overlapped ReadDirectoryChangesW or on the stop event.
+class Win32Backend final : public FileWatcher::Backend {
+public:
+    explicit Win32Backend(FileWatcher& watcher) : watcher_(watcher) {}
+
+    ~Win32Backend() override {
+        for (auto& [key, directory] : directories_) Stop(*directory);
+    }
+
+    bool AddDirectory(const std::filesystem::path& path) override {
+        auto directory = std::make_unique<Directory>();
+        directory->path = path;
+        directory->handle = CreateFileW(path.c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+        if (directory->handle == INVALID_HANDLE_VALUE) return false;
+        directory->stop = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        directory->read_done = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+        if (directory->stop == nullptr || directory->read_done == nullptr) {
+            Stop(*directory);
+            return false;
+        }
+        directory->thread = std::thread([this, directory = directory.get()] { Run(*directory); });
+        directories_[path.native()] = std::move(directory);
+        return true;
+    }
+
+    void RemoveDirectory(const std::filesystem::path& path) override {
+        const auto it = directories_.find(path.native());
+        if (it == directories_.end()) return;
+        Stop(*it->second);
+        directories_.erase(it);
+    }
+
+private:
+    struct Directory {
+        std::filesystem::path path;
+        HANDLE handle = INVALID_HANDLE_VALUE;
+        HANDLE stop = nullptr;
+        HANDLE read_done = nullptr;
+        std::thread thread;
+    };
+
+    static void Stop(Directory& directory) {
+        if (directory.stop != nullptr) SetEvent(directory.stop);
+        if (directory.thread.joinable()) directory.thread.join();
+        if (directory.read_done != nullptr) CloseHandle(directory.read_done);
+        if (directory.stop != nullptr) CloseHandle(directory.stop);
+        if (directory.handle != INVALID_HANDLE_VALUE) CloseHandle(directory.handle);
+    }
+
+    void Run(Directory& directory) {
+        FALCON_UI_TRACE_THREAD_NAME("FileWatcher");
+        constexpr DWORD kFilter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE;
+        alignas(DWORD) char buffer[32 * 1024];
+        OVERLAPPED overlapped{};
+        overlapped.hEvent = directory.read_done;
+        for (;;) {
+            ResetEvent(directory.read_done);
+            if (!ReadDirectoryChangesW(directory.handle, buffer, sizeof(buffer), FALSE, kFilter, nullptr, &overlapped, nullptr)) return;
+            const HANDLE handles[] = { directory.read_done, directory.stop };
+            DWORD bytes = 0;
+            if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0) {
+                CancelIoEx(directory.handle, &overlapped);
+                GetOverlappedResult(directory.handle, &overlapped, &bytes, TRUE);
+                return;
+            }
+            if (!GetOverlappedResult(directory.handle, &overlapped, &bytes, FALSE)) return;
+            if (bytes == 0) {
+                // The buffer overflowed, the events are lost.
+                watcher_.OnFileEvent(directory.path, {});
+                continue;
+            }
+            for (DWORD offset = 0;;) {
+                const auto* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer + offset);
+                watcher_.OnFileEvent(directory.path, std::wstring(info->FileName, info->FileNameLength / sizeof(wchar_t)));
+                if (info->NextEntryOffset == 0) break;
+                offset += info->NextEntryOffset;
+            }
+        }
+    }
+
+    FileWatcher& watcher_;
+    std::map<FileWatcher::PathKey, std::unique_ptr<Directory>> directories_;
+};
+
+#elif defined(__linux__)
+
+// One inotify instance for all directories, read by one thread which an eventfd wakes up to stop.
+class InotifyBackend final : public FileWatcher::Backend {
+public:
+    explicit InotifyBackend(FileWatcher& watcher) : watcher_(watcher) {
+        inotify_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        wake_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (inotify_ >= 0 && wake_ >= 0) thread_ = std::thread([this] { Run(); });
+    }
+
+    ~InotifyBackend() override {
+        if (thread_.joinable()) {
+            const uint64_t one = 1;
+            [[maybe_unused]] const auto written = write(wake_, &one, sizeof(one));
+            thread_.join();
+        }
+        if (wake_ >= 0) close(wake_);
+        if (inotify_ >= 0) close(inotify_);
+    }
+
+    bool AddDirectory(const std::filesystem::path& path) override {
+        if (!thread_.joinable()) return false;
+        // Editors either write the file in place or write a temporary file and rename it over the old one.
+        constexpr uint32_t kMask = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM;
+        const int descriptor = inotify_add_watch(inotify_, path.c_str(), kMask | IN_ONLYDIR);
+        if (descriptor < 0) return false;
+        std::lock_guard lock(mutex_);
+        directories_[descriptor] = path;
+        return true;
+    }
+
+    void RemoveDirectory(const std::filesystem::path& path) override {
+        std::lock_guard lock(mutex_);
+        const auto it = std::find_if(directories_.begin(), directories_.end(), [&path](const auto& entry) { return entry.second == path; });
+        if (it == directories_.end()) return;
+        inotify_rm_watch(inotify_, it->first);
+        directories_.erase(it);
+    }
+
+private:
+    void Run() {
+        FALCON_UI_TRACE_THREAD_NAME("FileWatcher");
+        alignas(inotify_event) char buffer[16 * 1024];
+        pollfd descriptors[] = { { inotify_, POLLIN, 0 }, { wake_, POLLIN, 0 } };
+        for (;;) {
+            if (poll(descriptors, 2, -1) < 0) continue;
+            if (descriptors[1].revents != 0) return;
+            const auto size = read(inotify_, buffer, sizeof(buffer));
+            if (size <= 0) continue;
+            for (ssize_t offset = 0; offset < size;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                offset += sizeof(inotify_event) + event->len;
+                if (event->mask & IN_Q_OVERFLOW) {
+                    for (const auto& directory : Directories()) watcher_.OnFileEvent(directory, {});
+                    continue;
+                }
+                if (event->len == 0) continue;
+                std::filesystem::path directory;
+                {
+                    std::lock_guard lock(mutex_);
+                    const auto it = directories_.find(event->wd);
+                    if (it == directories_.end()) continue;
+                    directory = it->second;
+                }
+                // Called without holding mutex_, the watcher holds its own lock while adding directories.
+                watcher_.OnFileEvent(directory, event->name);
+            }
+        }
+    }
+
+    std::vector<std::filesystem::path> Directories() {
+        std::lock_guard lock(mutex_);
+        std::vector<std::filesystem::path> directories;
+        for (const auto& [descriptor, path] : directories_) directories.push_back(path);
+        return directories;
+    }
+
+    FileWatcher& watcher_;
+    int inotify_ = -1;
+    int wake_ = -1;
+    std::mutex mutex_;
+    std::map<int, std::filesystem::path> directories_;
+    std::thread thread_;
+};
+
+#endif
+
+std::unique_ptr<FileWatcher::Backend> CreateBackend(FileWatcher& watcher) {
+#ifdef _WIN32
+    return std::make_unique<Win32Backend>(watcher);
+#elif defined(__linux__)
+    return std::make_unique<InotifyBackend>(watcher);
+#else
+    return nullptr;
+#endif
+}
+
+}  // namespace
+
+FileWatcher::FileWatcher() : backend_(CreateBackend(*this)) {}
+
+// The backend is stopped first, its thread calls OnFileEvent.
+FileWatcher::~FileWatcher() {
+    backend_.reset();
+}
+
+FileWatcher::PathKey FileWatcher::Normalize(const std::filesystem::path& path) {
+#ifdef _WIN32
+    auto key = path.lexically_normal().make_preferred().native();
+    std::transform(key.begin(), key.end(), key.begin(), [](wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+    return key;
+#else
+    return path.lexically_normal().native();
+#endif
+}
+
+std::filesystem::path FileWatcher::ParentDirectory(const std::string& path) {
+    const auto directory = std::filesystem::path(path).parent_path();
+    return directory.empty() ? std::filesystem::path(".") : directory;
+}
+
+std::filesystem::path FileWatcher::DirectoryOf(const std::string& directory_path) {
+    // Without the trailing separator, so it is the same key as the parent of its files.
+    auto directory = std::filesystem::path(directory_path).lexically_normal();
+    if (!directory.has_filename()) directory = directory.parent_path();
+    return directory.empty() ? std::filesystem::path(".") : directory;
+}
+
+bool FileWatcher::Watch(const std::string& path) {
+    return Add(ParentDirectory(path), Normalize(std::filesystem::path(path).filename()), path);
+}
+
+bool FileWatcher::WatchDirectory(const std::string& path) {
+    return Add(DirectoryOf(path), {}, path);
+}
+
+void FileWatcher::Unwatch(const std::string& path) {
+    Remove(ParentDirectory(path), Normalize(std::filesystem::path(path).filename()), path);
+}
+
+void FileWatcher::UnwatchDirectory(const std::string& path) {
+    Remove(DirectoryOf(path), {}, path);
+}
+
+bool FileWatcher::Add(const std::filesystem::path& directory, const PathKey& name, const std::string& path) {
+    if (backend_ == nullptr) return false;
+    std::lock_guard lock(mutex_);
+    const auto directory_key = Normalize(directory);
+    auto it = watched_.find(directory_key);
+    if (it == watched_.end()) {
+        if (!backend_->AddDirectory(directory)) return false;
+        it = watched_.emplace(directory_key, std::map<PathKey, std::string>{}).first;
+    }
+    it->second[name] = path;
+    return true;
+}
+
+void FileWatcher::Remove(const std::filesystem::path& directory, const PathKey& name, const std::string& path) {
+    if (backend_ == nullptr) return;
+    {
+        std::lock_guard lock(mutex_);
+        pending_.erase(path);
+        const auto it = watched_.find(Normalize(directory));
+        if (it == watched_.end()) return;
+        it->second.erase(name);
+        if (!it->second.empty()) return;
+        watched_.erase(it);
+    }
+    // Without the lock, the backend may wait for its thread which may be waiting for the lock in OnFileEvent.
+    backend_->RemoveDirectory(directory);
+}
+
+void FileWatcher::SetDebounce(Clock::duration debounce) {
+    std::lock_guard lock(mutex_);
+    debounce_ = debounce;
+}
+
+void FileWatcher::OnFileEvent(const std::filesystem::path& directory, const std::filesystem::path& filename) {
+    const auto now = Clock::now();
+    std::lock_guard lock(mutex_);
+    const auto it = watched_.find(Normalize(directory));
+    if (it == watched_.end()) return;
+    const auto key = filename.empty() ? PathKey{} : Normalize(filename);
+    bool any = false;
+    for (const auto& [name, path] : it->second) {
+        // The empty name is the directory itself, any file changes it.
+        if (filename.empty() || name.empty() || name == key) {
+            pending_[path] = now;
+            any = true;
+        }
+    }
+    if (!any) return;
+    changed_.notify_all();
+    if (on_change_) on_change_();
+}
+
+std::vector<std::string> FileWatcher::PollChanges() {
+    std::vector<std::string> changes;
+    const auto now = Clock::now();
+    std::lock_guard lock(mutex_);
+    for (auto it = pending_.begin(); it != pending_.end();) {
+        if (it->second + debounce_ <= now) {
+            changes.push_back(it->first);
+            it = pending_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return changes;
+}
+
+FileWatcher::Clock::time_point FileWatcher::NextReadyTime() {
+    std::lock_guard lock(mutex_);
+    auto ready = Clock::time_point::max();
+    for (const auto& [path, time] : pending_) ready = std::min(ready, time + debounce_);
+    return ready;
+}
+
+void FileWatcher::SetOnChange(std::function<void()> on_change) {
+    std::lock_guard lock(mutex_);
+    on_change_ = std::move(on_change);
+}
+
+bool FileWatcher::WaitForChanges(Clock::duration timeout) {
+    const auto deadline = Clock::now() + timeout;
+    std::unique_lock lock(mutex_);
+    for (;;) {
+        const auto now = Clock::now();
+        auto ready = Clock::time_point::max();
+        for (const auto& [path, time] : pending_) ready = std::min(ready, time + debounce_);
+        if (ready <= now) return true;
+        if (now >= deadline) return false;
+        changed_.wait_until(lock, std::min(ready, deadline));
+    }
+}
+
+}  // namespace falcon_ui
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace falcon_ui {
+
+// Watches files for changes made by other programs (for example a text editor saving an .scf or a .lst).
+// Events are collected by a background thread (ReadDirectoryChangesW on Windows, inotify on Linux) watching the
+// directories of the files. Bursts of events for one file (truncate, writes, rename over...) are coalesced and only
+// reported once the file has been quiet for the debounce delay.
+// The UI polls the changes at the start of a frame, so a new model is only swapped in at frame boundaries.
+class FileWatcher {
+public:
+    using Clock = std::chrono::steady_clock;
+    using PathKey = std::filesystem::path::string_type;
+
+    FileWatcher();
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Starts watching path. Returns false if its directory cannot be watched.
+    // Watch and Unwatch are called from one thread (the UI one).
+    bool Watch(const std::string& path);
+    void Unwatch(const std::string& path);
+    // Watches the files of a directory, a change to any of them is reported as a change of path.
+    bool WatchDirectory(const std::string& path);
+    void UnwatchDirectory(const std::string& path);
+
+    // Watched files (as given to Watch) which changed and have been quiet for the debounce delay. Never blocks.
+    std::vector<std::string> PollChanges();
+    // Blocks until PollChanges has something to return or timeout passes. Returns true in the first case.
+    bool WaitForChanges(Clock::duration timeout);
+    // When PollChanges will have something to return, Clock::time_point::max() if there are no pending changes.
+    Clock::time_point NextReadyTime();
+    // Called from the backend thread, with the watcher locked, when a watched file changes. For example to wake up a
+    // thread blocked on something else than WaitForChanges.
+    void SetOnChange(std::function<void()> on_change);
+
+    void SetDebounce(Clock::duration debounce);
+
+    // Called from the backend thread. An empty filename means any file of directory may have changed (the backend
+    // lost events).
+    void OnFileEvent(const std::filesystem::path& directory, const std::filesystem::path& filename);
+
+    class Backend;
+
+private:
+    // Case insensitive and with native separators on Windows.
+    static PathKey Normalize(const std::filesystem::path& path);
+    static std::filesystem::path ParentDirectory(const std::string& path);
+    static std::filesystem::path DirectoryOf(const std::string& directory_path);
+
+    // name is the normalized filename in directory, empty for the directory itself.
+    bool Add(const std::filesystem::path& directory, const PathKey& name, const std::string& path);
+    void Remove(const std::filesystem::path& directory, const PathKey& name, const std::string& path);
+
+    std::unique_ptr<Backend> backend_;
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    Clock::duration debounce_ = std::chrono::milliseconds(5);
+    std::function<void()> on_change_;
+    // Directory -> filename (empty for the directory) -> path given to Watch.
+    std::map<PathKey, std::map<PathKey, std::string>> watched_;
+    // Path given to Watch -> time of its last event.
+    std::map<std::string, Clock::time_point> pending_;
+};
+
+}  // namespace falcon_ui
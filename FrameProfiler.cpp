@@ -0,0 +1,99 @@
+#include "FrameProfiler.h"
+
+#include <algorithm>
+#include <ostream>
+
+
+namespace falcon_ui {
+
+namespace {
+
+static_assert((FrameProfiler::kCapacity & (FrameProfiler::kCapacity - 1)) == 0, "The capacity must be a power of 2");
+
+constexpr const char* kPhaseNames[] = {
+    "Frame", "NewFrame", "PickFlow", "WindowDraw", "ElementDraw", "Render", "RenderDrawData", "Present", "TextureUpload",
+};
+static_assert(std::size(kPhaseNames) == static_cast<size_t>(FramePhase::COUNT));
+
+// Duration, phase and detail share the third word.
+uint64_t PackWord(uint32_t duration_ns, FramePhase phase, uint32_t detail) {
+    return uint64_t{ duration_ns } | (uint64_t{ static_cast<uint8_t>(phase) } << 32) | (uint64_t{ detail & 0xFFFFFF } << 40);
+}
+
+}  // namespace
+
+const char* FramePhaseName(FramePhase phase) {
+    const auto index = static_cast<size_t>(phase);
+    return index < std::size(kPhaseNames) ? kPhaseNames[index] : "?";
+}
+
+FrameProfiler::FrameProfiler() : slots_(new Slot[kCapacity]), epoch_(Clock::now()) {}
+
+FrameProfiler& FrameProfiler::Get() {
+    static FrameProfiler profiler;
+    return profiler;
+}
+
+void FrameProfiler::Record(FramePhase phase, Clock::time_point start, Clock::time_point end, uint32_t detail) {
+    const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    const auto start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch_).count();
+    const auto duration_ns = static_cast<uint32_t>(std::clamp<int64_t>(duration, 0, UINT32_MAX));
+
+    const uint64_t index = head_.fetch_add(1, std::memory_order_relaxed);
+    auto& slot = slots_[index & (kCapacity - 1)];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.words[0].store(Frame(), std::memory_order_relaxed);
+    slot.words[1].store(static_cast<uint64_t>(std::max<int64_t>(start_ns, 0)), std::memory_order_relaxed);
+    slot.words[2].store(PackWord(duration_ns, phase, detail), std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+std::vector<FrameSample> FrameProfiler::Snapshot() const {
+    const uint64_t head = head_.load(std::memory_order_acquire);
+    const uint64_t first = head > kCapacity ? head - kCapacity : 0;
+    std::vector<FrameSample> samples;
+    samples.reserve(static_cast<size_t>(head - first));
+    for (uint64_t index = first; index < head; ++index) {
+        const auto& slot = slots_[index & (kCapacity - 1)];
+        const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        // Not written yet, being written, or already overwritten by a newer sample.
+        if (sequence != 2 * index + 2) continue;
+        const uint64_t frame = slot.words[0].load(std::memory_order_relaxed);
+        const uint64_t start_ns = slot.words[1].load(std::memory_order_relaxed);
+        const uint64_t word = slot.words[2].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) continue;
+        samples.push_back({ frame, start_ns, static_cast<uint32_t>(word), static_cast<FramePhase>((word >> 32) & 0xFF), static_cast<uint32_t>(word >> 40) });
+    }
+    return samples;
+}
+
+uint32_t FrameProfiler::Label(std::string_view name) {
+    std::lock_guard lock(labels_mutex_);
+    const auto it = std::find(labels_.begin(), labels_.end(), name);
+    if (it != labels_.end()) return static_cast<uint32_t>(it - labels_.begin());
+    labels_.emplace_back(name);
+    return static_cast<uint32_t>(labels_.size() - 1);
+}
+
+std::string FrameProfiler::LabelName(uint32_t label) const {
+    std::lock_guard lock(labels_mutex_);
+    return label < labels_.size() ? labels_[label] : std::string{};
+}
+
+void FrameProfiler::WriteCsv(std::ostream& out) const {
+    out << "frame,phase,detail,start_us,duration_us\n";
+    for (const auto& sample : Snapshot()) {
+        out << sample.frame << ',' << FramePhaseName(sample.phase) << ',';
+        if (sample.phase == FramePhase::WINDOW_DRAW) {
+            // Quoted, window names are paths.
+            out << '"' << LabelName(sample.detail) << '"';
+        } else {
+            out << sample.detail;
+        }
+        out << ',' << sample.start_ns / 1000.0 << ',' << sample.duration_ns / 1000.0 << '\n';
+    }
+}
+
+}  // namespace falcon_ui
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+namespace falcon_ui {
+
+// Parts of a UI frame which are timed. Phases nest: FRAME covers all the others, PICK_FLOW (the editor window) covers
+// WINDOW_DRAW which covers ELEMENT_DRAW.
+enum class FramePhase : uint8_t {
+    FRAME,
+    NEW_FRAME,
+    PICK_FLOW,
+    WINDOW_DRAW,
+    ELEMENT_DRAW,
+    RENDER,
+    RENDER_DRAW_DATA,
+    PRESENT,
+    // Creating the textures decoded since the last frame (see TextureCache::Update).
+    TEXTURE_UPLOAD,
+    COUNT
+};
+
+const char* FramePhaseName(FramePhase phase);
+
+struct FrameSample {
+    uint64_t frame;
+    // Since the profiler was created.
+    uint64_t start_ns;
+    uint32_t duration_ns;
+    FramePhase phase;
+    // WINDOW_DRAW: label of the window (see FrameProfiler::Label). ELEMENT_DRAW: index of the element in its window.
+    uint32_t detail;
+};
+
+// Collects timed samples of the UI frames in a fixed size ring buffer, the oldest samples are overwritten.
+// Recording is lock free and can be done from any thread. Readers copy the samples without stopping the writers, a
+// sample being overwritten while it is read is skipped.
+class FrameProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t kCapacity = size_t{ 1 } << 16;
+
+    FrameProfiler();
+
+    // The profiler of the UI.
+    static FrameProfiler& Get();
+
+    bool Enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    void SetEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    // Starts a new frame, the following samples belong to it.
+    void BeginFrame() { frame_.fetch_add(1, std::memory_order_relaxed); }
+    uint64_t Frame() const { return frame_.load(std::memory_order_relaxed); }
+
+    void Record(FramePhase phase, Clock::time_point start, Clock::time_point end, uint32_t detail = 0);
+
+    // The samples in the buffer, oldest first.
+    std::vector<FrameSample> Snapshot() const;
+
+    // Id of name for FrameSample::detail, the same name always gets the same id.
+    uint32_t Label(std::string_view name);
+    std::string LabelName(uint32_t label) const;
+
+    // One line per sample: frame, phase, detail (the window name for WINDOW_DRAW), start and duration in microseconds.
+    void WriteCsv(std::ostream& out) const;
+
+private:
+    // A sample is written between two updates of sequence: odd while it is written, then 2 * (index + 1).
+    struct Slot {
+        std::atomic<uint64_t> sequence{ 0 };
+        std::atomic<uint64_t> words[3];
+    };
+
+    std::atomic<bool> enabled_{ false };
+    std::atomic<uint64_t> frame_{ 0 };
+    std::atomic<uint64_t> head_{ 0 };
+    std::unique_ptr<Slot[]> slots_;
+    Clock::time_point epoch_;
+
+    mutable std::mutex labels_mutex_;
+    std::vector<std::string> labels_;
+};
+
+// Times its scope and records it, if the profiler is enabled when the scope starts. Disabled, it costs one relaxed load.
+class ScopedFrameTimer {
+public:
+    explicit ScopedFrameTimer(FramePhase phase, uint32_t detail = 0, FrameProfiler& profiler = FrameProfiler::Get())
+        : profiler_(profiler.Enabled() ? &profiler : nullptr), phase_(phase), detail_(detail) {
+        if (profiler_ != nullptr) start_ = FrameProfiler::Clock::now();
+    }
+    ~ScopedFrameTimer() {
+        if (profiler_ != nullptr) profiler_->Record(phase_, start_, FrameProfiler::Clock::now(), detail_);
+    }
+    ScopedFrameTimer(const ScopedFrameTimer&) = delete;
+    ScopedFrameTimer& operator=(const ScopedFrameTimer&) = delete;
+
+private:
+    FrameProfiler* profiler_;
+    FramePhase phase_;
+    uint32_t detail_;
+    FrameProfiler::Clock::time_point start_;
+};
+
+}  // namespace falcon_ui
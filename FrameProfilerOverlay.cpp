@@ -0,0 +1,175 @@
+#include "FrameProfilerOverlay.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+#include "imgui.h"
+#include "JobSystem.h"
+
+
+namespace falcon_ui {
+
+namespace {
+
+constexpr size_t kSlowestCount = 10;
+const char kCsvFilename[] = "frame_timing.csv";
+
+float ToMilliseconds(uint32_t duration_ns) {
+    return duration_ns / 1e6f;
+}
+
+// durations must be sorted.
+float Percentile(const std::vector<float>& durations, double percentile) {
+    if (durations.empty()) return 0.0f;
+    const auto index = static_cast<size_t>(percentile * (durations.size() - 1) + 0.5);
+    return durations[std::min(index, durations.size() - 1)];
+}
+
+// The kSlowestCount groups with the highest p95.
+template <typename Name>
+std::vector<std::pair<std::string, float>> SlowestGroups(std::map<uint32_t, std::vector<float>>& groups, const Name& name) {
+    std::vector<std::pair<std::string, float>> slowest;
+    for (auto& [id, durations] : groups) {
+        std::sort(durations.begin(), durations.end());
+        slowest.emplace_back(name(id), Percentile(durations, 0.95));
+    }
+    std::sort(slowest.begin(), slowest.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    if (slowest.size() > kSlowestCount) slowest.resize(kSlowestCount);
+    return slowest;
+}
+
+void DrawSlowest(const char* id, const char* title, const std::vector<std::pair<std::string, float>>& slowest) {
+    if (slowest.empty() || !ImGui::BeginTable(id, 2, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) return;
+    ImGui::TableSetupColumn(title);
+    ImGui::TableSetupColumn("p95 (ms)", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableHeadersRow();
+    for (const auto& [name, p95] : slowest) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextUnformatted(name.c_str());
+        ImGui::TableNextColumn();
+        ImGui::Text("%.3f", p95);
+    }
+    ImGui::EndTable();
+}
+
+}  // namespace
+
+void FrameProfilerOverlay::Refresh() {
+    last_refresh_ = FrameProfiler::Clock::now();
+    const auto samples = profiler_.Snapshot();
+
+    std::array<std::vector<float>, static_cast<size_t>(FramePhase::COUNT)> durations;
+    std::map<uint32_t, std::vector<float>> windows;
+    std::map<uint32_t, std::vector<float>> elements;
+    for (const auto& sample : samples) {
+        const auto phase = static_cast<size_t>(sample.phase);
+        if (phase >= durations.size()) continue;
+        const float ms = ToMilliseconds(sample.duration_ns);
+        durations[phase].push_back(ms);
+        if (sample.phase == FramePhase::WINDOW_DRAW) windows[sample.detail].push_back(ms);
+        if (sample.phase == FramePhase::ELEMENT_DRAW) elements[sample.detail].push_back(ms);
+    }
+
+    for (size_t phase = 0; phase < durations.size(); ++phase) {
+        auto& values = durations[phase];
+        auto& stats = phases_[phase];
+        std::sort(values.begin(), values.end());
+        stats.count = values.size();
+        stats.p50 = Percentile(values, 0.50);
+        stats.p90 = Percentile(values, 0.90);
+        stats.p99 = Percentile(values, 0.99);
+        stats.max = values.empty() ? 0.0f : values.back();
+        // Up to the p99 (and a bit more), the outliers all go to the last bucket.
+        stats.histogram_range = std::max(stats.p99 * 1.25f, 0.001f);
+        stats.histogram.fill(0.0f);
+        for (const float value : values) {
+            const auto bucket = std::min(static_cast<int>(value / stats.histogram_range * kHistogramBuckets), kHistogramBuckets - 1);
+            stats.histogram[bucket] += 1.0f;
+        }
+    }
+
+    const auto& frames = durations[static_cast<size_t>(FramePhase::FRAME)];
+    frames_ = frames.size();
+    frames_over_budget_ = static_cast<size_t>(frames.end() - std::upper_bound(frames.begin(), frames.end(), budget_ms_));
+
+    slowest_windows_ = SlowestGroups(windows, [this](uint32_t label) { return profiler_.LabelName(label); });
+    slowest_elements_ = SlowestGroups(elements, [](uint32_t index) { return "Element " + std::to_string(index); });
+}
+
+void FrameProfilerOverlay::Export() {
+    std::ofstream file(kCsvFilename, std::ios::trunc);
+    if (file) profiler_.WriteCsv(file);
+    std::error_code error;
+    const auto path = std::filesystem::absolute(kCsvFilename, error).string();
+    export_status_ = file ? "Exported to " + path : "Could not write " + path;
+}
+
+void FrameProfilerOverlay::Draw(bool* open) {
+    if (!ImGui::Begin("Frame Timing", open)) {
+        ImGui::End();
+        return;
+    }
+
+    bool enabled = profiler_.Enabled();
+    if (ImGui::Checkbox("Record", &enabled)) profiler_.SetEnabled(enabled);
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(ImGui::GetFontSize() * 5.0f);
+    ImGui::InputFloat("Budget (ms)", &budget_ms_, 0.0f, 0.0f, "%.1f");
+    ImGui::SameLine();
+    if (ImGui::Button("Export CSV")) Export();
+    if (!export_status_.empty()) ImGui::TextUnformatted(export_status_.c_str());
+
+    if (FrameProfiler::Clock::now() - last_refresh_ > std::chrono::milliseconds(500)) Refresh();
+    ImGui::Text("%zu of the last %zu frames over budget", frames_over_budget_, frames_);
+    const auto jobs = JobSystem::Get().GetStats();
+    ImGui::Text("Jobs queued: %zu interactive, %zu preview, %zu background. %llu run, %llu stolen, %u workers", jobs.queued[0], jobs.queued[1],
+        jobs.queued[2], static_cast<unsigned long long>(jobs.executed), static_cast<unsigned long long>(jobs.steals), jobs.worker_count);
+
+    if (ImGui::BeginTable("Phases", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Phase");
+        ImGui::TableSetupColumn("Samples");
+        ImGui::TableSetupColumn("p50 (ms)");
+        ImGui::TableSetupColumn("p90 (ms)");
+        ImGui::TableSetupColumn("p99 (ms)");
+        ImGui::TableSetupColumn("Max (ms)");
+        ImGui::TableHeadersRow();
+        for (size_t phase = 0; phase < phases_.size(); ++phase) {
+            const auto& stats = phases_[phase];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(FramePhaseName(static_cast<FramePhase>(phase)));
+            ImGui::TableNextColumn();
+            ImGui::Text("%zu", stats.count);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.p50);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.p90);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.p99);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", stats.max);
+        }
+        ImGui::EndTable();
+    }
+
+    if (ImGui::CollapsingHeader("Histograms")) {
+        for (size_t phase = 0; phase < phases_.size(); ++phase) {
+            const auto& stats = phases_[phase];
+            if (stats.count == 0) continue;
+            char overlay[64];
+            snprintf(overlay, sizeof(overlay), "0 - %.3f ms", stats.histogram_range);
+            ImGui::PlotHistogram(FramePhaseName(static_cast<FramePhase>(phase)), stats.histogram.data(), kHistogramBuckets, 0, overlay, 0.0f, FLT_MAX, ImVec2(0.0f, ImGui::GetFontSize() * 3.0f));
+        }
+    }
+
+    DrawSlowest("Windows", "Slowest windows", slowest_windows_);
+    DrawSlowest("Elements", "Slowest elements", slowest_elements_);
+    ImGui::End();
+}
+
+}  // namespace falcon_ui
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "FrameProfiler.h"
+
+
+namespace falcon_ui {
+
+// ImGui window showing the samples of a FrameProfiler: percentiles and a histogram per phase, the windows and
+// elements which take the longest to draw, and a CSV export.
+class FrameProfilerOverlay {
+public:
+    static constexpr int kHistogramBuckets = 32;
+
+    explicit FrameProfilerOverlay(FrameProfiler& profiler = FrameProfiler::Get()) : profiler_(profiler) {}
+
+    void Draw(bool* open);
+
+private:
+    struct PhaseStats {
+        size_t count = 0;
+        // Milliseconds.
+        float p50 = 0.0f;
+        float p90 = 0.0f;
+        float p99 = 0.0f;
+        float max = 0.0f;
+        float histogram_range = 0.0f;
+        std::array<float, kHistogramBuckets> histogram{};
+    };
+    // Name (window path or element index) and p95 in milliseconds.
+    using Slowest = std::vector<std::pair<std::string, float>>;
+
+    // Statistics are recomputed twice a second, not every frame.
+    void Refresh();
+    void Export();
+
+    FrameProfiler& profiler_;
+    std::array<PhaseStats, static_cast<size_t>(FramePhase::COUNT)> phases_;
+    Slowest slowest_windows_;
+    Slowest slowest_elements_;
+    size_t frames_ = 0;
+    size_t frames_over_budget_ = 0;
+    float budget_ms_ = 1000.0f / 60.0f;
+    FrameProfiler::Clock::time_point last_refresh_;
+    std::string export_status_;
+};
+
+}  // namespace falcon_ui
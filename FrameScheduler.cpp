@@ -0,0 +1,147 @@
+#include "FrameScheduler.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#define VC_EXTRALEAN
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <time.h>
+#endif
+
+
+namespace falcon_ui {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// CPU time (user and kernel) of all the threads of the process.
+Clock::duration ProcessCpuTime() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return {};
+    const auto ticks = [](const FILETIME& time) { return (uint64_t{ time.dwHighDateTime } << 32) | time.dwLowDateTime; };
+    // FILETIME ticks are 100 ns.
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds((ticks(kernel) + ticks(user)) * 100));
+#else
+    timespec time;
+    if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0) return {};
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec));
+#endif
+}
+
+}  // namespace
+
+#ifdef _WIN32
+
+Win32FrameBackend::Win32FrameBackend() : wake_event_(CreateEventW(nullptr, FALSE, FALSE, nullptr)) {}
+
+Win32FrameBackend::~Win32FrameBackend() {
+    if (wake_event_ != nullptr) CloseHandle(wake_event_);
+}
+
+bool Win32FrameBackend::Wait(Clock::time_point deadline) {
+    DWORD timeout = INFINITE;
+    if (deadline != Clock::time_point::max()) {
+        const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        timeout = static_cast<DWORD>(std::clamp<long long>(remaining, 0, INFINITE - 1));
+    }
+    const HANDLE handles[] = { wake_event_ };
+    const DWORD count = wake_event_ != nullptr ? 1 : 0;
+    // MWMO_INPUTAVAILABLE also returns for messages already in the queue but seen by an earlier PeekMessage.
+    const DWORD result = MsgWaitForMultipleObjectsEx(count, handles, timeout, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+    return result == WAIT_OBJECT_0 + count;
+}
+
+void Win32FrameBackend::Wake() {
+    if (wake_event_ != nullptr) SetEvent(wake_event_);
+}
+
+#endif
+
+bool HeadlessFrameBackend::Wait(Clock::time_point deadline) {
+    std::unique_lock lock(mutex_);
+    const auto ready = [this] { return input_ || woken_; };
+    if (deadline == Clock::time_point::max()) {
+        wake_.wait(lock, ready);
+    } else {
+        wake_.wait_until(lock, deadline, ready);
+    }
+    const bool input = input_;
+    input_ = false;
+    woken_ = false;
+    return input;
+}
+
+void HeadlessFrameBackend::Wake() {
+    std::lock_guard lock(mutex_);
+    woken_ = true;
+    wake_.notify_all();
+}
+
+void HeadlessFrameBackend::PostInput() {
+    std::lock_guard lock(mutex_);
+    input_ = true;
+    wake_.notify_all();
+}
+
+FrameScheduler::FrameScheduler(FrameBackend& backend, FileWatcher* watcher)
+    : backend_(backend), watcher_(watcher), stats_start_(Clock::now()), stats_cpu_start_(ProcessCpuTime()) {
+    if (watcher_ != nullptr) watcher_->SetOnChange([this] { backend_.Wake(); });
+}
+
+FrameScheduler::~FrameScheduler() {
+    if (watcher_ != nullptr) watcher_->SetOnChange(nullptr);
+}
+
+void FrameScheduler::WaitForNextFrame() {
+    const auto wait_start = Clock::now();
+    for (;;) {
+        if (pending_frames_ > 0) {
+            --pending_frames_;
+            break;
+        }
+        auto deadline = deadline_;
+        if (watcher_ != nullptr) deadline = std::min(deadline, watcher_->NextReadyTime());
+        if (deadline <= Clock::now()) {
+            deadline_ = Clock::time_point::max();
+            break;
+        }
+        if (backend_.Wait(deadline)) {
+            last_input_ = Clock::now();
+            RequestFrames(kFramesAfterInput);
+        }
+    }
+    const auto now = Clock::now();
+    stats_idle_ += now - wait_start;
+    ++frame_count_;
+    ++stats_frames_;
+    UpdateStats(now);
+}
+
+void FrameScheduler::RequestFrames(int count) {
+    pending_frames_ = std::max(pending_frames_, count);
+}
+
+void FrameScheduler::RequestFrameAt(Clock::time_point time) {
+    deadline_ = std::min(deadline_, time);
+}
+
+void FrameScheduler::UpdateStats(Clock::time_point now) {
+    const auto elapsed = now - stats_start_;
+    if (elapsed < std::chrono::seconds(1)) return;
+    const auto cpu = ProcessCpuTime();
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    stats_.frames_per_second = stats_frames_ / seconds;
+    stats_.idle_fraction = std::chrono::duration<double>(stats_idle_).count() / seconds;
+    stats_.cpu_usage = std::chrono::duration<double>(cpu - stats_cpu_start_).count() / seconds;
+    stats_start_ = now;
+    stats_cpu_start_ = cpu;
+    stats_idle_ = {};
+    stats_frames_ = 0;
+}
+
+}  // namespace falcon_ui
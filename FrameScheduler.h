@@ -0,0 +1,118 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+#include "FileWatcher.h"
+
+
+namespace falcon_ui {
+
+// Waits for what makes the UI draw a frame: input, or a wake up from another thread.
+class FrameBackend {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    virtual ~FrameBackend() = default;
+
+    // Blocks until there is input, Wake() is called or deadline passes. Returns true if there is input.
+    virtual bool Wait(Clock::time_point deadline) = 0;
+    // Makes Wait return. Thread safe.
+    virtual void Wake() = 0;
+};
+
+#ifdef _WIN32
+// Waits for the window messages of the calling thread. The messages are left in the queue.
+class Win32FrameBackend final : public FrameBackend {
+public:
+    Win32FrameBackend();
+    ~Win32FrameBackend() override;
+    Win32FrameBackend(const Win32FrameBackend&) = delete;
+    Win32FrameBackend& operator=(const Win32FrameBackend&) = delete;
+
+    bool Wait(Clock::time_point deadline) override;
+    void Wake() override;
+
+private:
+    // Event HANDLE, set by Wake.
+    void* wake_event_ = nullptr;
+};
+#endif
+
+// Input is posted by the caller, for running the UI without a window (tests, the command line...).
+class HeadlessFrameBackend final : public FrameBackend {
+public:
+    bool Wait(Clock::time_point deadline) override;
+    void Wake() override;
+
+    // Simulates an input event. Thread safe.
+    void PostInput();
+
+private:
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool input_ = false;
+    bool woken_ = false;
+};
+
+// Decides when the next frame is drawn, so the UI only draws when something may have changed on screen:
+// - after input, for a few frames (ImGui needs them to settle hover and layout changes),
+// - when a watched file changed (see FileWatcher),
+// - when the UI asks for it, for example while dragging or for the next text cursor blink.
+// Otherwise the UI thread is blocked in the backend and uses no CPU.
+class FrameScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Frames drawn after an input event.
+    static constexpr int kFramesAfterInput = 3;
+
+    struct Stats {
+        double frames_per_second = 0.0;
+        // Fraction of the time the UI thread was blocked waiting for the next frame.
+        double idle_fraction = 0.0;
+        // Process CPU time over wall time (1.0 is a full core).
+        double cpu_usage = 0.0;
+    };
+
+    // watcher may be null, otherwise it wakes the scheduler up when files change.
+    explicit FrameScheduler(FrameBackend& backend, FileWatcher* watcher = nullptr);
+    ~FrameScheduler();
+    FrameScheduler(const FrameScheduler&) = delete;
+    FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+    // Blocks until the next frame must be drawn.
+    void WaitForNextFrame();
+
+    // Asks for count frames right after this one.
+    void RequestFrames(int count);
+    // Asks for a frame at time (at the latest).
+    void RequestFrameAt(Clock::time_point time);
+    void RequestFrameIn(Clock::duration delay) { RequestFrameAt(Clock::now() + delay); }
+
+    Clock::time_point LastInputTime() const { return last_input_; }
+
+    // Over about the last second, updated at most once a second when a frame is drawn.
+    const Stats& GetStats() const { return stats_; }
+    uint64_t FrameCount() const { return frame_count_; }
+
+private:
+    void UpdateStats(Clock::time_point now);
+
+    FrameBackend& backend_;
+    FileWatcher* watcher_;
+    int pending_frames_ = 1;
+    Clock::time_point deadline_ = Clock::time_point::max();
+    Clock::time_point last_input_;
+    uint64_t frame_count_ = 0;
+
+    Stats stats_;
+    Clock::time_point stats_start_;
+    Clock::duration stats_cpu_start_{};
+    Clock::duration stats_idle_{};
+    uint64_t stats_frames_ = 0;
+};
+
+}  // namespace falcon_ui
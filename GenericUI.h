@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+
+namespace falcon_ui {
+
+// The UI abstraction is contained here. Subclasses implement the look and feel: the editor window (WindowUI) or the
+// command line validation (HeadlessUI), picked by CreateUI in main.cpp.
+class GenericUI {
+public:
+    virtual ~GenericUI() {}
+
+    // Fires up any initialization of the UI and runs until the program ends.
+    virtual void Run() = 0;
+
+    // Exit code of the program once Run() returned.
+    virtual int ExitCode() const { return 0; }
+
+protected:
+    // Used for PickOptions.
+    struct SelectionState {
+        int selection = -1;
+        bool selected = false;
+    };
+
+private:
+    virtual std::string PickOption(SelectionState& selection_state, const std::string& title, const std::vector<std::string>& options) = 0;
+};
+
+}  // namespace falcon_ui
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+
+namespace falcon_ui {
+
+// Final mix of a 64 bit value (from splitmix64), spreads every input bit over the output.
+inline uint64_t MixHash(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+inline uint64_t CombineHash(uint64_t seed, uint64_t value) {
+    return MixHash(seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2)));
+}
+
+// Fast non cryptographic hash of bytes, 8 at a time. Stable across runs and machines (of the same endianness),
+// so it can be persisted.
+inline uint64_t HashBytes(std::string_view bytes, uint64_t seed = 0) {
+    uint64_t hash = MixHash(seed ^ (bytes.size() * 0x9E3779B97F4A7C15ull));
+    const char* p = bytes.data();
+    size_t remaining = bytes.size();
+    for (; remaining >= 8; p += 8, remaining -= 8) {
+        uint64_t word;
+        std::memcpy(&word, p, 8);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 32;
+    }
+    if (remaining > 0) {
+        uint64_t word = 0;
+        std::memcpy(&word, p, remaining);
+        hash = (hash ^ word) * 0xFF51AFD7ED558CCDull;
+    }
+    return MixHash(hash);
+}
+
+}  // namespace falcon_ui
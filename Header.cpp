@@ -4,6 +4,9 @@
 #include <filesystem>
 #include <iostream>
 #include <string>
+#include <string_view>
+
+#include "Tracing.h"
 
 
 namespace {
@@ -22,6 +25,7 @@ std::string::const_iterator FindStringInStringCaseInsensitive(const std::string&
     );
 }
 
+#ifdef _WIN32
 std::vector<std::string> GetAllBMSInstallations(HKEY hKey) {
     constexpr int kMaxCharLength{ 512 };
 
@@ -81,6 +85,7 @@ std::vector<std::string> GetAllBMSInstallations(HKEY hKey) {
     }
     return installation_list;
 }
+#endif
 }  // namespace
 
 std::string GetAndShowChoice(const std::string& default_choice) {
@@ -92,6 +97,7 @@ std::string GetAndShowChoice(const std::string& default_choice) {
     return str;
 }
 
+#ifdef _WIN32
 namespace {
 std::string InstallDirForRegKey(const std::string& reg_key) {
     HKEY hkey;
@@ -114,14 +120,20 @@ std::string InstallDirForRegKey(const std::string& reg_key) {
     return {};
 }
 }  // namespace
+#endif
 
 std::string InstallDirForInstallation(const std::string& installation) {
+#ifdef _WIN32
     return InstallDirForRegKey(BMS_REG_KEY + "\\" + installation);
+#else
+    (void)installation;
+    return {};
+#endif
 }
 
 namespace {
 std::optional<std::string> PickInstallationFromList(const std::vector<std::string>& installation_list) {
-    for (int i = 0; i < installation_list.size(); ++i) {
+    for (size_t i = 0; i < installation_list.size(); ++i) {
         std::cout << "  (" << i << ") " << installation_list[i] << std::endl;
     }
     std::cout << "  (.) Any other key to exit\n";
@@ -129,7 +141,7 @@ std::optional<std::string> PickInstallationFromList(const std::vector<std::strin
     std::cout << "  > ";
     const auto nr = std::stoi(GetAndShowChoice("-1"));
 
-    if (nr < 0 || nr >= installation_list.size()) {
+    if (nr < 0 || static_cast<size_t>(nr) >= installation_list.size()) {
         std::cerr << "  Invalid choice, exiting...\n";
         return std::nullopt;
     }
@@ -141,23 +153,64 @@ std::optional<std::string> PickInstallationFromList(const std::vector<std::strin
 std::string BaseDirFromInstallationList(const std::vector<std::string>& installation_list) {
     const auto reg_key = PickInstallationFromList(installation_list);
     if (!reg_key.has_value()) { return{}; }
+#ifdef _WIN32
     return InstallDirForRegKey(*reg_key);
+#else
+    return {};
+#endif
 }
 
 std::vector<std::string> GetAllBMSInstallations() {
+#ifdef _WIN32
     HKEY hkey;
     if (RegOpenKeyExA(HKEY_LOCAL_MACHINE, BMS_REG_KEY.c_str(), 0, KEY_READ, &hkey) == ERROR_SUCCESS) {
         return GetAllBMSInstallations(hkey);
     }
+#endif
     return {};
 }
 
+std::string NativePath(const std::string& path) {
+#ifdef _WIN32
+    return path;
+#else
+    std::string native = path;
+    std::replace(native.begin(), native.end(), '\\', '/');
+    std::error_code error;
+    if (std::filesystem::exists(native, error)) return native;
+
+    // Once a part is not found in any case, the rest is kept as written.
+    std::filesystem::path resolved;
+    bool found = true;
+    for (const auto& part : std::filesystem::path(native)) {
+        auto candidate = resolved / part;
+        if (found && !std::filesystem::exists(candidate, error)) {
+            const auto name = part.string();
+            for (const auto& entry : std::filesystem::directory_iterator(resolved.empty() ? "." : resolved, error)) {
+                if (IsEqualCaseInsensitiveString(entry.path().filename().string(), name)) {
+                    candidate = resolved / entry.path().filename();
+                    break;
+                }
+            }
+            found = std::filesystem::exists(candidate, error);
+        }
+        resolved = std::move(candidate);
+    }
+    return resolved.string();
+#endif
+}
+
 namespace {
 const char kDefaultTheaterName[] = "Default";
 }  // namespace
 
+std::string TheaterListPath(const std::string& base_folder) {
+    return NativePath(base_folder + "\\Data\\TerrData\\TheaterDefinition\\theater.lst");
+}
+
 std::vector<std::string> ListTheaters(const std::string& base_folder) {
-    std::fstream theater_list_file{ base_folder + "\\Data\\TerrData\\TheaterDefinition\\theater.lst" };
+    FALCON_UI_TRACE_SCOPE_DETAIL("ListTheaters", base_folder);
+    std::fstream theater_list_file{ TheaterListPath(base_folder) };
     std::vector<std::string> theater_list;
 
     if (theater_list_file.good()) {
@@ -179,14 +232,49 @@ std::string DataDirForTheater(const std::string& theater) {
     return theater == kDefaultTheaterName ? std::string{ "\\Data" } : "\\Data\\" + theater;
 }
 
+namespace {
+std::string_view WindowListSuffix(UiType ui_type) {
+    return ui_type == UiType::FHD ? "_Scf_fhd.lst" : "_Scf.lst";
+}
+}  // namespace
+
+std::string ArtDirForTheater(const std::string& theater_data_dir) {
+    return NativePath(theater_data_dir + "\\Art");
+}
+
+std::string WindowListPath(const std::string& theater_data_dir, const std::string& ui_set, UiType ui_type) {
+    return NativePath(ArtDirForTheater(theater_data_dir) + "\\" + ui_set + std::string(WindowListSuffix(ui_type)));
+}
+
 std::vector<std::string> GetWindowList(const std::string& theater_data_dir, const std::string& ui_set, UiType ui_type) {
-    std::fstream window_list_file { theater_data_dir + "\\Art\\" + ui_set + (ui_type == UiType::FHD ? "_Scf_fhd.lst" : "_Scf.lst") };
+    FALCON_UI_TRACE_SCOPE_DETAIL("GetWindowList", ui_set);
+    std::fstream window_list_file { WindowListPath(theater_data_dir, ui_set, ui_type) };
     std::vector<std::string> windows;
 
     std::string line;
     for (getline(window_list_file, line); window_list_file.good(); getline(window_list_file, line)) {
+      // Skip blank lines and drop the '\r' left by CRLF files.
+      const auto end = line.find_last_not_of(" \t\r");
+      if (end == std::string::npos) continue;
+      line.erase(end + 1);
       windows.emplace_back(line);
     }
     window_list_file.close();
     return windows;
 }
+
+std::vector<std::string> ListUISets(const std::string& theater_data_dir, UiType ui_type) {
+    FALCON_UI_TRACE_SCOPE_DETAIL("ListUISets", theater_data_dir);
+    const auto suffix = WindowListSuffix(ui_type);
+    std::vector<std::string> ui_sets;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(ArtDirForTheater(theater_data_dir), error)) {
+        if (!entry.is_regular_file(error)) continue;
+        const auto filename = entry.path().filename().string();
+        if (filename.size() <= suffix.size()) continue;
+        if (!IsEqualCaseInsensitiveString(filename.substr(filename.size() - suffix.size()), std::string(suffix))) continue;
+        ui_sets.emplace_back(filename.substr(0, filename.size() - suffix.size()));
+    }
+    std::sort(ui_sets.begin(), ui_sets.end());
+    return ui_sets;
+}
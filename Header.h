@@ -3,19 +3,30 @@
 #include <fstream>
 #include <vector>
 #include <optional>
+#include <string>
+#ifdef _WIN32
 #define VC_EXTRALEAN
 #define WIN32_LEAN_AND_MEAN
 #define NOMINMAX
 #include <Windows.h>
+#endif
 
 const std::string BMS_REG_KEY{ "SOFTWARE\\WOW6432Node\\Benchmark Sims" };
 
+// Installations registered in the Windows registry. None elsewhere, where install folders are given by the user.
 std::vector<std::string> GetAllBMSInstallations();
 std::string InstallDirForInstallation(const std::string& installation);
 std::string BaseDirFromInstallationList(const std::vector<std::string>& installation_list);
 
+// The paths below are built with '\\' and the file names in the lists have any case ("art\\main\\Main_Win.scf"), as
+// the game reads them on Windows. Returns path as is on Windows. Elsewhere, uses '/' and matches each part of the path
+// case insensitively with the existing files if it does not exist as written.
+std::string NativePath(const std::string& path);
+
 // Theaters.
 std::vector<std::string> ListTheaters(const std::string& base_folder);
+// File listing the theaters, read by ListTheaters.
+std::string TheaterListPath(const std::string& base_folder);
 std::string DataDirForTheater(const std::string& theater);
 
 // Art files.
@@ -24,4 +35,9 @@ enum class UiType {
   FHD
 };
 std::vector<std::string> GetWindowList(const std::string& theater_data_dir, const std::string& ui_set, UiType ui_type = UiType::FHD);
+// Folder with the window lists of the theater, and file read by GetWindowList.
+std::string ArtDirForTheater(const std::string& theater_data_dir);
+std::string WindowListPath(const std::string& theater_data_dir, const std::string& ui_set, UiType ui_type = UiType::FHD);
+// UI sets with a window list in the Art folder of the theater (for example "Main" for Main_Scf_fhd.lst).
+std::vector<std::string> ListUISets(const std::string& theater_data_dir, UiType ui_type = UiType::FHD);
 
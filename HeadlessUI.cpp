@@ -0,0 +1,214 @@
+#include "HeadlessUI.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+
+#include "Tracing.h"
+
+
+namespace falcon_ui {
+
+namespace {
+
+constexpr const char kUsage[] =
+    " --validate [flags]\n"
+    "Validates every window of every theater, prints the issues and exits with 1 if there are errors.\n"
+    "  --install-dir <dir>    Installation folder, can be repeated. Default: the installations of the registry.\n"
+    "  --installation <name>  Only this installation of the registry.\n"
+    "  --theater <name>       Only this theater (\"Default\" for the default one).\n"
+    "  --ui fhd|standard      Window lists to validate, default fhd.\n"
+    "  --checks <list>        Comma separated checks, default all: bounds,unknown_tag,schema,missing_asset,\n"
+    "                         duplicate_label,overlap.\n"
+    "  --threads <n>          Threads loading and validating, default one per core.\n"
+    "  --json <file>          Writes the JSON report (- for the standard output).\n"
+    "  --junit <file>         Writes the JUnit XML report.\n"
+    "  --werror               Warnings fail the validation too.\n"
+    "  --quiet                Only prints the summary.\n"
+    "  --trace <file>         Records a Chrome trace of the run.\n";
+
+bool EqualCaseInsensitive(std::string_view a, std::string_view b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+// Writes to path, or the standard output for "-". Returns false if the file could not be written.
+template <typename Writer>
+bool WriteReport(const std::string& path, const Writer& writer) {
+    if (path == "-") {
+        writer(std::cout);
+        return true;
+    }
+    std::ofstream out(path, std::ios::binary);
+    writer(out);
+    out.close();
+    if (!out) std::cerr << "Unable to write " << path << std::endl;
+    return static_cast<bool>(out);
+}
+
+double Seconds(std::chrono::nanoseconds time) {
+    return std::chrono::duration<double>(time).count();
+}
+
+}  // namespace
+
+bool HeadlessUI::Requested(int argc, char** argv) {
+    return std::any_of(argv + 1, argv + argc, [](const char* argument) { return std::string_view(argument) == "--validate"; });
+}
+
+bool HeadlessUI::ParseArguments() {
+    bool all_checks = true;
+    for (size_t i = 0; i < arguments_.size(); ++i) {
+        const std::string_view flag = arguments_[i];
+        if (flag == "--validate") continue;
+        if (flag == "--help") {
+            std::cout << "Usage: " << program_ << kUsage;
+            return false;
+        }
+        if (flag == "--werror") {
+            warnings_as_errors_ = true;
+            continue;
+        }
+        if (flag == "--quiet") {
+            quiet_ = true;
+            continue;
+        }
+        if (i + 1 == arguments_.size()) {
+            std::cerr << "Missing value for " << flag << "\nUsage: " << program_ << kUsage;
+            exit_code_ = 2;
+            return false;
+        }
+        const auto& value = arguments_[++i];
+        if (flag == "--install-dir") {
+            install_dirs_.push_back(value);
+        } else if (flag == "--installation") {
+            picks_["installation"] = value;
+        } else if (flag == "--theater") {
+            picks_["theater"] = value;
+        } else if (flag == "--ui") {
+            if (value != "fhd" && value != "standard") {
+                std::cerr << "Invalid value " << value << " for --ui, expected fhd or standard\nUsage: " << program_ << kUsage;
+                exit_code_ = 2;
+                return false;
+            }
+            load_options_.ui_type = value == "fhd" ? UiType::FHD : UiType::STANDARD;
+        } else if (flag == "--checks") {
+            if (all_checks) validation_options_.checks = 0;
+            all_checks = false;
+            for (size_t start = 0; start <= value.size();) {
+                const auto end = std::min(value.find(',', start), value.size());
+                const auto check = CheckFromName(std::string_view(value).substr(start, end - start));
+                if (!check.has_value()) {
+                    std::cerr << "Invalid value " << value << " for --checks, expected a comma separated list of";
+                    for (size_t c = 0; c < kCheckCount; ++c) std::cerr << (c == 0 ? " " : ",") << CheckName(static_cast<Check>(c));
+                    std::cerr << "\nUsage: " << program_ << kUsage;
+                    exit_code_ = 2;
+                    return false;
+                }
+                validation_options_.checks |= 1u << static_cast<uint32_t>(*check);
+                start = end + 1;
+            }
+        } else if (flag == "--threads") {
+            load_options_.thread_count = validation_options_.thread_count = static_cast<unsigned>(std::max(0, std::atoi(value.c_str())));
+        } else if (flag == "--json") {
+            json_path_ = value;
+        } else if (flag == "--junit") {
+            junit_path_ = value;
+        } else if (flag == "--trace") {
+            // Handled by main.
+        } else {
+            std::cerr << "Unknown flag " << flag << " " << value << "\nUsage: " << program_ << kUsage;
+            exit_code_ = 2;
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string HeadlessUI::PickOption(SelectionState& selection_state, const std::string& title, const std::vector<std::string>& options) {
+    const auto& pick = picks_[title];
+    for (int i = 0; i < static_cast<int>(options.size()); ++i) {
+        if (!EqualCaseInsensitive(options[i], pick)) continue;
+        selection_state.selection = i;
+        selection_state.selected = true;
+        return options[i];
+    }
+    return "";
+}
+
+std::vector<TheaterLocation> HeadlessUI::Theaters() {
+    if (install_dirs_.empty()) {
+        const auto installations = GetAllBMSInstallations();
+        if (picks_.contains("installation")) {
+            SelectionState selection;
+            const auto installation = PickOption(selection, "installation", installations);
+            if (!selection.selected) {
+                std::cerr << "Unknown installation " << picks_["installation"] << std::endl;
+                return {};
+            }
+            install_dirs_.push_back(InstallDirForInstallation(installation));
+        } else {
+            for (const auto& installation : installations) install_dirs_.push_back(InstallDirForInstallation(installation));
+        }
+    }
+
+    std::vector<TheaterLocation> theaters;
+    for (const auto& install_dir : install_dirs_) {
+        const auto install_theaters = ListTheaters(install_dir);
+        if (install_theaters.empty()) std::cerr << "No theater in " << TheaterListPath(install_dir) << std::endl;
+        if (!picks_.contains("theater")) {
+            for (const auto& theater : install_theaters) theaters.push_back({ install_dir, theater });
+            continue;
+        }
+        SelectionState selection;
+        const auto theater = PickOption(selection, "theater", install_theaters);
+        if (selection.selected) theaters.push_back({ install_dir, theater });
+    }
+    return theaters;
+}
+
+bool HeadlessUI::WriteReports(const ValidationReport& report) const {
+    bool written = true;
+    if (!json_path_.empty()) written &= WriteReport(json_path_, [&report](std::ostream& out) { WriteJsonReport(report, out); });
+    if (!junit_path_.empty()) written &= WriteReport(junit_path_, [&report](std::ostream& out) { WriteJUnitReport(report, out); });
+    return written;
+}
+
+void HeadlessUI::Run() {
+    FALCON_UI_TRACE_SCOPE("HeadlessUI::Run");
+    if (!ParseArguments()) return;
+    const auto theaters = Theaters();
+    if (theaters.empty()) {
+        std::cerr << "Nothing to validate, pass the installation with --install-dir.\n";
+        exit_code_ = 2;
+        return;
+    }
+
+    auto load = LoadTheaters(theaters, load_options_);
+    if (load->windows.empty()) {
+        std::cerr << "No windows in the window lists of the " << theaters.size() << " theater(s).\n";
+        exit_code_ = 2;
+        return;
+    }
+    const auto report = Validate(std::move(load), validation_options_);
+
+    // The issues on the standard output, unless it is taken by a report.
+    const bool report_on_stdout = json_path_ == "-" || junit_path_ == "-";
+    if (!quiet_ && !report_on_stdout) WriteTextReport(report, std::cout);
+    char summary[256];
+    snprintf(summary, sizeof(summary), "Validated %zu windows (%zu files) of %zu theaters, loaded in %.2f s and validated in %.2f s on %u threads: %zu errors, %zu warnings.\n",
+        report.load->windows.size(), report.files.size(), theaters.size(), Seconds(report.load->wall_time), Seconds(report.wall_time), report.thread_count,
+        report.errors, report.warnings);
+    (report_on_stdout ? std::cerr : std::cout) << summary;
+
+    if (!WriteReports(report)) {
+        exit_code_ = 2;
+        return;
+    }
+    exit_code_ = report.errors > 0 || (warnings_as_errors_ && report.warnings > 0) ? 1 : 0;
+}
+
+}  // namespace falcon_ui
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "BulkLoader.h"
+#include "GenericUI.h"
+#include "Validation.h"
+
+
+namespace falcon_ui {
+
+// Validates all the windows from the command line, without any window or GPU, for CI: loads every window of every
+// theater of the installations in parallel, runs the validators (see Validation.h), prints the issues as compilers do
+// and writes the JSON and JUnit reports. Picked by CreateUI with --validate, and the only UI outside Windows.
+// Exits with 1 if there are errors, 2 if the command line or the installation is wrong. --help lists the flags.
+class HeadlessUI : public GenericUI {
+public:
+    HeadlessUI(int argc, char** argv) : program_(argv[0]), arguments_(argv + 1, argv + argc) {}
+
+    // True if the command line asks for the validation instead of the editor.
+    static bool Requested(int argc, char** argv);
+
+    void Run() override;
+    int ExitCode() const override { return exit_code_; }
+
+private:
+    // Returns false if there is nothing to run: --help, or a wrong command line (after printing why, with exit code 2).
+    bool ParseArguments();
+    // The theaters to validate: the named one or all of each installation.
+    std::vector<TheaterLocation> Theaters();
+    bool WriteReports(const ValidationReport& report) const;
+
+    // Picks the option given for title ("installation", "theater") on the command line, case insensitive. Returns ""
+    // if the command line names none of the options.
+    std::string PickOption(SelectionState& selection_state, const std::string& title, const std::vector<std::string>& options) override;
+
+    std::string program_;
+    std::vector<std::string> arguments_;
+    std::vector<std::string> install_dirs_;
+    // Values of --installation and --theater, by PickOption title.
+    std::unordered_map<std::string, std::string> picks_;
+    BulkLoadOptions load_options_;
+    ValidationOptions validation_options_;
+    std::string json_path_;
+    std::string junit_path_;
+    bool warnings_as_errors_ = false;
+    bool quiet_ = false;
+    int exit_code_ = 0;
+};
+
+}  // namespace falcon_ui
@@ -0,0 +1,163 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <string>
+
+
+namespace falcon_ui {
+
+namespace {
+
+// Index of the worker running on this thread, or kNotAWorker.
+constexpr unsigned kNotAWorker = ~0u;
+thread_local unsigned t_worker = kNotAWorker;
+thread_local const JobSystem* t_system = nullptr;
+thread_local JobPriority t_priority = JobPriority::INTERACTIVE;
+
+const char* QueuedCounterName(JobPriority priority) {
+    switch (priority) {
+        case JobPriority::INTERACTIVE: return "Jobs queued (interactive)";
+        case JobPriority::PREVIEW: return "Jobs queued (preview)";
+        case JobPriority::BACKGROUND: return "Jobs queued (background)";
+    }
+    return "";
+}
+
+}  // namespace
+
+JobSystem& JobSystem::Get() {
+    static JobSystem system;
+    return system;
+}
+
+JobSystem::JobSystem(unsigned worker_count) {
+    // Workers trace until they stop: the tracer must be constructed first, so it is destroyed last.
+    Tracer::Get();
+    if (worker_count == 0) worker_count = std::max(2u, std::thread::hardware_concurrency());
+    workers_.reserve(worker_count);
+    for (unsigned i = 0; i < worker_count; ++i) workers_.push_back(std::make_unique<Worker>());
+    for (unsigned i = 0; i < worker_count; ++i) {
+        workers_[i]->thread = std::thread([this, i] { Run(i); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard lock(sleep_mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) worker->thread.join();
+}
+
+JobPriority JobSystem::CurrentPriority() {
+    return t_priority;
+}
+
+void JobSystem::Schedule(JobPriority priority, Job job) {
+    const auto lane = static_cast<size_t>(priority);
+    // Jobs scheduled by a job stay with its worker, where their data is likely to be in cache.
+    const unsigned index = t_system == this ? t_worker : next_worker_.fetch_add(1, std::memory_order_relaxed) % WorkerCount();
+    // Counted before the push, so the counts never go below 0 when the job is taken right away. Outside the trace
+    // macros, which compile out.
+    [[maybe_unused]] const auto queued = queued_[lane].fetch_add(1, std::memory_order_relaxed) + 1;
+    FALCON_UI_TRACE_COUNTER(QueuedCounterName(priority), static_cast<double>(queued));
+    queued_total_.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard lock(workers_[index]->mutex);
+        workers_[index]->lanes[lane].push_back(std::move(job));
+    }
+    // Taking the lock orders the increment before the check of a worker going to sleep.
+    { std::lock_guard lock(sleep_mutex_); }
+    wake_.notify_one();
+}
+
+bool JobSystem::TakeJob(unsigned index, JobPriority lowest, Job& job, JobPriority& priority) {
+    const auto take = [&](unsigned victim, size_t lane) {
+        auto& worker = *workers_[victim];
+        std::lock_guard lock(worker.mutex);
+        auto& queue = worker.lanes[lane];
+        if (queue.empty()) return false;
+        if (victim == index) {
+            job = std::move(queue.back());
+            queue.pop_back();
+        } else {
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+        return true;
+    };
+    const auto worker_count = WorkerCount();
+    for (size_t lane = 0; lane <= static_cast<size_t>(lowest); ++lane) {
+        if (queued_[lane].load(std::memory_order_relaxed) == 0) continue;
+        bool taken = take(index, lane);
+        for (unsigned offset = 1; !taken && offset < worker_count; ++offset) {
+            taken = take((index + offset) % worker_count, lane);
+            if (!taken) continue;
+            [[maybe_unused]] const auto steals = steals_.fetch_add(1, std::memory_order_relaxed) + 1;
+            FALCON_UI_TRACE_COUNTER("Job steals", static_cast<double>(steals));
+        }
+        if (!taken) continue;
+        priority = static_cast<JobPriority>(lane);
+        [[maybe_unused]] const auto queued = queued_[lane].fetch_sub(1, std::memory_order_relaxed) - 1;
+        FALCON_UI_TRACE_COUNTER(QueuedCounterName(priority), static_cast<double>(queued));
+        queued_total_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::Execute(Job& job, JobPriority priority) {
+    const auto previous = t_priority;
+    t_priority = priority;
+    job();
+    t_priority = previous;
+    executed_.fetch_add(1, std::memory_order_relaxed);
+    // Releases what the job holds now, not when the next one replaces it.
+    job = nullptr;
+}
+
+void JobSystem::Run(unsigned index) {
+    FALCON_UI_TRACE_THREAD_NAME("Worker " + std::to_string(index));
+    t_worker = index;
+    t_system = this;
+    Job job;
+    JobPriority priority;
+    while (true) {
+        if (TakeJob(index, JobPriority::BACKGROUND, job, priority)) {
+            Execute(job, priority);
+            continue;
+        }
+        std::unique_lock lock(sleep_mutex_);
+        // Once stopping, the workers leave when the queues are empty.
+        if (stopping_ && queued_total_.load(std::memory_order_acquire) == 0) return;
+        wake_.wait(lock, [this] { return stopping_ || queued_total_.load(std::memory_order_acquire) > 0; });
+    }
+}
+
+bool JobSystem::HigherQueued(JobPriority priority) const {
+    for (size_t lane = 0; lane < static_cast<size_t>(priority); ++lane) {
+        if (queued_[lane].load(std::memory_order_relaxed) > 0) return true;
+    }
+    return false;
+}
+
+void JobSystem::RunHigher(JobPriority priority) {
+    if (t_system != this || priority == JobPriority::INTERACTIVE) return;
+    Job job;
+    JobPriority job_priority;
+    while (HigherQueued(priority) && TakeJob(t_worker, static_cast<JobPriority>(static_cast<size_t>(priority) - 1), job, job_priority)) {
+        Execute(job, job_priority);
+    }
+}
+
+JobSystem::Stats JobSystem::GetStats() const {
+    Stats stats;
+    for (size_t lane = 0; lane < kJobPriorityCount; ++lane) stats.queued[lane] = queued_[lane].load(std::memory_order_relaxed);
+    stats.executed = executed_.load(std::memory_order_relaxed);
+    stats.steals = steals_.load(std::memory_order_relaxed);
+    stats.worker_count = WorkerCount();
+    return stats;
+}
+
+}  // namespace falcon_ui
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Tracing.h"
+
+
+namespace falcon_ui {
+
+// The lanes of the job system, in the order workers take jobs from them.
+enum class JobPriority : uint8_t {
+    INTERACTIVE,  // What the user waits for, like the window being opened.
+    PREVIEW,      // Shown but not waited for, like the window under the picker selection.
+    BACKGROUND,   // Indexing, searching and comparing installations.
+};
+
+inline constexpr size_t kJobPriorityCount = 3;
+
+// Cooperative cancellation: jobs check Cancelled() between pieces of work and return early. Copies share the flag.
+class CancellationToken {
+public:
+    // A token which is never cancelled.
+    CancellationToken() = default;
+
+    bool Cancelled() const { return flag_ != nullptr && flag_->load(std::memory_order_relaxed); }
+
+private:
+    friend class CancellationSource;
+    explicit CancellationToken(std::shared_ptr<const std::atomic<bool>> flag) : flag_(std::move(flag)) {}
+
+    std::shared_ptr<const std::atomic<bool>> flag_;
+};
+
+// The owner side of a CancellationToken.
+class CancellationSource {
+public:
+    CancellationSource() : flag_(std::make_shared<std::atomic<bool>>(false)) {}
+
+    CancellationToken Token() const { return CancellationToken(flag_); }
+    // Does nothing on a moved from source.
+    void Cancel() {
+        if (flag_ != nullptr) flag_->store(true, std::memory_order_relaxed);
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+class JobSystem;
+
+// The result of a job submitted with JobSystem::Submit, with the means to cancel it. Its destructor cancels the job and
+// waits for it, so the job can use whatever the owner of the JobFuture owns. Used from one thread.
+template <typename T>
+class JobFuture {
+public:
+    JobFuture() = default;
+    JobFuture(std::future<T> future, CancellationSource cancel, std::function<void()> job)
+        : future_(std::move(future)), cancel_(std::move(cancel)), job_(std::move(job)) {}
+    ~JobFuture() { Reset(); }
+
+    JobFuture(JobFuture&&) = default;
+    JobFuture& operator=(JobFuture&& other) {
+        Reset();
+        future_ = std::move(other.future_);
+        cancel_ = std::move(other.cancel_);
+        job_ = std::move(other.job_);
+        return *this;
+    }
+
+    // True from the submission until Get().
+    bool Valid() const { return future_.valid(); }
+    bool Ready() const { return future_.valid() && future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+    // Waits for the job and takes its result.
+    T Get() { return future_.get(); }
+    void Cancel() { cancel_.Cancel(); }
+
+private:
+    friend class JobSystem;
+
+    void Reset() {
+        if (!future_.valid()) return;
+        cancel_.Cancel();
+        future_.wait();
+    }
+
+    std::future<T> future_;
+    CancellationSource cancel_;
+    // The queued job, which JobSystem::Reprioritize queues again. Only the first copy taken runs the function.
+    std::function<void()> job_;
+};
+
+// Runs jobs on a pool of worker threads. Each worker has its own queues, one per priority lane: it takes its newest job
+// from them (the one whose data is the most likely to still be in cache), and once they are empty steals the oldest job
+// of another worker. Lanes come first: a worker takes an interactive job from anywhere before a background one of its
+// own, and loops of lower lanes step aside between items (see ParallelFor).
+// Jobs are not preempted, long jobs must be split (with ParallelFor) to let the higher lanes through.
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+    // Counters for profiling, also recorded as trace counters.
+    struct Stats {
+        // Jobs waiting, per lane.
+        std::array<size_t, kJobPriorityCount> queued{};
+        uint64_t executed = 0;
+        // Jobs taken from the queues of another worker.
+        uint64_t steals = 0;
+        unsigned worker_count = 0;
+    };
+
+    // The system of the editor, started on first use with one worker per core (at least two).
+    static JobSystem& Get();
+
+    // worker_count 0 uses one per core, at least two so a background job does not hold up the other lanes on one core.
+    explicit JobSystem(unsigned worker_count = 0);
+    // Runs the jobs still queued, then stops the workers.
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void Schedule(JobPriority priority, Job job);
+
+    // Runs function(token) on a worker, token being the one of the returned future. The function checks it to return
+    // early once cancelled, it is called even if the job was cancelled before it started.
+    template <typename Function>
+    auto Submit(JobPriority priority, Function function) -> JobFuture<std::invoke_result_t<Function&, const CancellationToken&>>;
+    // Queues the job of future again in the priority lane, for example a preview load the user now waits for. The job
+    // runs once, from whichever lane it is taken first. A job already running stays in its lane.
+    template <typename T>
+    void Reprioritize(const JobFuture<T>& future, JobPriority priority);
+
+    // Calls function(index, worker) for every index in [0, count) and returns once all calls returned. Runs on the
+    // calling thread and on up to thread_count - 1 workers, in the lane priority. worker is the slot of the thread in
+    // this loop, below thread_count and 0 for the calling thread, for per thread scratch.
+    // Indices are handed out one at a time, so a few big items do not leave the other threads idle. Between items,
+    // workers leave for the jobs of higher lanes (and the calling thread, if a worker, runs them), the calling thread
+    // finishing the loop if need be. Each thread records a span name in traces.
+    template <typename Function>
+    void ParallelFor(size_t count, unsigned thread_count, JobPriority priority, const char* name, const Function& function);
+
+    Stats GetStats() const;
+    unsigned WorkerCount() const { return static_cast<unsigned>(workers_.size()); }
+
+    // The lane of the job running on the calling thread, INTERACTIVE outside jobs.
+    static JobPriority CurrentPriority();
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::array<std::deque<Job>, kJobPriorityCount> lanes;
+        std::thread thread;
+    };
+
+    void Run(unsigned index);
+    // Takes the next job for worker index (the own queues, then stealing), highest lane first, down to lowest.
+    bool TakeJob(unsigned index, JobPriority lowest, Job& job, JobPriority& priority);
+    void Execute(Job& job, JobPriority priority);
+    // True if jobs of a lane higher than priority are queued.
+    bool HigherQueued(JobPriority priority) const;
+    // Runs the queued jobs of the lanes higher than priority, if the calling thread is a worker.
+    void RunHigher(JobPriority priority);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::array<std::atomic<size_t>, kJobPriorityCount> queued_{};
+    std::atomic<size_t> queued_total_{ 0 };
+    std::atomic<uint64_t> executed_{ 0 };
+    std::atomic<uint64_t> steals_{ 0 };
+    // Round robin for jobs scheduled from outside the workers.
+    std::atomic<unsigned> next_worker_{ 0 };
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stopping_ = false;
+};
+
+template <typename Function>
+auto JobSystem::Submit(JobPriority priority, Function function) -> JobFuture<std::invoke_result_t<Function&, const CancellationToken&>> {
+    using Result = std::invoke_result_t<Function&, const CancellationToken&>;
+    CancellationSource cancel;
+    // std::function needs copyable jobs, the task is shared. So are the copies Reprioritize queues, the first to run
+    // sets started.
+    struct Task {
+        std::packaged_task<Result()> run;
+        std::atomic<bool> started{ false };
+    };
+    auto task = std::make_shared<Task>();
+    task->run = std::packaged_task<Result()>([function = std::move(function), token = cancel.Token()]() mutable {
+        return function(token);
+    });
+    auto future = task->run.get_future();
+    Job job = [task] {
+        if (!task->started.exchange(true, std::memory_order_acq_rel)) task->run();
+    };
+    Schedule(priority, job);
+    return { std::move(future), std::move(cancel), std::move(job) };
+}
+
+template <typename T>
+void JobSystem::Reprioritize(const JobFuture<T>& future, JobPriority priority) {
+    if (future.Valid() && !future.Ready()) Schedule(priority, future.job_);
+}
+
+template <typename Function>
+void JobSystem::ParallelFor(size_t count, unsigned thread_count, JobPriority priority, const char* name, const Function& function) {
+    if (count == 0) return;
+    // Shared with the helper jobs, which may start after the loop returned: they find no index left and never touch
+    // function.
+    struct Loop {
+        std::atomic<size_t> next{ 0 };
+        std::atomic<size_t> done{ 0 };
+        std::atomic<unsigned> next_worker{ 1 };
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto loop = std::make_shared<Loop>();
+    const auto run_item = [count, &function](Loop& state, size_t i, unsigned worker) {
+        function(i, worker);
+        if (state.done.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+            { std::lock_guard lock(state.mutex); }
+            state.finished.notify_all();
+        }
+    };
+
+    const auto helpers = std::min<size_t>({ thread_count > 0 ? thread_count - 1 : 0, WorkerCount(), count - 1 });
+    for (size_t h = 0; h < helpers; ++h) {
+        Schedule(priority, [this, loop, count, priority, name, run_item] {
+            FALCON_UI_TRACE_SCOPE(name);
+            const auto worker = loop->next_worker.fetch_add(1, std::memory_order_relaxed);
+            while (!HigherQueued(priority)) {
+                const auto i = loop->next.fetch_add(1, std::memory_order_relaxed);
+                if (i >= count) return;
+                run_item(*loop, i, worker);
+            }
+        });
+    }
+
+    {
+        FALCON_UI_TRACE_SCOPE(name);
+        for (size_t i = loop->next.fetch_add(1, std::memory_order_relaxed); i < count; i = loop->next.fetch_add(1, std::memory_order_relaxed)) {
+            run_item(*loop, i, 0);
+            RunHigher(priority);
+        }
+    }
+    // The items still running on the helpers.
+    std::unique_lock lock(loop->mutex);
+    loop->finished.wait(lock, [&loop, count] { return loop->done.load(std::memory_order_acquire) == count; });
+}
+
+}  // namespace falcon_ui
@@ -0,0 +1,303 @@
+#include "ModelCache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "FileUtil.h"
+#include "Hash.h"
+#include "Tracing.h"
+
+
+namespace falcon_ui {
+
+namespace {
+
+constexpr char kMagic[8] = { 'F', '4', 'U', 'I', 'S', 'C', 'F', 'C' };
+// Bump when the records or the file layout change.
+constexpr uint32_t kVersion = 6;
+
+// Cache file: header, element records, attribute records, comment spans, skipped line spans, the source, the symbol spans and the symbol
+// text, each section 8 byte aligned. Everything is in offsets, so the file is used as is wherever it is mapped.
+// Symbol ids are only valid in the process which interned them: in the file the records hold indices in the symbol
+// spans of the window, which are interned again when the cache is loaded.
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    // A build with different records must not read the arrays.
+    uint16_t element_record_size;
+    uint16_t attribute_record_size;
+    uint64_t path_hash;
+    uint64_t source_size;
+    int64_t source_mtime;
+    uint64_t content_hash;
+    uint32_t element_count;
+    uint32_t attribute_count;
+    uint32_t comment_count;
+    uint32_t skipped_count;
+    uint32_t symbol_count;
+    uint64_t elements_offset;
+    uint64_t attributes_offset;
+    uint64_t comments_offset;
+    uint64_t skipped_offset;
+    uint64_t source_offset;
+    uint64_t symbols_offset;
+    uint64_t symbol_text_offset;
+    uint64_t symbol_text_size;
+};
+
+static_assert(std::is_trivially_copyable_v<CacheHeader>);
+
+std::string GetEnv(const char* name) {
+#ifdef _WIN32
+    char* value = nullptr;
+    size_t size = 0;
+    if (_dupenv_s(&value, &size, name) != 0 || value == nullptr) return {};
+    std::string result(value);
+    free(value);
+    return result;
+#else
+    const char* value = std::getenv(name);
+    return value == nullptr ? std::string{} : std::string(value);
+#endif
+}
+
+// Returns the header of bytes if it is a cache file of path_hash this build can read.
+std::optional<CacheHeader> ReadHeader(std::string_view bytes, uint64_t path_hash) {
+    CacheHeader header;
+    if (bytes.size() < sizeof(header)) return std::nullopt;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) return std::nullopt;
+    if (header.element_record_size != sizeof(ElementRecord) || header.attribute_record_size != sizeof(AttributeRecord)) return std::nullopt;
+    if (header.path_hash != path_hash) return std::nullopt;
+    if (!InBounds(header.elements_offset, uint64_t{ header.element_count } * sizeof(ElementRecord), bytes.size()) ||
+        !InBounds(header.attributes_offset, uint64_t{ header.attribute_count } * sizeof(AttributeRecord), bytes.size()) ||
+        !InBounds(header.comments_offset, uint64_t{ header.comment_count } * sizeof(TextSpan), bytes.size()) ||
+        !InBounds(header.skipped_offset, uint64_t{ header.skipped_count } * sizeof(TextSpan), bytes.size()) ||
+        !InBounds(header.source_offset, header.source_size, bytes.size()) ||
+        !InBounds(header.symbols_offset, uint64_t{ header.symbol_count } * sizeof(TextSpan), bytes.size()) ||
+        !InBounds(header.symbol_text_offset, header.symbol_text_size, bytes.size())) {
+        return std::nullopt;
+    }
+    return header;
+}
+
+bool InSource(TextSpan span, uint64_t source_size) {
+    return uint64_t{ span.offset } + span.length <= source_size;
+}
+
+// True if every index and span of model is within its arrays and the source, and every record is one this build
+// decodes: a damaged cache file is parsed again instead of being read out of bounds.
+bool ValidModel(const WindowModel& model, uint64_t source_size) {
+    for (const auto& element : model.elements) {
+        const auto* spec = SpecForTag(element.tag);
+        if (spec == nullptr || !spec->starts_element || !InSource(element.source, source_size)) return false;
+        if (uint64_t{ element.first_attribute } + element.attribute_count > model.attributes.size()) return false;
+        if (uint64_t{ element.first_comment } + element.comment_count > model.comments.size()) return false;
+    }
+    for (const auto& attribute : model.attributes) {
+        const auto* spec = SpecForTag(attribute.tag);
+        if (spec == nullptr || !spec->is_attribute) return false;
+        if (spec->record == RecordKind::SETUP && attribute.setup.int_count > SetupRecord::kMaxInts) return false;
+        if (spec->record == RecordKind::RANGES && attribute.ranges.count > RangesRecord::kMaxValues) return false;
+        bool valid = true;
+        ForEachSpan(attribute, [&valid, source_size](const TextSpan& span) { valid &= InSource(span, source_size); });
+        if (!valid) return false;
+    }
+    for (const auto& span : model.comments) {
+        if (!InSource(span, source_size)) return false;
+    }
+    for (const auto& span : model.skipped) {
+        if (!InSource(span, source_size)) return false;
+    }
+    return true;
+}
+
+// Sets up window from a cache file with a valid header. Returns false if the model or the symbols of the file are
+// inconsistent.
+bool SetupFromCache(std::string_view cache, const CacheHeader& header, Window& window) {
+    const char* base = cache.data();
+    const std::string_view symbol_text(base + header.symbol_text_offset, header.symbol_text_size);
+    const std::span<const TextSpan> symbol_spans(reinterpret_cast<const TextSpan*>(base + header.symbols_offset), header.symbol_count);
+    // Reused by all the windows loaded on this thread.
+    thread_local std::vector<SymbolId> symbols;
+    thread_local std::vector<AttributeRecord> attributes;
+    const auto* cached_attributes = reinterpret_cast<const AttributeRecord*>(base + header.attributes_offset);
+    attributes.assign(cached_attributes, cached_attributes + header.attribute_count);
+    const WindowModel model{
+        { reinterpret_cast<const ElementRecord*>(base + header.elements_offset), header.element_count },
+        attributes,
+        { reinterpret_cast<const TextSpan*>(base + header.comments_offset), header.comment_count },
+        { reinterpret_cast<const TextSpan*>(base + header.skipped_offset), header.skipped_count },
+    };
+    if (!ValidModel(model, header.source_size)) return false;
+    symbols.clear();
+    for (const auto& span : symbol_spans) {
+        if (size_t{ span.offset } + span.length > symbol_text.size()) return false;
+        symbols.push_back(SymbolTable::Global().Intern(Resolve(symbol_text, span)));
+    }
+    bool valid = true;
+    for (auto& attribute : attributes) {
+        ForEachSymbol(attribute, [&valid](SymbolId& symbol) {
+            if (symbol < symbols.size()) {
+                symbol = symbols[symbol];
+            } else {
+                valid = false;
+            }
+        });
+    }
+    if (!valid) return false;
+
+    // The model is copied to the window arena and the source to the window: nothing keeps the cache file mapped, so it
+    // can be replaced when its source changes (on Windows a mapped file cannot be).
+    SourceBuffer source;
+    source.Assign(std::string(cache.substr(header.source_offset, header.source_size)));
+    window.SetupFromModel(std::move(source), model);
+    return true;
+}
+
+// Writes the whole file at once (see WriteFileAtomically), readers never see a partial file.
+void WriteCache(const std::filesystem::path& cache_path, uint64_t path_hash, const FileKey& key, uint64_t content_hash, const Window& window) {
+    const auto& model = window.Model();
+    const auto source = window.Source();
+
+    // Symbol ids to indices in the symbols of the window.
+    std::vector<AttributeRecord> attributes(model.attributes.begin(), model.attributes.end());
+    std::unordered_map<SymbolId, uint32_t> indices;
+    std::vector<TextSpan> symbol_spans;
+    std::string symbol_text;
+    for (auto& attribute : attributes) {
+        ForEachSymbol(attribute, [&](SymbolId& symbol) {
+            const auto [it, added] = indices.try_emplace(symbol, static_cast<uint32_t>(symbol_spans.size()));
+            if (added) {
+                const auto name = SymbolTable::Global().Name(symbol);
+                symbol_spans.push_back({ static_cast<uint32_t>(symbol_text.size()), static_cast<uint32_t>(name.size()) });
+                symbol_text += name;
+            }
+            symbol = it->second;
+        });
+    }
+
+    CacheHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.element_record_size = sizeof(ElementRecord);
+    header.attribute_record_size = sizeof(AttributeRecord);
+    header.path_hash = path_hash;
+    header.source_size = source.size();
+    header.source_mtime = key.mtime;
+    header.content_hash = content_hash;
+    header.element_count = static_cast<uint32_t>(model.elements.size());
+    header.attribute_count = static_cast<uint32_t>(model.attributes.size());
+    header.comment_count = static_cast<uint32_t>(model.comments.size());
+    header.skipped_count = static_cast<uint32_t>(model.skipped.size());
+    header.symbol_count = static_cast<uint32_t>(symbol_spans.size());
+    header.elements_offset = AlignSection(sizeof(header));
+    header.attributes_offset = AlignSection(header.elements_offset + model.elements.size_bytes());
+    header.comments_offset = AlignSection(header.attributes_offset + model.attributes.size_bytes());
+    header.skipped_offset = AlignSection(header.comments_offset + model.comments.size_bytes());
+    header.source_offset = AlignSection(header.skipped_offset + model.skipped.size_bytes());
+    header.symbols_offset = AlignSection(header.source_offset + source.size());
+    header.symbol_text_offset = AlignSection(header.symbols_offset + symbol_spans.size() * sizeof(TextSpan));
+    header.symbol_text_size = symbol_text.size();
+
+    std::string bytes(header.symbol_text_offset + symbol_text.size(), '\0');
+    const auto copy = [&bytes](uint64_t offset, const void* data, size_t size) {
+        // Empty sections may have null data.
+        if (size > 0) std::memcpy(bytes.data() + offset, data, size);
+    };
+    copy(0, &header, sizeof(header));
+    copy(header.elements_offset, model.elements.data(), model.elements.size_bytes());
+    copy(header.attributes_offset, attributes.data(), attributes.size() * sizeof(AttributeRecord));
+    copy(header.comments_offset, model.comments.data(), model.comments.size_bytes());
+    copy(header.skipped_offset, model.skipped.data(), model.skipped.size_bytes());
+    copy(header.source_offset, source.data(), source.size());
+    copy(header.symbols_offset, symbol_spans.data(), symbol_spans.size() * sizeof(TextSpan));
+    copy(header.symbol_text_offset, symbol_text.data(), symbol_text.size());
+
+    std::error_code error;
+    std::filesystem::create_directories(cache_path.parent_path(), error);
+    // A cache which could not be written is parsed again next time.
+    WriteFileAtomically(cache_path, bytes);
+}
+
+}  // namespace
+
+ModelCache::ModelCache() : ModelCache(DefaultDirectory()) {}
+
+ModelCache::ModelCache(std::filesystem::path directory) : directory_(std::move(directory)) {}
+
+std::filesystem::path ModelCache::DefaultDirectory() {
+#ifdef _WIN32
+    const auto base = GetEnv("LOCALAPPDATA");
+    if (!base.empty()) return std::filesystem::path(base) / "Falcon4UIEditor" / "ScfCache";
+#else
+    if (const auto xdg = GetEnv("XDG_CACHE_HOME"); !xdg.empty()) return std::filesystem::path(xdg) / "falcon4-ui-editor" / "scf";
+    if (const auto home = GetEnv("HOME"); !home.empty()) return std::filesystem::path(home) / ".cache" / "falcon4-ui-editor" / "scf";
+#endif
+    std::error_code error;
+    return std::filesystem::temp_directory_path(error) / "falcon4-ui-editor-scf";
+}
+
+std::filesystem::path ModelCache::CachePathFor(const std::string& filename) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.scfc", static_cast<unsigned long long>(HashBytes(filename)));
+    return directory_ / name;
+}
+
+bool ModelCache::Load(const std::string& filename, Window& window) {
+    FALCON_UI_TRACE_SCOPE_DETAIL("ModelCache::Load", filename);
+    const auto key = StatFile(filename);
+    if (!key.has_value()) {
+        ++misses_;
+        window.SetupFromFile(filename);
+        return false;
+    }
+
+    const auto path_hash = HashBytes(filename);
+    const auto cache_path = CachePathFor(filename);
+    SourceBuffer cache;
+    std::optional<CacheHeader> header;
+    if (cache.Map(cache_path.string())) header = ReadHeader(cache.View(), path_hash);
+    if (header.has_value() && header->source_size == key->size && header->source_mtime == key->mtime && SetupFromCache(cache.View(), *header, window)) {
+        ++hits_;
+        FALCON_UI_TRACE_COUNTER("Model cache hits", hits_.load());
+        return true;
+    }
+
+    // The key changed (or there is no cache): the content hash tells if the file really changed.
+    SourceBuffer source;
+    if (!source.Read(filename)) {
+        ++misses_;
+        window.SetupFromFile(filename);
+        return false;
+    }
+    const auto content_hash = HashBytes(source.View());
+    const bool same_contents = header.has_value() && header->content_hash == content_hash && header->source_size == source.View().size() &&
+        SetupFromCache(cache.View(), *header, window);
+    if (same_contents) {
+        ++hits_;
+        FALCON_UI_TRACE_COUNTER("Model cache hits", hits_.load());
+    } else {
+        ++misses_;
+        FALCON_UI_TRACE_COUNTER("Model cache misses", misses_.load());
+        window.SetupFromSource(std::move(source));
+    }
+    // Unmapped before the new cache file is renamed over it.
+    cache = SourceBuffer();
+    // Only windows which parsed are cached, their setup may still fail (and will again when loaded from the cache).
+    if (!window.Model().elements.empty()) {
+        FALCON_UI_TRACE_SCOPE("ModelCache::WriteCache");
+        WriteCache(cache_path, path_hash, *key, content_hash, window);
+    }
+    return same_contents;
+}
+
+}  // namespace falcon_ui
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+
+#include "FalconWindow.h"
+
+
+namespace falcon_ui {
+
+// On disk cache of parsed windows. Each .scf has a cache file with its parsed model and a copy of its source, keyed by
+// the source path, size, modification time and content hash. A cache hit maps one file and copies the model arrays and
+// the source, there is no parsing. Loaded windows keep no cache file mapped, so a cache is refreshed while its window
+// is shown.
+// Load() can be called concurrently (for example from the bulk loader).
+class ModelCache {
+public:
+    // Cache in the user profile (see DefaultDirectory).
+    ModelCache();
+    explicit ModelCache(std::filesystem::path directory);
+
+    // %LOCALAPPDATA%\Falcon4UIEditor\ScfCache on Windows, $XDG_CACHE_HOME (or ~/.cache)/falcon4-ui-editor/scf elsewhere.
+    static std::filesystem::path DefaultDirectory();
+
+    // Sets up window from filename, using the cache if it is up to date. Otherwise parses the file and refreshes the cache.
+    // Returns true if the cache was used.
+    bool Load(const std::string& filename, Window& window);
+
+    uint64_t Hits() const { return hits_; }
+    uint64_t Misses() const { return misses_; }
+
+private:
+    std::filesystem::path CachePathFor(const std::string& filename) const;
+
+    std::filesystem::path directory_;
+    std::atomic<uint64_t> hits_{ 0 };
+    std::atomic<uint64_t> misses_{ 0 };
+};
+
+}  // namespace falcon_ui
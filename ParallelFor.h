@@ -0,0 +1,17 @@
+#pragma once
+
+#include "JobSystem.h"
+
+
+namespace falcon_ui {
+
+// Calls function(index, worker) for every index in [0, count), spread over thread_count threads: the calling one and
+// the workers of JobSystem::Get(), in the lane of the calling job (see JobSystem::ParallelFor). worker is below
+// thread_count and unique among the threads running the loop, for per thread scratch. The threads record spans named
+// name in traces.
+template <typename Function>
+void ParallelFor(size_t count, unsigned thread_count, const char* name, const Function& function) {
+    JobSystem::Get().ParallelFor(count, thread_count, JobSystem::CurrentPriority(), name, function);
+}
+
+}  // namespace falcon_ui
@@ -0,0 +1,165 @@
+#include "ResourceArchive.h"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+
+#include "Hash.h"
+#include "Header.h"
+#include "Tracing.h"
+
+
+namespace falcon_ui {
+
+namespace {
+
+// The layouts of the game files (C_Resmgr), little endian and packed.
+// Index file: the byte size of the headers which follow, the version, then one header per resource.
+// Resource file: the version, then the bytes the headers point to, by offset from the start of the file.
+constexpr size_t kIndexPreamble = 8;
+constexpr size_t kIdSize = 32;
+// Every header starts with the type and the id.
+constexpr size_t kIdOffset = 4;
+// Image: flags, center x and y, width and height (16 bit), image offset, palette size (in colors), palette offset.
+constexpr size_t kImageHeaderSize = 60;
+// Sound: flags, channels and sound type (16 bit), offset, header size.
+constexpr size_t kSoundHeaderSize = 52;
+// Flat: offset, size.
+constexpr size_t kFlatHeaderSize = 44;
+
+template <typename T>
+T ReadValue(std::string_view bytes, size_t offset) {
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+// The bytes [offset, offset + size) of file, or false if they are not all in it.
+bool Slice(std::string_view file, uint64_t offset, uint64_t size, std::string_view& slice) {
+    if (offset > file.size() || size > file.size() - offset) return false;
+    slice = file.substr(static_cast<size_t>(offset), static_cast<size_t>(size));
+    return true;
+}
+
+// The wave file at offset of file, sized from its RIFF header. Empty if there is none.
+std::string_view WaveAt(std::string_view file, uint32_t offset) {
+    if (offset > file.size() || file.size() - offset < 8 || file.substr(offset, 4) != "RIFF") return {};
+    std::string_view wave;
+    if (!Slice(file, offset, uint64_t{ 8 } + ReadValue<uint32_t>(file, offset + 4), wave)) return {};
+    return wave;
+}
+
+}  // namespace
+
+std::unique_ptr<ResourceArchive> ResourceArchive::Open(const std::string& idx_path) {
+    FALCON_UI_TRACE_SCOPE_DETAIL("ResourceArchive::Open", idx_path);
+    std::unique_ptr<ResourceArchive> archive(new ResourceArchive());
+    // The extension keeps the case of the index one, the files come in pairs (MAIN.IDX and MAIN.RSC).
+    auto rsc_path = std::filesystem::path(idx_path);
+    const auto extension = rsc_path.extension().string();
+    rsc_path.replace_extension(!extension.empty() && extension[1] == 'I' ? ".RSC" : ".rsc");
+    if (!archive->index_.Map(idx_path) || !archive->data_.Map(NativePath(rsc_path.string()))) return nullptr;
+    if (!archive->ReadIndex()) return nullptr;
+    return archive;
+}
+
+bool ResourceArchive::ReadIndex() {
+    const auto index = index_.View();
+    const auto data = data_.View();
+    if (index.size() < kIndexPreamble || data.size() < sizeof(uint32_t)) return false;
+    const auto headers_size = ReadValue<uint32_t>(index, 0);
+    version_ = ReadValue<uint32_t>(index, 4);
+    if (headers_size > index.size() - kIndexPreamble || ReadValue<uint32_t>(data, 0) != version_) return false;
+
+    // One pass over the headers, checking every resource is within the resource file.
+    const auto headers = index.substr(kIndexPreamble, headers_size);
+    for (size_t offset = 0; offset < headers.size();) {
+        if (headers.size() - offset < kIdOffset + kIdSize) return false;
+        Resource resource{};
+        resource.type = static_cast<ResourceType>(ReadValue<uint32_t>(headers, offset));
+        const auto id = headers.substr(offset + kIdOffset, kIdSize);
+        resource.id = id.substr(0, std::min(id.find('\0'), id.size()));
+        size_t header_size = 0;
+        switch (resource.type) {
+            case ResourceType::IMAGE: {
+                header_size = kImageHeaderSize;
+                if (headers.size() - offset < header_size) return false;
+                resource.flags = ReadValue<uint32_t>(headers, offset + 36);
+                resource.center_x = ReadValue<int16_t>(headers, offset + 40);
+                resource.center_y = ReadValue<int16_t>(headers, offset + 42);
+                resource.width = ReadValue<int16_t>(headers, offset + 44);
+                resource.height = ReadValue<int16_t>(headers, offset + 46);
+                if (resource.width < 0 || resource.height < 0) return false;
+                const uint64_t pixel_size = resource.flags & kResourceImage16Bit ? 2 : 1;
+                const uint64_t pixels = uint64_t{ static_cast<uint16_t>(resource.width) } * static_cast<uint16_t>(resource.height);
+                if (!Slice(data, ReadValue<uint32_t>(headers, offset + 48), pixels * pixel_size, resource.data)) return false;
+                const uint64_t palette_colors = ReadValue<uint32_t>(headers, offset + 52);
+                if (!Slice(data, ReadValue<uint32_t>(headers, offset + 56), palette_colors * sizeof(uint16_t), resource.palette)) return false;
+                break;
+            }
+            case ResourceType::SOUND:
+                header_size = kSoundHeaderSize;
+                if (headers.size() - offset < header_size) return false;
+                resource.flags = ReadValue<uint32_t>(headers, offset + 36);
+                resource.channels = ReadValue<int16_t>(headers, offset + 40);
+                resource.sound_type = ReadValue<int16_t>(headers, offset + 42);
+                resource.data = WaveAt(data, ReadValue<uint32_t>(headers, offset + 44));
+                break;
+            case ResourceType::FLAT:
+                header_size = kFlatHeaderSize;
+                if (headers.size() - offset < header_size) return false;
+                if (!Slice(data, ReadValue<uint32_t>(headers, offset + 36), ReadValue<uint32_t>(headers, offset + 40), resource.data)) return false;
+                break;
+            default:
+                return false;
+        }
+        resources_.push_back(resource);
+        offset += header_size;
+    }
+
+    table_.assign(std::bit_ceil(std::max<size_t>(resources_.size() * 2, 8)), 0);
+    const size_t mask = table_.size() - 1;
+    for (uint32_t i = 0; i < resources_.size(); ++i) {
+        const auto id = resources_[i].id;
+        for (size_t slot = HashBytes(id) & mask;; slot = (slot + 1) & mask) {
+            if (table_[slot] == 0) {
+                table_[slot] = i + 1;
+                break;
+            }
+            if (resources_[table_[slot] - 1].id == id) break;
+        }
+    }
+    return true;
+}
+
+const Resource* ResourceArchive::Find(std::string_view id) const {
+    if (resources_.empty()) return nullptr;
+    const size_t mask = table_.size() - 1;
+    for (size_t slot = HashBytes(id) & mask; table_[slot] != 0; slot = (slot + 1) & mask) {
+        const auto& resource = resources_[table_[slot] - 1];
+        if (resource.id == id) return &resource;
+    }
+    return nullptr;
+}
+
+std::vector<std::shared_ptr<const ResourceArchive>> OpenResourceArchives(const std::string& directory) {
+    FALCON_UI_TRACE_SCOPE_DETAIL("OpenResourceArchives", directory);
+    std::vector<std::string> paths;
+    std::error_code error;
+    for (auto it = std::filesystem::recursive_directory_iterator(directory, error); !error && it != std::filesystem::recursive_directory_iterator();
+         it.increment(error)) {
+        auto extension = it->path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if (extension == ".idx" && it->is_regular_file(error)) paths.push_back(it->path().string());
+    }
+    std::sort(paths.begin(), paths.end());
+    std::vector<std::shared_ptr<const ResourceArchive>> archives;
+    for (const auto& path : paths) {
+        if (auto archive = ResourceArchive::Open(path); archive != nullptr) archives.push_back(std::move(archive));
+    }
+    return archives;
+}
+
+}  // namespace falcon_ui
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ScfTokenizer.h"
+
+
+namespace falcon_ui {
+
+// The kinds of resources, with their values in the index files.
+enum class ResourceType : uint32_t {
+    IMAGE = 100,
+    SOUND = 101,
+    FLAT = 102,
+};
+
+// Flags of the image resources.
+inline constexpr uint32_t kResourceImage8Bit = 0x00000001;
+inline constexpr uint32_t kResourceImage16Bit = 0x00000002;
+inline constexpr uint32_t kResourceImageColorKey = 0x40000000;
+
+// One resource of an archive. The views point inside the mapped files and live as long as the archive.
+struct Resource {
+    ResourceType type;
+    std::string_view id;
+    // Images: the pixels, palette indices (kResourceImage8Bit) or 16 bit colors, row by row. Sounds: the wave file,
+    // empty if it has no RIFF header to give its size. Flats: the bytes.
+    std::string_view data;
+    // 8 bit images: the 16 bit colors of the palette.
+    std::string_view palette;
+    uint32_t flags;
+    // Images.
+    int16_t center_x;
+    int16_t center_y;
+    int16_t width;
+    int16_t height;
+    // Sounds.
+    int16_t channels;
+    int16_t sound_type;
+};
+
+// A Falcon resource archive, read-only: the index file (.idx) lists the resources the resource file (.rsc) next to it
+// holds. Both are memory mapped, the resources are views of the mappings, nothing is copied.
+// Opening reads the index once to check it and build a hash table of the ids, a lookup is a hash and a probe or two.
+// Can be used from several threads.
+class ResourceArchive {
+public:
+    // Maps idx_path and the .rsc file of the same name. Returns nullptr if a file cannot be mapped or the index does
+    // not match the resource file (unknown resource type, resource out of the file, different versions).
+    static std::unique_ptr<ResourceArchive> Open(const std::string& idx_path);
+
+    // nullptr if there is no resource id. The first one wins if the index lists id twice.
+    const Resource* Find(std::string_view id) const;
+
+    // In index order.
+    std::span<const Resource> Resources() const { return resources_; }
+    uint32_t Version() const { return version_; }
+
+private:
+    ResourceArchive() = default;
+    bool ReadIndex();
+
+    SourceBuffer index_;
+    SourceBuffer data_;
+    uint32_t version_ = 0;
+    std::vector<Resource> resources_;
+    // Open addressing, linear probing: index in resources_ plus 1, 0 for empty slots. Its size is a power of 2, at least
+    // twice the resource count so probes stay short.
+    std::vector<uint32_t> table_;
+};
+
+// The archives of directory and its sub folders, in path order. The index files which fail to open are skipped.
+std::vector<std::shared_ptr<const ResourceArchive>> OpenResourceArchives(const std::string& directory);
+
+}  // namespace falcon_ui
@@ -0,0 +1,209 @@
+#include "ScfRecords.h"
+
+#include <charconv>
+
+#include "Hash.h"
+
+
+namespace falcon_ui {
+
+namespace {
+
+// Enough for any int32_t and its separator.
+constexpr size_t kMaxNumberSize = 12;
+
+void AppendNumber(int32_t number, std::string& out) {
+    char buffer[kMaxNumberSize];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    out.push_back(' ');
+    out.append(buffer, result.ptr);
+}
+
+void AppendText(std::string_view source, TextSpan span, std::string& out) {
+    if (span.empty()) return;
+    out.push_back(' ');
+    out.append(Resolve(source, span));
+}
+
+void AppendSymbol(SymbolId symbol, std::string& out) {
+    if (symbol == kNoSymbol) return;
+    out.push_back(' ');
+    out.append(SymbolTable::Global().Name(symbol));
+}
+
+size_t SymbolSize(SymbolId symbol) {
+    return SymbolTable::Global().Name(symbol).size();
+}
+
+// Span from the start of args[first] to the end of args[last].
+TextSpan ArgsSpan(const TagLine& line, int first, int last, std::string_view source) {
+    const auto begin = line.args[first].text.data();
+    const auto end = line.args[last].text.data() + line.args[last].text.size();
+    return MakeSpan(source, std::string_view(begin, end - begin));
+}
+
+uint64_t CombineNumber(uint64_t hash, int32_t number) {
+    return CombineHash(hash, static_cast<uint32_t>(number));
+}
+
+}  // namespace
+
+std::optional<AttributeRecord> DecodeAttribute(std::string_view line, std::string_view source) {
+    const auto tag_line = ParseTagLine(line);
+    if (!tag_line.has_value()) return std::nullopt;
+    const auto& args = tag_line->args;
+    const int count = tag_line->arg_count;
+    auto& symbols = SymbolTable::Global();
+
+    AttributeRecord record;
+    record.tag = tag_line->spec->tag;
+    switch (tag_line->spec->record) {
+        case RecordKind::SETUP: {
+            auto& setup = record.setup;
+            setup.label = symbols.Intern(args[0].text);
+            setup.ctype = symbols.Intern(args[1].text);
+            int i = 2;
+            for (; i < count && args[i].type == ArgType::INT && setup.int_count < SetupRecord::kMaxInts; ++i) {
+                setup.ints[setup.int_count++] = args[i].number;
+            }
+            if (i < count) setup.resource = ArgsSpan(*tag_line, i, count - 1, source);
+            break;
+        }
+        case RecordKind::XY:
+            record.xy = { args[0].number, args[1].number };
+            break;
+        case RecordKind::XYWH:
+            record.xywh = { args[0].number, args[1].number, args[2].number, args[3].number };
+            break;
+        case RecordKind::RANGES:
+            record.ranges.count = static_cast<uint8_t>(count);
+            for (int i = 0; i < count; ++i) record.ranges.values[i] = args[i].number;
+            break;
+        case RecordKind::VALUE:
+            record.value.value = args[0].number;
+            break;
+        case RecordKind::TEXT:
+            record.text.text = ArgsSpan(*tag_line, 0, count - 1, source);
+            break;
+        case RecordKind::STATE:
+            record.state = { symbols.Intern(args[0].text), symbols.Intern(args[1].text) };
+            break;
+        case RecordKind::NONE:
+            return std::nullopt;
+    }
+    return record;
+}
+
+void EncodeAttribute(const AttributeRecord& record, std::string_view source, std::string& out) {
+    const auto* spec = SpecForTag(record.tag);
+    if (spec == nullptr) return;
+    out.append(spec->name);
+    switch (spec->record) {
+        case RecordKind::SETUP:
+            AppendSymbol(record.setup.label, out);
+            AppendSymbol(record.setup.ctype, out);
+            for (int i = 0; i < record.setup.int_count; ++i) AppendNumber(record.setup.ints[i], out);
+            AppendText(source, record.setup.resource, out);
+            break;
+        case RecordKind::XY:
+            AppendNumber(record.xy.x, out);
+            AppendNumber(record.xy.y, out);
+            break;
+        case RecordKind::XYWH:
+            AppendNumber(record.xywh.x, out);
+            AppendNumber(record.xywh.y, out);
+            AppendNumber(record.xywh.w, out);
+            AppendNumber(record.xywh.h, out);
+            break;
+        case RecordKind::RANGES:
+            for (int i = 0; i < record.ranges.count; ++i) AppendNumber(record.ranges.values[i], out);
+            break;
+        case RecordKind::VALUE:
+            AppendNumber(record.value.value, out);
+            break;
+        case RecordKind::TEXT:
+            AppendText(source, record.text.text, out);
+            break;
+        case RecordKind::STATE:
+            AppendSymbol(record.state.state, out);
+            AppendSymbol(record.state.resource, out);
+            break;
+        case RecordKind::NONE:
+            break;
+    }
+}
+
+size_t EncodedAttributeSizeBound(const AttributeRecord& record) {
+    const auto* spec = SpecForTag(record.tag);
+    if (spec == nullptr) return 0;
+    // Spans and numbers, each with its separator.
+    const size_t size = spec->name.size();
+    switch (spec->record) {
+        case RecordKind::SETUP:
+            return size + 3 + SymbolSize(record.setup.label) + SymbolSize(record.setup.ctype) + record.setup.resource.length + SetupRecord::kMaxInts * kMaxNumberSize;
+        case RecordKind::XY:
+        case RecordKind::XYWH:
+        case RecordKind::RANGES:
+        case RecordKind::VALUE:
+            return size + RangesRecord::kMaxValues * kMaxNumberSize;
+        case RecordKind::TEXT:
+            return size + 1 + record.text.text.length;
+        case RecordKind::STATE:
+            return size + 2 + SymbolSize(record.state.state) + SymbolSize(record.state.resource);
+        case RecordKind::NONE:
+            break;
+    }
+    return size;
+}
+
+uint64_t HashAttribute(const AttributeRecord& record, std::string_view source) {
+    const auto& symbols = SymbolTable::Global();
+    uint64_t hash = MixHash(static_cast<uint64_t>(record.tag) + 1);
+    const auto* spec = SpecForTag(record.tag);
+    if (spec == nullptr) return hash;
+    switch (spec->record) {
+        case RecordKind::SETUP:
+            hash = CombineHash(hash, symbols.Hash(record.setup.label));
+            hash = CombineHash(hash, symbols.Hash(record.setup.ctype));
+            hash = CombineNumber(hash, record.setup.int_count);
+            for (int i = 0; i < record.setup.int_count; ++i) hash = CombineNumber(hash, record.setup.ints[i]);
+            return CombineHash(hash, HashBytes(Resolve(source, record.setup.resource)));
+        case RecordKind::XY:
+            return CombineNumber(CombineNumber(hash, record.xy.x), record.xy.y);
+        case RecordKind::XYWH:
+            hash = CombineNumber(CombineNumber(hash, record.xywh.x), record.xywh.y);
+            return CombineNumber(CombineNumber(hash, record.xywh.w), record.xywh.h);
+        case RecordKind::RANGES:
+            hash = CombineNumber(hash, record.ranges.count);
+            for (int i = 0; i < record.ranges.count; ++i) hash = CombineNumber(hash, record.ranges.values[i]);
+            return hash;
+        case RecordKind::VALUE:
+            return CombineNumber(hash, record.value.value);
+        case RecordKind::TEXT:
+            return CombineHash(hash, HashBytes(Resolve(source, record.text.text)));
+        case RecordKind::STATE:
+            return CombineHash(CombineHash(hash, symbols.Hash(record.state.state)), symbols.Hash(record.state.resource));
+        case RecordKind::NONE:
+            break;
+    }
+    return hash;
+}
+
+uint64_t HashElement(Tag tag, std::span<const AttributeRecord> attributes, std::string_view source) {
+    uint64_t hash = CombineHash(static_cast<uint64_t>(tag), attributes.size());
+    for (const auto& attribute : attributes) hash = CombineHash(hash, HashAttribute(attribute, source));
+    return hash;
+}
+
+void HashElements(std::span<ElementRecord> elements, std::span<const AttributeRecord> attributes, std::string_view source) {
+    for (auto& element : elements) {
+        element.hash = HashElement(element.tag, attributes.subspan(element.first_attribute, element.attribute_count), source);
+    }
+    // The children are leaves, only the root has a subtree to fold in.
+    if (elements.empty()) return;
+    auto& root = elements.front();
+    root.hash = CombineHash(root.hash, elements.size() - 1);
+    for (const auto& child : elements.subspan(1)) root.hash = CombineHash(root.hash, child.hash);
+}
+
+}  // namespace falcon_ui
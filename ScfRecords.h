@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "ScfSchema.h"
+#include "SymbolTable.h"
+
+
+namespace falcon_ui {
+
+// A piece of text inside the window source. Offsets instead of pointers keep the model relocatable.
+// Records are PODs so they can live in unions, value initialize them ({}) to get empty spans.
+struct TextSpan {
+    uint32_t offset;
+    uint32_t length;
+
+    bool empty() const { return length == 0; }
+};
+
+inline std::string_view Resolve(std::string_view source, TextSpan span) {
+    return source.substr(span.offset, span.length);
+}
+
+// The span of text, which must point inside source.
+inline TextSpan MakeSpan(std::string_view source, std::string_view text) {
+    return { static_cast<uint32_t>(text.data() - source.data()), static_cast<uint32_t>(text.size()) };
+}
+
+// [SETUP] <label> <control type> <ints...> <resource...>
+// Windows have width and height as ints, the other controls x and y (plus w and h for some).
+struct SetupRecord {
+    static constexpr int kMaxInts = 4;
+
+    // Interned in SymbolTable::Global(), like all single symbols of the records.
+    SymbolId label;
+    SymbolId ctype;
+    int32_t ints[kMaxInts];
+    uint8_t int_count;
+    // Whatever follows the leading integers, usually a resource id.
+    TextSpan resource;
+};
+
+// [XY] <x> <y>
+struct XYRecord {
+    int32_t x;
+    int32_t y;
+};
+
+// [XYWH] <x> <y> <w> <h>
+struct XYWHRecord {
+    int32_t x;
+    int32_t y;
+    int32_t w;
+    int32_t h;
+};
+
+// [RANGES] <ints...>
+struct RangesRecord {
+    // The schema rejects longer lines.
+    static constexpr int kMaxValues = kMaxRangesValues;
+
+    int32_t values[kMaxValues];
+    uint8_t count;
+};
+
+// [GROUP] <value>, [DEPTH] <value>
+struct ValueRecord {
+    int32_t value;
+};
+
+// [FLAGBITON], [CURSOR], [BITMAP] and [TILE] attributes: all the arguments as a single text.
+struct TextRecord {
+    TextSpan text;
+};
+
+// [BUTTONIMAGE], [BUTTONTEXT], [SOUNDBITE]: <state> <resource>
+struct StateRecord {
+    SymbolId state;
+    SymbolId resource;
+};
+
+// One decoded attribute line. The tag tells which member of the union is in use (see TagSpec::record).
+struct AttributeRecord {
+    Tag tag = Tag::UNKNOWN;
+    // 1 based line of the attribute in the window source, 0 for attributes added by editors.
+    uint32_t line = 0;
+    union {
+        SetupRecord setup{};
+        XYRecord xy;
+        XYWHRecord xywh;
+        RangesRecord ranges;
+        ValueRecord value;
+        TextRecord text;
+        StateRecord state;
+    };
+};
+
+static_assert(std::is_trivially_copyable_v<AttributeRecord> && std::is_trivially_destructible_v<AttributeRecord>);
+
+// One element of a window: its tag, its ranges of the window attribute and comment arrays and its bytes of the source.
+struct ElementRecord {
+    Tag tag;
+    // Set by editors when they change the element, which is then written from its records (see ScfWriter.h).
+    bool edited;
+    uint32_t first_attribute;
+    uint32_t attribute_count;
+    uint32_t first_comment;
+    uint32_t comment_count;
+    // The element lines with its comments, spacing and line endings, up to the next element. Empty for new elements.
+    TextSpan source;
+    // Merkle hash of the element subtree: its tag and attributes (see HashAttribute) and, for the root, the hashes of
+    // all its children. Comments and formatting are not part of it, so equal hashes mean the same structure.
+    // Editors must recompute it (see HashElements) along with setting edited.
+    uint64_t hash;
+};
+
+// The parsed form of a window as flat arrays of PODs. Nothing points outside these arrays, text is referenced by spans
+// of the window source, so a model can be copied byte by byte (see ModelCache).
+// The first element is the root window, all others are its children.
+struct WindowModel {
+    std::span<const ElementRecord> elements;
+    std::span<const AttributeRecord> attributes;
+    std::span<const TextSpan> comments;
+    // Attribute lines with a known tag and arguments which do not validate. They are left out of their element, the
+    // rest of the window loads, and the validator reports them.
+    std::span<const TextSpan> skipped;
+};
+
+// Calls function(SymbolId&) for each symbol of record (which may be kNoSymbol), to remap them.
+template <typename Function>
+void ForEachSymbol(AttributeRecord& record, const Function& function) {
+    const auto* spec = SpecForTag(record.tag);
+    if (spec == nullptr) return;
+    if (spec->record == RecordKind::SETUP) {
+        function(record.setup.label);
+        function(record.setup.ctype);
+    } else if (spec->record == RecordKind::STATE) {
+        function(record.state.state);
+        function(record.state.resource);
+    }
+}
+
+// Calls function(const TextSpan&) for each span of record in the window source.
+template <typename Function>
+void ForEachSpan(const AttributeRecord& record, const Function& function) {
+    const auto* spec = SpecForTag(record.tag);
+    if (spec == nullptr) return;
+    if (spec->record == RecordKind::SETUP) {
+        function(record.setup.resource);
+    } else if (spec->record == RecordKind::TEXT) {
+        function(record.text.text);
+    }
+}
+
+// Decodes an attribute line into its record. Spans are relative to source, which must contain line. Symbols are
+// interned in SymbolTable::Global().
+// Returns nullopt if the line does not validate against the schema or does not fit its record.
+std::optional<AttributeRecord> DecodeAttribute(std::string_view line, std::string_view source);
+
+// Appends the canonical line of record ("[XY] 10 20", no line ending) to out, the reverse of DecodeAttribute.
+void EncodeAttribute(const AttributeRecord& record, std::string_view source, std::string& out);
+// Upper bound of the size EncodeAttribute appends.
+size_t EncodedAttributeSizeBound(const AttributeRecord& record);
+
+// Hash of the content of record: its tag, numbers, symbols and text. Stable across runs, symbols are hashed by text.
+uint64_t HashAttribute(const AttributeRecord& record, std::string_view source);
+
+// Hash of an element from its tag and attributes, without its children.
+uint64_t HashElement(Tag tag, std::span<const AttributeRecord> attributes, std::string_view source);
+
+// Sets the hash of every element of elements, the first one being the root of all the others.
+void HashElements(std::span<ElementRecord> elements, std::span<const AttributeRecord> attributes, std::string_view source);
+
+}  // namespace falcon_ui
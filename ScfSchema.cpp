@@ -0,0 +1,83 @@
+#include "ScfSchema.h"
+
+#include <charconv>
+
+#include "ScfTokenizer.h"
+
+
+namespace falcon_ui {
+
+namespace {
+
+bool IsSymbolChar(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+// Decodes text into arg, telling apart numbers from symbols.
+bool DecodeArg(std::string_view text, TagArg& arg) {
+    arg.text = text;
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), arg.number);
+    if (result.ec == std::errc() && result.ptr == text.data() + text.size()) {
+        arg.type = ArgType::INT;
+        return true;
+    }
+    arg.number = 0;
+    for (char c : text) {
+        if (!IsSymbolChar(c)) return false;
+    }
+    arg.type = ArgType::SYMBOL;
+    return true;
+}
+
+bool Matches(ArgType expected, ArgType actual) {
+    return expected == ArgType::ANY || expected == actual;
+}
+
+}  // namespace
+
+std::optional<TagLine> ParseTagLine(std::string_view line) {
+    const auto tag = Tokenizer::Tag(line);
+    TagLine tag_line;
+    tag_line.spec = FindTag(tag);
+    if (tag_line.spec == nullptr || !tag_line.spec->is_attribute) return std::nullopt;
+
+    auto rest = line.substr(tag.size());
+    for (auto token = Tokenizer::NextToken(rest); !token.empty(); token = Tokenizer::NextToken(rest)) {
+        if (tag_line.arg_count == kMaxTagArgs) return std::nullopt;
+        if (!DecodeArg(token, tag_line.args[tag_line.arg_count])) return std::nullopt;
+        ++tag_line.arg_count;
+    }
+    if (!ValidateTagLine(tag_line)) return std::nullopt;
+    return tag_line;
+}
+
+bool ValidateTagLine(const TagLine& line) {
+    if (line.spec == nullptr) return false;
+    const auto& spec = *line.spec;
+    if (line.arg_count < spec.required_args) return false;
+    if (line.arg_count > spec.required_args && spec.rest == ArgType::NONE) return false;
+    if (line.arg_count > spec.max_args) return false;
+    for (int i = 0; i < line.arg_count; ++i) {
+        const auto expected = i < spec.required_args ? spec.args[i] : spec.rest;
+        if (!Matches(expected, line.args[i].type)) return false;
+    }
+    return true;
+}
+
+void WriteTagLine(const TagLine& line, std::string& out) {
+    if (line.spec == nullptr) return;
+    out.append(line.spec->name);
+    char number[16];
+    for (int i = 0; i < line.arg_count; ++i) {
+        const auto& arg = line.args[i];
+        out.push_back(' ');
+        if (arg.type == ArgType::INT) {
+            const auto result = std::to_chars(number, number + sizeof(number), arg.number);
+            out.append(number, result.ptr);
+        } else {
+            out.append(arg.text);
+        }
+    }
+}
+
+}  // namespace falcon_ui
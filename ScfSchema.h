@@ -0,0 +1,222 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+
+namespace falcon_ui {
+
+// Every tag known by the .scf format.
+enum class Tag : uint8_t {
+    UNKNOWN,
+    // Tags which start elements.
+    WINDOW,
+    BITMAP,
+    TILE,
+    BUTTON,
+    // Attribute tags.
+    SETUP,
+    XY,
+    XYWH,
+    RANGES,
+    GROUP,
+    FLAGBITON,
+    DEPTH,
+    BUTTONIMAGE,
+    BUTTONTEXT,
+    SOUNDBITE,
+    CURSOR,
+};
+
+enum class ArgType : uint8_t {
+    NONE,
+    INT,     // 1024, -12.
+    SYMBOL,  // C_TYPE_NORMAL, UI_MAIN_SCREEN.
+    ANY,     // Either of the above (resource ids can be both).
+};
+
+// Which POD record (see ScfRecords.h) an attribute is decoded into.
+enum class RecordKind : uint8_t {
+    NONE,
+    SETUP,   // SetupRecord.
+    XY,      // XYRecord.
+    XYWH,    // XYWHRecord.
+    RANGES,  // RangesRecord.
+    VALUE,   // ValueRecord.
+    TEXT,    // TextRecord.
+    STATE,   // StateRecord.
+};
+
+constexpr int kMaxTagArgs = 12;
+// The values a [RANGES] line may have, the size of RangesRecord.
+constexpr int kMaxRangesValues = 8;
+
+// Describes one tag and its arguments: the required ones and the type of the optional trailing ones.
+struct TagSpec {
+    Tag tag = Tag::UNKNOWN;
+    std::string_view name;
+    // A line with only the tag starts a new element.
+    bool starts_element = false;
+    // The tag may appear, with arguments, inside an element.
+    bool is_attribute = false;
+    std::array<ArgType, kMaxTagArgs> args{};
+    uint8_t required_args = 0;
+    ArgType rest = ArgType::NONE;
+    RecordKind record = RecordKind::NONE;
+    // Arguments past this many do not fit the record.
+    uint8_t max_args = kMaxTagArgs;
+};
+
+namespace schema_internal {
+
+constexpr TagSpec Element(Tag tag, std::string_view name) {
+    return TagSpec{ tag, name, true, false, {}, 0, ArgType::NONE, RecordKind::NONE };
+}
+
+template <typename... Args>
+constexpr TagSpec Attribute(Tag tag, std::string_view name, RecordKind record, ArgType rest, Args... args) {
+    static_assert(sizeof...(Args) <= kMaxTagArgs, "Too many arguments");
+    return TagSpec{ tag, name, false, true, { args... }, static_cast<uint8_t>(sizeof...(Args)), rest, record };
+}
+
+template <typename... Args>
+constexpr TagSpec ElementAndAttribute(Tag tag, std::string_view name, RecordKind record, ArgType rest, Args... args) {
+    auto spec = Attribute(tag, name, record, rest, args...);
+    spec.starts_element = true;
+    return spec;
+}
+
+constexpr TagSpec WithMaxArgs(TagSpec spec, int max_args) {
+    spec.max_args = static_cast<uint8_t>(max_args);
+    return spec;
+}
+
+using enum ArgType;
+using R = RecordKind;
+
+// The .scf schema. Adding a tag is adding an entry to Tag and a line here.
+// Attributes list the record they decode into and the type of optional trailing arguments first, then the required ones.
+constexpr std::array kTagSchema = {
+    Element(Tag::WINDOW, "[WINDOW]"),
+    Element(Tag::BUTTON, "[BUTTON]"),
+    // On their own they start elements, with the resource they are attributes of another element.
+    ElementAndAttribute(Tag::BITMAP, "[BITMAP]", R::TEXT, ANY, ANY),
+    ElementAndAttribute(Tag::TILE, "[TILE]", R::TEXT, ANY, ANY),
+    // <label> <control type> <type dependent values...>
+    Attribute(Tag::SETUP, "[SETUP]", R::SETUP, ANY, ANY, SYMBOL),
+    Attribute(Tag::XY, "[XY]", R::XY, NONE, INT, INT),
+    Attribute(Tag::XYWH, "[XYWH]", R::XYWH, NONE, INT, INT, INT, INT),
+    WithMaxArgs(Attribute(Tag::RANGES, "[RANGES]", R::RANGES, INT, INT, INT, INT, INT), kMaxRangesValues),
+    Attribute(Tag::GROUP, "[GROUP]", R::VALUE, NONE, INT),
+    Attribute(Tag::FLAGBITON, "[FLAGBITON]", R::TEXT, SYMBOL, SYMBOL),
+    Attribute(Tag::DEPTH, "[DEPTH]", R::VALUE, NONE, INT),
+    // <state> <resource>
+    Attribute(Tag::BUTTONIMAGE, "[BUTTONIMAGE]", R::STATE, NONE, SYMBOL, ANY),
+    Attribute(Tag::BUTTONTEXT, "[BUTTONTEXT]", R::STATE, NONE, SYMBOL, ANY),
+    Attribute(Tag::SOUNDBITE, "[SOUNDBITE]", R::STATE, NONE, SYMBOL, ANY),
+    Attribute(Tag::CURSOR, "[CURSOR]", R::TEXT, NONE, ANY),
+};
+
+}  // namespace schema_internal
+
+inline constexpr const auto& kTagSchema = schema_internal::kTagSchema;
+
+//-------------------------------------------------
+// Perfect hash recognizer, generated from the schema.
+//-------------------------------------------------
+namespace schema_internal {
+
+constexpr int kHashBits = 6;
+constexpr size_t kHashSize = size_t{ 1 } << kHashBits;
+
+// Only looks at the length and two characters, so it costs a few instructions. Assumes tag.size() >= 3.
+constexpr uint32_t HashTag(std::string_view tag, uint32_t seed) {
+    const uint32_t key = static_cast<uint32_t>(tag.size()) | (static_cast<uint8_t>(tag[1]) << 8) | (static_cast<uint8_t>(tag[tag.size() - 2]) << 16);
+    return ((key ^ seed) * 2654435761u) >> (32 - kHashBits);
+}
+
+constexpr bool IsPerfectSeed(uint32_t seed) {
+    std::array<bool, kHashSize> used{};
+    for (const auto& spec : kTagSchema) {
+        const auto slot = HashTag(spec.name, seed);
+        if (used[slot]) return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr uint32_t FindPerfectSeed() {
+    for (uint32_t seed = 0; seed < 100000; ++seed) {
+        if (IsPerfectSeed(seed)) return seed;
+    }
+    return ~0u;
+}
+
+constexpr uint32_t kPerfectSeed = FindPerfectSeed();
+static_assert(kPerfectSeed != ~0u, "No perfect hash for the tag schema, increase kHashBits");
+
+// Slot -> index in kTagSchema (or -1).
+constexpr std::array<int8_t, kHashSize> BuildHashTable() {
+    std::array<int8_t, kHashSize> table{};
+    for (auto& slot : table) slot = -1;
+    for (size_t i = 0; i < kTagSchema.size(); ++i) {
+        table[HashTag(kTagSchema[i].name, kPerfectSeed)] = static_cast<int8_t>(i);
+    }
+    return table;
+}
+
+constexpr auto kHashTable = BuildHashTable();
+
+}  // namespace schema_internal
+
+// Returns the spec for tag ("[XY]", brackets included) or nullptr if it is not part of the schema.
+constexpr const TagSpec* FindTag(std::string_view tag) {
+    if (tag.size() < 3) return nullptr;
+    const auto index = schema_internal::kHashTable[schema_internal::HashTag(tag, schema_internal::kPerfectSeed)];
+    if (index < 0 || kTagSchema[index].name != tag) return nullptr;
+    return &kTagSchema[index];
+}
+
+static_assert(FindTag("[XYWH]") != nullptr && FindTag("[XYWH]")->tag == Tag::XYWH);
+static_assert(FindTag("[XYWHX]") == nullptr);
+
+// Returns the spec of tag or nullptr for Tag::UNKNOWN.
+constexpr const TagSpec* SpecForTag(Tag tag) {
+    for (const auto& spec : kTagSchema) {
+        if (spec.tag == tag) return &spec;
+    }
+    return nullptr;
+}
+
+//---------------------------------
+// Parser, validator and writer.
+//---------------------------------
+
+// One argument of a tag line. Type is what the argument turned out to be (INT or SYMBOL), and numbers are decoded.
+struct TagArg {
+    std::string_view text;
+    ArgType type = ArgType::NONE;
+    int32_t number = 0;
+};
+
+// A tag line split in its arguments. Views point inside the parsed line.
+struct TagLine {
+    const TagSpec* spec = nullptr;
+    std::array<TagArg, kMaxTagArgs> args{};
+    uint8_t arg_count = 0;
+};
+
+// Parses and validates an attribute line ("[XY] 10 20") against the schema.
+// Returns nullopt for unknown tags, tags that cannot be attributes or arguments not matching the schema.
+std::optional<TagLine> ParseTagLine(std::string_view line);
+
+// Returns true if the arguments of line are valid for its tag.
+bool ValidateTagLine(const TagLine& line);
+
+// Appends the canonical text of line (no trailing newline) to out.
+void WriteTagLine(const TagLine& line, std::string& out);
+
+}  // namespace falcon_ui
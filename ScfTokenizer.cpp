@@ -0,0 +1,227 @@
+#include "ScfTokenizer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define VC_EXTRALEAN
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace falcon_ui {
+
+namespace {
+
+constexpr std::string_view kSeparators = " \t\n\r\f\v";
+
+}  // namespace
+
+//--------------
+// SourceBuffer
+//--------------
+
+SourceBuffer& SourceBuffer::operator=(SourceBuffer&& other) noexcept {
+    if (this == &other) return *this;
+    Reset();
+    // Owned contents may move (small string optimization), keep the offset of a narrowed view.
+    const bool owned = other.data_ != nullptr && other.mapping_ == nullptr;
+    const auto owned_offset = owned ? other.data_ - other.owned_.data() : 0;
+    owned_ = std::move(other.owned_);
+    data_ = owned ? owned_.data() + owned_offset : other.data_;
+    size_ = other.size_;
+    mapping_ = other.mapping_;
+    mapping_size_ = other.mapping_size_;
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.mapping_ = nullptr;
+    other.mapping_size_ = 0;
+    return *this;
+}
+
+void SourceBuffer::Reset() {
+    if (mapping_ != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(mapping_);
+#else
+        munmap(mapping_, mapping_size_);
+#endif
+    }
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+    data_ = nullptr;
+    size_ = 0;
+    owned_.clear();
+}
+
+bool SourceBuffer::Narrow(size_t offset, size_t size) {
+    if (offset > size_ || size > size_ - offset) return false;
+    data_ += offset;
+    size_ = size;
+    return true;
+}
+
+void SourceBuffer::Assign(std::string contents) {
+    Reset();
+    owned_ = std::move(contents);
+    data_ = owned_.data();
+    size_ = owned_.size();
+}
+
+bool SourceBuffer::Map(const std::string& filename) {
+    Reset();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        return false;
+    }
+    if (file_size.QuadPart == 0) {
+        // Empty files cannot be mapped, but they are valid (and empty) buffers.
+        CloseHandle(file);
+        return true;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) return false;
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    // The view keeps the mapping alive.
+    CloseHandle(mapping);
+    if (view == nullptr) return false;
+    mapping_ = view;
+    size_ = mapping_size_ = static_cast<size_t>(file_size.QuadPart);
+#else
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return true;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps the file alive.
+    close(fd);
+    if (view == MAP_FAILED) return false;
+    madvise(view, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+    mapping_ = view;
+    size_ = mapping_size_ = static_cast<size_t>(st.st_size);
+#endif
+    data_ = static_cast<const char*>(mapping_);
+    return true;
+}
+
+bool SourceBuffer::Read(const std::string& filename) {
+    Reset();
+#ifdef _WIN32
+    // Shared for everything, so a save replacing the file while it is read still goes through.
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) {
+        CloseHandle(file);
+        return false;
+    }
+    owned_.resize(static_cast<size_t>(file_size.QuadPart));
+    size_t read = 0;
+    while (read < owned_.size()) {
+        DWORD chunk = 0;
+        const auto wanted = static_cast<DWORD>(std::min<size_t>(owned_.size() - read, 1u << 30));
+        if (!ReadFile(file, owned_.data() + read, wanted, &chunk, nullptr)) {
+            CloseHandle(file);
+            owned_.clear();
+            return false;
+        }
+        // The file got shorter since its size was read.
+        if (chunk == 0) break;
+        read += chunk;
+    }
+    CloseHandle(file);
+#else
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    owned_.resize(static_cast<size_t>(st.st_size));
+    size_t read = 0;
+    while (read < owned_.size()) {
+        const ssize_t chunk = ::read(fd, owned_.data() + read, owned_.size() - read);
+        if (chunk < 0) {
+            close(fd);
+            owned_.clear();
+            return false;
+        }
+        if (chunk == 0) break;
+        read += static_cast<size_t>(chunk);
+    }
+    close(fd);
+#endif
+    owned_.resize(read);
+    data_ = owned_.data();
+    size_ = owned_.size();
+    return true;
+}
+
+//-----------
+// Tokenizer
+//-----------
+
+bool Tokenizer::NextLine() {
+    if (position_ < buffer_.size()) {
+        const char* begin = buffer_.data() + position_;
+        const size_t remaining = buffer_.size() - position_;
+        const char* newline = static_cast<const char*>(std::memchr(begin, '\n', remaining));
+        const size_t length = newline == nullptr ? remaining : static_cast<size_t>(newline - begin);
+        position_ += newline == nullptr ? length : length + 1;
+        line_ = Trim({ begin, length });
+        return true;
+    }
+    line_ = buffer_.substr(buffer_.size());
+    at_end_ = true;
+    return false;
+}
+
+std::string_view Tokenizer::Trim(std::string_view s) {
+    const auto first = s.find_first_not_of(kSeparators);
+    if (first == std::string_view::npos) return s.substr(s.size());
+    const auto last = s.find_last_not_of(kSeparators);
+    return s.substr(first, last - first + 1);
+}
+
+std::string_view Tokenizer::Tag(std::string_view line) {
+    if (line.empty() || line.front() != '[') return {};
+    const auto closing_bracket = line.find(']');
+    if (closing_bracket == std::string_view::npos) return {};
+    return line.substr(0, closing_bracket + 1);
+}
+
+std::string_view Tokenizer::NextToken(std::string_view& rest) {
+    const auto first = rest.find_first_not_of(kSeparators);
+    if (first == std::string_view::npos) {
+        rest = rest.substr(rest.size());
+        return rest;
+    }
+    rest.remove_prefix(first);
+    const auto last = std::min(rest.find_first_of(kSeparators), rest.size());
+    const auto token = rest.substr(0, last);
+    rest.remove_prefix(last);
+    return token;
+}
+
+}  // namespace falcon_ui
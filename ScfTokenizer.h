@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+
+
+namespace falcon_ui {
+
+// Read-only bytes of a whole .scf file. Files are memory mapped or read, contents given by the caller are owned.
+// All string_views handed out by the parser point inside this buffer, so it must outlive them.
+class SourceBuffer {
+public:
+    SourceBuffer() = default;
+    ~SourceBuffer() { Reset(); }
+
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+    SourceBuffer(SourceBuffer&& other) noexcept { *this = std::move(other); }
+    SourceBuffer& operator=(SourceBuffer&& other) noexcept;
+
+    // Maps the file for reading. Returns false if the file could not be opened.
+    // On Windows a mapped file cannot be replaced or written in place, so only the read-only inputs are mapped (the
+    // resource archives, the caches and indexes of the editor).
+    bool Map(const std::string& filename);
+    // Reads the whole file into an owned buffer, which keeps nothing of the file open: for the files which may be
+    // saved while in use (the .scf files, which the editor and external editors write). Returns false on error.
+    bool Read(const std::string& filename);
+
+    // Takes ownership of contents.
+    void Assign(std::string contents);
+
+    std::string_view View() const { return { data_, size_ }; }
+
+    // Restricts View() to size bytes starting at offset (of the current view), for files embedding the source.
+    // Returns false if the range is out of bounds.
+    bool Narrow(size_t offset, size_t size);
+
+private:
+    void Reset();
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    // Size of the whole mapping, which Narrow() does not change.
+    size_t mapping_size_ = 0;
+    // Only one of these is used: the mapped view or the owned contents.
+    void* mapping_ = nullptr;
+    std::string owned_;
+};
+
+// Splits a buffer in trimmed lines without copying. Lines are separated by '\n', and '\r' is trimmed
+// as any other whitespace, so both line endings work.
+class Tokenizer {
+public:
+    explicit Tokenizer(std::string_view buffer) : buffer_(buffer) {}
+
+    // Moves to the next line (trimmed). Returns false if the buffer is over, in which case Line() is empty.
+    bool NextLine();
+
+    // The current trimmed line.
+    std::string_view Line() const { return line_; }
+    // Offset of the current trimmed line inside the buffer.
+    size_t LineOffset() const { return line_.data() - buffer_.data(); }
+    bool AtEnd() const { return at_end_; }
+
+    std::string_view Buffer() const { return buffer_; }
+
+    // Helpers which also work on views not coming from a tokenizer.
+    static std::string_view Trim(std::string_view s);
+    static bool IsComment(std::string_view line) { return !line.empty() && line.front() == '#'; }
+    // Returns the leading [TAG] of line (brackets included) or empty if line does not start with one.
+    static std::string_view Tag(std::string_view line);
+    // Returns the next whitespace separated token from rest, consuming it. Empty when rest is over.
+    static std::string_view NextToken(std::string_view& rest);
+
+private:
+    std::string_view buffer_;
+    size_t position_ = 0;
+    std::string_view line_;
+    bool at_end_ = false;
+};
+
+}  // namespace falcon_ui
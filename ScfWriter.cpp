@@ -0,0 +1,86 @@
+#include "ScfWriter.h"
+
+#include "FileUtil.h"
+#include "Tracing.h"
+
+
+namespace falcon_ui {
+
+namespace {
+
+// CRLF if the file has any (as the game files), LF if it only has those. CRLF for files without lines.
+std::string_view LineEnding(std::string_view source) {
+    if (source.find("\r\n") != std::string_view::npos) return "\r\n";
+    return source.find('\n') != std::string_view::npos ? "\n" : "\r\n";
+}
+
+size_t CanonicalElementSizeBound(const WindowModel& model, const ElementRecord& element, size_t line_ending_size) {
+    const auto* spec = SpecForTag(element.tag);
+    // Element line and the blank line after the element.
+    size_t size = (spec != nullptr ? spec->name.size() : 0) + 2 * line_ending_size;
+    for (const auto& comment : model.comments.subspan(element.first_comment, element.comment_count)) {
+        size += comment.length + line_ending_size;
+    }
+    for (const auto& attribute : model.attributes.subspan(element.first_attribute, element.attribute_count)) {
+        size += EncodedAttributeSizeBound(attribute) + line_ending_size;
+    }
+    return size;
+}
+
+// Comments, element line and attributes, each on its line. All elements but the last are followed by a blank line.
+void WriteCanonicalElement(const WindowModel& model, const ElementRecord& element, std::string_view source, std::string_view line_ending, bool last, std::string& out) {
+    for (const auto& comment : model.comments.subspan(element.first_comment, element.comment_count)) {
+        out.append(Resolve(source, comment));
+        out.append(line_ending);
+    }
+    if (const auto* spec = SpecForTag(element.tag); spec != nullptr) out.append(spec->name);
+    out.append(line_ending);
+    for (const auto& attribute : model.attributes.subspan(element.first_attribute, element.attribute_count)) {
+        EncodeAttribute(attribute, source, out);
+        out.append(line_ending);
+    }
+    if (!last) out.append(line_ending);
+}
+
+}  // namespace
+
+size_t SerializedWindowSizeBound(const WindowModel& model, std::string_view source) {
+    if (model.elements.empty()) return source.size();
+    const size_t line_ending_size = LineEnding(source).size();
+    size_t size = model.elements.front().source.offset;
+    for (const auto& element : model.elements) {
+        size += element.edited ? CanonicalElementSizeBound(model, element, line_ending_size) : element.source.length;
+    }
+    return size;
+}
+
+void SerializeWindow(const WindowModel& model, std::string_view source, std::string& out) {
+    // Without elements (the window did not parse), the source is all there is.
+    if (model.elements.empty()) {
+        out.append(source);
+        return;
+    }
+    const auto line_ending = LineEnding(source);
+    // Blank lines before the first element.
+    out.append(source.substr(0, model.elements.front().source.offset));
+    for (size_t i = 0; i < model.elements.size(); ++i) {
+        const auto& element = model.elements[i];
+        if (element.edited) {
+            WriteCanonicalElement(model, element, source, line_ending, i + 1 == model.elements.size(), out);
+        } else {
+            out.append(Resolve(source, element.source));
+        }
+    }
+}
+
+bool SaveWindow(const WindowModel& model, std::string_view source, const std::string& path) {
+    FALCON_UI_TRACE_SCOPE_DETAIL("SaveWindow", path);
+    // Reused by all the windows saved on this thread, a bulk save allocates once per thread.
+    thread_local std::string buffer;
+    buffer.clear();
+    buffer.reserve(SerializedWindowSizeBound(model, source));
+    SerializeWindow(model, source, buffer);
+    return WriteFileAtomically(path, buffer);
+}
+
+}  // namespace falcon_ui
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include "ScfRecords.h"
+
+
+namespace falcon_ui {
+
+// Writes windows back to .scf. Elements which are not edited (see ElementRecord::edited) are copied byte for byte from
+// the source, with their comments, spacing and line endings, so saving an unmodified window gives back the same file.
+// Edited elements are written in canonical form from their records, with the line ending of the file. Only what the
+// model has of them is written: their comments are the ones before their tag line, comments between their attributes
+// and attribute lines the parser skipped (see WindowModel::skipped) are dropped.
+//
+// All spans of the model are resolved against source: the window source, which edits may extend with new text (labels,
+// resources...) for the spans of the edited elements.
+
+// Upper bound of the size SerializeWindow appends, to allocate once.
+size_t SerializedWindowSizeBound(const WindowModel& model, std::string_view source);
+
+// Appends the window text to out.
+void SerializeWindow(const WindowModel& model, std::string_view source, std::string& out);
+
+// Serializes the window into one buffer and writes it with one write to a temporary file next to path, which is then
+// renamed over path. Readers (the game, the file watcher) never see a partial file. Returns false on error, in which
+// case path is unchanged. path is usually the file the window was loaded from, which windows keep no hold on (see
+// SourceBuffer::Read): source stays valid after the save.
+bool SaveWindow(const WindowModel& model, std::string_view source, const std::string& path);
+
+}  // namespace falcon_ui
@@ -0,0 +1,164 @@
+#include "SymbolIndex.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "ParallelFor.h"
+#include "ScfTokenizer.h"
+#include "Tracing.h"
+
+
+namespace falcon_ui {
+
+namespace {
+
+bool FileLess(const SymbolReference& reference, uint32_t file) { return reference.file < file; }
+bool LessFile(uint32_t file, const SymbolReference& reference) { return file < reference.file; }
+
+}  // namespace
+
+void SymbolIndex::CollectWindow(const Window& window, uint32_t file, std::vector<Entry>& entries) {
+    const auto& model = window.Model();
+    const auto source = window.Source();
+    auto& symbols = SymbolTable::Global();
+    // Resources are kept as text, their first token is the id the game looks up.
+    const auto first_token = [&](TextSpan span) {
+        auto rest = Resolve(source, span);
+        return symbols.Intern(Tokenizer::NextToken(rest));
+    };
+
+    // Attributes are in line order, each with the line the parser found it on.
+    for (uint32_t element = 0; element < model.elements.size(); ++element) {
+        const auto& element_record = model.elements[element];
+        for (const auto& record : model.attributes.subspan(element_record.first_attribute, element_record.attribute_count)) {
+            const auto add = [&](SymbolId symbol, SymbolUse use) {
+                if (symbol != kNoSymbol) entries.push_back({ symbol, { file, element, record.line, use } });
+            };
+            switch (record.tag) {
+                case Tag::SETUP: {
+                    add(record.setup.label, SymbolUse::LABEL);
+                    const auto element_tag = element_record.tag;
+                    if (element_tag == Tag::BITMAP || element_tag == Tag::TILE) add(first_token(record.setup.resource), SymbolUse::BITMAP);
+                    break;
+                }
+                case Tag::BITMAP:
+                case Tag::TILE:
+                    add(first_token(record.text.text), SymbolUse::BITMAP);
+                    break;
+                case Tag::BUTTONIMAGE:
+                    add(record.state.resource, SymbolUse::BITMAP);
+                    break;
+                case Tag::SOUNDBITE:
+                    add(record.state.resource, SymbolUse::SOUND);
+                    break;
+                case Tag::CURSOR:
+                    add(first_token(record.text.text), SymbolUse::CURSOR);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+void SymbolIndex::Add(const BulkLoadResult& result, unsigned thread_count) {
+    FALCON_UI_TRACE_SCOPE("SymbolIndex::Add");
+    const auto& windows = result.windows;
+    // Ids are given up front, so the workers only write the entries of their windows.
+    std::vector<uint32_t> file_ids(windows.size());
+    for (size_t i = 0; i < windows.size(); ++i) {
+        file_ids[i] = FileId(windows[i].full_path);
+    }
+
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    thread_count = static_cast<unsigned>(std::min<size_t>(thread_count != 0 ? thread_count : cores, std::max<size_t>(windows.size(), 1)));
+    std::vector<std::vector<Entry>> entries(windows.size());
+    ParallelFor(windows.size(), thread_count, "Indexer", [&](size_t i, unsigned) {
+        if (windows[i].window.Good()) CollectWindow(windows[i].window, file_ids[i], entries[i]);
+    });
+
+    // Files come in id order, so for a new index the references of each file are appended to the lists.
+    FALCON_UI_TRACE_SCOPE("SymbolIndex Merge");
+    for (size_t i = 0; i < windows.size(); ++i) {
+        auto& file = files_[file_ids[i]];
+        RemoveReferences(file, file_ids[i]);
+        InsertReferences(file, entries[i]);
+        // Releases the entries as they are merged, to keep the peak memory down.
+        std::vector<Entry>().swap(entries[i]);
+    }
+}
+
+void SymbolIndex::Update(const std::string& path, const Window& window) {
+    FALCON_UI_TRACE_SCOPE_DETAIL("SymbolIndex::Update", path);
+    const auto file_id = FileId(path);
+    auto& file = files_[file_id];
+    RemoveReferences(file, file_id);
+    std::vector<Entry> entries;
+    if (window.Good()) CollectWindow(window, file_id, entries);
+    InsertReferences(file, entries);
+}
+
+void SymbolIndex::Remove(const std::string& path) {
+    const auto it = file_ids_.find(path);
+    if (it == file_ids_.end()) return;
+    RemoveReferences(files_[it->second], it->second);
+}
+
+bool SymbolIndex::Contains(const std::string& path) const {
+    const auto it = file_ids_.find(path);
+    return it != file_ids_.end() && files_[it->second].indexed;
+}
+
+std::span<const SymbolReference> SymbolIndex::Usages(SymbolId symbol) const {
+    if (symbol >= usages_.size()) return {};
+    return usages_[symbol];
+}
+
+std::span<const SymbolReference> SymbolIndex::Usages(std::string_view symbol) const {
+    const auto id = SymbolTable::Global().Find(symbol);
+    return id != kNoSymbol ? Usages(id) : std::span<const SymbolReference>{};
+}
+
+uint32_t SymbolIndex::FileId(const std::string& path) {
+    const auto [it, added] = file_ids_.try_emplace(path, static_cast<uint32_t>(files_.size()));
+    if (added) files_.push_back({ path, {}, false });
+    return it->second;
+}
+
+void SymbolIndex::RemoveReferences(File& file, uint32_t file_id) {
+    for (const auto symbol : file.symbols) {
+        auto& references = usages_[symbol];
+        const auto begin = std::lower_bound(references.begin(), references.end(), file_id, FileLess);
+        const auto end = std::upper_bound(begin, references.end(), file_id, LessFile);
+        reference_count_ -= end - begin;
+        references.erase(begin, end);
+    }
+    file.symbols.clear();
+    file.indexed = false;
+}
+
+void SymbolIndex::InsertReferences(File& file, std::vector<Entry>& entries) {
+    file.indexed = true;
+    if (entries.empty()) return;
+    // Groups the references by symbol, each group stays in line order.
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.symbol < b.symbol; });
+    const auto file_id = entries.front().reference.file;
+    if (entries.back().symbol >= usages_.size()) usages_.resize(size_t{ entries.back().symbol } + 1);
+    for (auto group = entries.begin(); group != entries.end();) {
+        const auto symbol = group->symbol;
+        const auto group_end = std::find_if(group, entries.end(), [symbol](const Entry& entry) { return entry.symbol != symbol; });
+        auto& references = usages_[symbol];
+        // Appending is the common case: files are added in id order.
+        auto position = references.end();
+        if (!references.empty() && references.back().file > file_id) {
+            position = std::upper_bound(references.begin(), references.end(), file_id, LessFile);
+        }
+        auto inserted = references.insert(position, group_end - group, SymbolReference{});
+        for (auto entry = group; entry != group_end; ++entry) *inserted++ = entry->reference;
+        file.symbols.push_back(symbol);
+        reference_count_ += group_end - group;
+        group = group_end;
+    }
+}
+
+}  // namespace falcon_ui
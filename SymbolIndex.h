@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "BulkLoader.h"
+#include "SymbolTable.h"
+
+
+namespace falcon_ui {
+
+// How a window uses a symbol.
+enum class SymbolUse : uint8_t {
+    LABEL,   // [SETUP] label.
+    BITMAP,  // Resource of a [BITMAP] or [TILE] element, [BITMAP] and [TILE] attributes, [BUTTONIMAGE].
+    SOUND,   // [SOUNDBITE].
+    CURSOR,  // [CURSOR].
+};
+
+// One use of a symbol: the file, the element (index in the window model, 0 is the root window) and the 1 based line.
+struct SymbolReference {
+    uint32_t file;
+    uint32_t element;
+    uint32_t line;
+    SymbolUse use;
+};
+
+// Inverted index of the symbols used by the windows (labels, bitmaps, sounds, cursors) to their references in all the
+// indexed files. Usages() is an array access, whatever the number of files.
+// References of a symbol are sorted by file and line. Files are added in parallel with Add() and re-indexed one at a
+// time with Update() when they change. Not thread safe, used from one thread at a time.
+class SymbolIndex {
+public:
+    // Indexes all good windows of result (the load order gives the file order), thread_count threads (0 for one per core).
+    void Add(const BulkLoadResult& result, unsigned thread_count = 0);
+    // Replaces the references of path with the ones of window, which was loaded from it. Adds path if it is new.
+    void Update(const std::string& path, const Window& window);
+    // Drops the references of path, for example when it is deleted.
+    void Remove(const std::string& path);
+
+    // True if path was added (and not removed).
+    bool Contains(const std::string& path) const;
+
+    std::span<const SymbolReference> Usages(SymbolId symbol) const;
+    // Usages of a symbol by its text, for example from a search box.
+    std::span<const SymbolReference> Usages(std::string_view symbol) const;
+
+    const std::string& FilePath(uint32_t file) const { return files_[file].path; }
+    size_t FileCount() const { return files_.size(); }
+    size_t ReferenceCount() const { return reference_count_; }
+
+private:
+    // A reference with its symbol, as collected from one window.
+    struct Entry {
+        SymbolId symbol;
+        SymbolReference reference;
+    };
+
+    struct File {
+        std::string path;
+        // Distinct symbols of the file, to find its references when it is updated or removed.
+        std::vector<SymbolId> symbols;
+        bool indexed = false;
+    };
+
+    // Collects the references of window, in line order. file is the id to record in them.
+    static void CollectWindow(const Window& window, uint32_t file, std::vector<Entry>& entries);
+
+    uint32_t FileId(const std::string& path);
+    void RemoveReferences(File& file, uint32_t file_id);
+    // Adds the references of one file, which has none. entries are in line order.
+    void InsertReferences(File& file, std::vector<Entry>& entries);
+
+    std::vector<File> files_;
+    std::unordered_map<std::string, uint32_t> file_ids_;
+    // References by SymbolId, only as long as the largest id referenced.
+    std::vector<std::vector<SymbolReference>> usages_;
+    size_t reference_count_ = 0;
+};
+
+}  // namespace falcon_ui
@@ -0,0 +1,122 @@
+#include "SymbolTable.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "Hash.h"
+
+
+namespace falcon_ui {
+
+SymbolTable::SymbolTable() {
+    AddName(kNoSymbol, {}, HashBytes({}));
+}
+
+SymbolTable::~SymbolTable() {
+    for (auto& segment : segments_) {
+        delete[] segment.load(std::memory_order_relaxed);
+    }
+}
+
+SymbolTable& SymbolTable::Global() {
+    static SymbolTable table;
+    return table;
+}
+
+SymbolId SymbolTable::Intern(std::string_view text) {
+    if (text.empty()) return kNoSymbol;
+    const uint64_t hash = HashBytes(text);
+
+    // Most symbols were seen recently by the same thread, which then finds them without touching the shared maps.
+    struct CacheEntry {
+        const SymbolTable* table;
+        SymbolId id;
+    };
+    thread_local std::array<CacheEntry, kThreadCacheSize> cache{};
+    auto& entry = cache[hash & (kThreadCacheSize - 1)];
+    if (entry.table == this && Name(entry.id) == text) return entry.id;
+
+    auto& shard = shards_[hash >> (64 - kShardBits)];
+    SymbolId id;
+    {
+        std::shared_lock lock(shard.mutex);
+        id = FindInShard(shard, text, hash);
+    }
+    if (id == kNoSymbol) {
+        std::unique_lock lock(shard.mutex);
+        // Another thread may have added it between the locks.
+        id = FindInShard(shard, text, hash);
+        if (id == kNoSymbol) {
+            id = next_id_.fetch_add(1, std::memory_order_relaxed);
+            AddName(id, text, hash);
+            AddToShard(shard, id, hash);
+        }
+    }
+    entry = { this, id };
+    return id;
+}
+
+SymbolId SymbolTable::Find(std::string_view text) const {
+    if (text.empty()) return kNoSymbol;
+    const uint64_t hash = HashBytes(text);
+    const auto& shard = shards_[hash >> (64 - kShardBits)];
+    std::shared_lock lock(shard.mutex);
+    return FindInShard(shard, text, hash);
+}
+
+SymbolId SymbolTable::FindInShard(const Shard& shard, std::string_view text, uint64_t hash) const {
+    if (shard.slots.empty()) return kNoSymbol;
+    const size_t mask = shard.slots.size() - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const auto& slot = shard.slots[i];
+        if (slot.id == kNoSymbol) return kNoSymbol;
+        if (slot.hash == static_cast<uint32_t>(hash) && Name(slot.id) == text) return slot.id;
+    }
+}
+
+void SymbolTable::AddToShard(Shard& shard, SymbolId id, uint64_t hash) {
+    if (2 * (shard.count + 1) > shard.slots.size()) {
+        std::vector<Slot> slots(std::max<size_t>(64, 2 * shard.slots.size()), Slot{ kNoSymbol, 0 });
+        const size_t mask = slots.size() - 1;
+        for (const auto& slot : shard.slots) {
+            if (slot.id == kNoSymbol) continue;
+            size_t i = slot.hash & mask;
+            while (slots[i].id != kNoSymbol) i = (i + 1) & mask;
+            slots[i] = slot;
+        }
+        shard.slots = std::move(slots);
+    }
+    const size_t mask = shard.slots.size() - 1;
+    size_t i = hash & mask;
+    while (shard.slots[i].id != kNoSymbol) i = (i + 1) & mask;
+    shard.slots[i] = { id, static_cast<uint32_t>(hash) };
+    ++shard.count;
+}
+
+void SymbolTable::AddName(SymbolId id, std::string_view text, uint64_t hash) {
+    if ((id >> kSegmentBits) >= kMaxSegments) throw std::length_error("Too many symbols");
+
+    std::lock_guard lock(storage_mutex_);
+    if (text.size() > chunk_remaining_) {
+        const size_t size = std::max(kChunkSize, text.size());
+        chunks_.push_back(std::make_unique<char[]>(size));
+        chunk_position_ = chunks_.back().get();
+        chunk_remaining_ = size;
+    }
+    // Empty names have no storage, the view must still point somewhere.
+    const std::string_view name(chunk_position_ != nullptr ? chunk_position_ : "", text.size());
+    if (!text.empty()) std::memcpy(chunk_position_, text.data(), text.size());
+    chunk_position_ += text.size();
+    chunk_remaining_ -= text.size();
+
+    auto& segment = segments_[id >> kSegmentBits];
+    auto* entries = segment.load(std::memory_order_relaxed);
+    if (entries == nullptr) {
+        entries = new Entry[kSegmentSize];
+        segment.store(entries, std::memory_order_release);
+    }
+    entries[id & (kSegmentSize - 1)] = { name, hash };
+}
+
+}  // namespace falcon_ui
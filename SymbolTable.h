@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+
+namespace falcon_ui {
+
+// Id of an interned symbol, see SymbolTable.
+using SymbolId = uint32_t;
+// The empty symbol.
+constexpr SymbolId kNoSymbol = 0;
+
+// Append-only table of the symbols of the .scf files (labels, control types, states...). The same few thousand symbols
+// are used by all windows, interned they are stored once and compared as integers.
+// Interning can be done from any thread. Symbols are never removed, so ids and names stay valid until the table is
+// destroyed, and looking up a name is a lock free array access.
+class SymbolTable {
+public:
+    SymbolTable();
+    ~SymbolTable();
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // The table the parser interns into.
+    static SymbolTable& Global();
+
+    // Returns the id of text, adding it if it is new. The empty text is kNoSymbol.
+    SymbolId Intern(std::string_view text);
+    // Returns the id of text, or kNoSymbol if it was never interned.
+    SymbolId Find(std::string_view text) const;
+    // The text of id, which must come from this table.
+    std::string_view Name(SymbolId id) const { return GetEntry(id).name; }
+    // HashBytes of the text of id. Unlike ids, hashes are the same in every run, so they can be persisted.
+    uint64_t Hash(SymbolId id) const { return GetEntry(id).hash; }
+
+    // Symbols interned so far, kNoSymbol included.
+    size_t Size() const { return next_id_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int kShardBits = 6;
+    static constexpr int kSegmentBits = 14;
+    static constexpr size_t kSegmentSize = size_t{ 1 } << kSegmentBits;
+    // 64M symbols.
+    static constexpr size_t kMaxSegments = 4096;
+    static constexpr size_t kChunkSize = 64 * 1024;
+    static constexpr size_t kThreadCacheSize = 4096;
+
+    struct Entry {
+        std::string_view name;
+        uint64_t hash;
+    };
+
+    struct Slot {
+        // kNoSymbol for empty slots.
+        SymbolId id;
+        // Low bits of the hash of the name, to skip most names without reading them and to grow without hashing again.
+        uint32_t hash;
+    };
+
+    // The text to id maps are sharded by hash, so threads interning different symbols rarely wait for each other.
+    // Each is an open addressing table with linear probing, at most half full.
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::vector<Slot> slots;
+        size_t count = 0;
+    };
+
+    // Returns the id of text in shard, kNoSymbol if it is not there. The shard must be locked.
+    SymbolId FindInShard(const Shard& shard, std::string_view text, uint64_t hash) const;
+    void AddToShard(Shard& shard, SymbolId id, uint64_t hash);
+    const Entry& GetEntry(SymbolId id) const {
+        return segments_[id >> kSegmentBits].load(std::memory_order_acquire)[id & (kSegmentSize - 1)];
+    }
+    // Copies text to the chunks and publishes it as id.
+    void AddName(SymbolId id, std::string_view text, uint64_t hash);
+
+    std::array<Shard, size_t{ 1 } << kShardBits> shards_;
+    std::atomic<SymbolId> next_id_{ 1 };
+
+    // Names by id, in segments which are allocated once and never move.
+    std::array<std::atomic<Entry*>, kMaxSegments> segments_{};
+
+    std::mutex storage_mutex_;
+    std::vector<std::unique_ptr<char[]>> chunks_;
+    char* chunk_position_ = nullptr;
+    size_t chunk_remaining_ = 0;
+};
+
+}  // namespace falcon_ui
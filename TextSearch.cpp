@@ -0,0 +1,425 @@
+#include "TextSearch.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
+#include <thread>
+#include <type_traits>
+
+#include "FileUtil.h"
+#include "Header.h"
+#include "ParallelFor.h"
+#include "Tracing.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FALCON_UI_SSE2 1
+#include <emmintrin.h>
+#else
+#define FALCON_UI_SSE2 0
+#endif
+
+
+namespace falcon_ui {
+
+namespace {
+
+constexpr char kMagic[8] = { 'F', '4', 'U', 'I', 'T', 'R', 'G', 'M' };
+// Bump when the file layout changes.
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kTrigramCount = 1u << 24;
+
+// Index file: header, file table, paths, trigrams, posting offsets, postings and texts, each section 8 byte aligned.
+struct IndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t file_entry_size;
+    uint64_t file_count;
+    uint64_t path_size;
+    uint64_t trigram_count;
+    uint64_t posting_count;
+    uint64_t text_size;
+    uint64_t files_offset;
+    uint64_t paths_offset;
+    uint64_t trigrams_offset;
+    uint64_t posting_offsets_offset;
+    uint64_t postings_offset;
+    uint64_t text_offset;
+};
+
+static_assert(std::is_trivially_copyable_v<IndexHeader>);
+
+char FoldChar(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c | 0x20) : c;
+}
+
+// The generations saved for index_path, oldest first: index_path with a generation number before its extension
+// (text_search.3.f4ti). Each save writes a new one, as the previous one may be mapped by a loaded index.
+std::vector<std::pair<uint64_t, std::filesystem::path>> IndexGenerations(const std::filesystem::path& index_path) {
+    const auto prefix = index_path.stem().string() + ".";
+    const auto extension = index_path.extension().string();
+    std::vector<std::pair<uint64_t, std::filesystem::path>> generations;
+    std::error_code error;
+    for (auto it = std::filesystem::directory_iterator(index_path.parent_path(), error); !error && it != std::filesystem::directory_iterator();
+         it.increment(error)) {
+        const auto name = it->path().filename().string();
+        if (name.size() <= prefix.size() + extension.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+            name.compare(name.size() - extension.size(), extension.size(), extension) != 0) {
+            continue;
+        }
+        const auto number = name.substr(prefix.size(), name.size() - prefix.size() - extension.size());
+        if (number.find_first_not_of("0123456789") != std::string::npos || number.size() > 18) continue;
+        generations.emplace_back(std::stoull(number), it->path());
+    }
+    std::sort(generations.begin(), generations.end());
+    return generations;
+}
+
+uint32_t Trigram(const char* folded) {
+    return (uint32_t{ static_cast<uint8_t>(folded[0]) } << 16) | (uint32_t{ static_cast<uint8_t>(folded[1]) } << 8) | static_cast<uint8_t>(folded[2]);
+}
+
+#if FALCON_UI_SSE2
+__m128i FoldCase16(__m128i bytes) {
+    // Signed compares: bytes from 0x80 are negative, so never in 'A'..'Z'.
+    const auto upper = _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(bytes, _mm_set1_epi8('Z' + 1)));
+    return _mm_or_si128(bytes, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+__m128i Load16(const char* bytes) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+}
+#endif
+
+// True if size bytes of text, case folded, are folded_needle.
+bool EqualsFolded(const char* text, const char* folded_needle, size_t size) {
+    size_t i = 0;
+#if FALCON_UI_SSE2
+    for (; i + 16 <= size; i += 16) {
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(FoldCase16(Load16(text + i)), Load16(folded_needle + i))) != 0xFFFF) return false;
+    }
+#endif
+    for (; i < size; ++i) {
+        if (FoldChar(text[i]) != folded_needle[i]) return false;
+    }
+    return true;
+}
+
+// One file read for the index, with its distinct trigrams.
+struct ReadFile {
+    std::string text;
+    FileKey key{};
+    std::vector<uint32_t> trigrams;
+};
+
+// Reads path and lists its trigrams. seen is a bit per trigram, all clear, and is cleared again before returning.
+void ReadAndScan(const std::string& path, std::vector<uint64_t>& seen, ReadFile& file) {
+    FALCON_UI_TRACE_SCOPE_DETAIL("TextSearch Scan", path);
+    SourceBuffer source;
+    const auto key = StatFile(path);
+    if (!key.has_value() || !source.Read(path)) return;
+    file.key = *key;
+    file.text.assign(source.View());
+    // The size of the copy, in case the file changed since the stat.
+    file.key.size = file.text.size();
+
+    const auto text = FoldCase(file.text);
+    for (size_t i = 0; i + 3 <= text.size(); ++i) {
+        const auto trigram = Trigram(text.data() + i);
+        auto& word = seen[trigram >> 6];
+        const auto bit = uint64_t{ 1 } << (trigram & 63);
+        if ((word & bit) != 0) continue;
+        word |= bit;
+        file.trigrams.push_back(trigram);
+    }
+    for (const auto trigram : file.trigrams) seen[trigram >> 6] = 0;
+    std::sort(file.trigrams.begin(), file.trigrams.end());
+}
+
+}  // namespace
+
+std::string FoldCase(std::string_view text) {
+    std::string folded(text);
+    size_t i = 0;
+#if FALCON_UI_SSE2
+    for (; i + 16 <= folded.size(); i += 16) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(folded.data() + i), FoldCase16(Load16(folded.data() + i)));
+    }
+#endif
+    for (; i < folded.size(); ++i) folded[i] = FoldChar(folded[i]);
+    return folded;
+}
+
+size_t FindCaseInsensitive(std::string_view text, std::string_view folded_needle, size_t from) {
+    const size_t size = folded_needle.size();
+    if (from > text.size() || size > text.size() - from) return std::string_view::npos;
+    if (size == 0) return from;
+    const size_t last_start = text.size() - size;
+    size_t i = from;
+#if FALCON_UI_SSE2
+    // Tests 16 start positions at once on the first and last byte of the needle, and only compares the whole needle at
+    // the positions where both match.
+    const auto first = _mm_set1_epi8(folded_needle.front());
+    const auto last = _mm_set1_epi8(folded_needle.back());
+    for (; i + 16 <= last_start + 1; i += 16) {
+        const auto first_matches = _mm_cmpeq_epi8(FoldCase16(Load16(text.data() + i)), first);
+        const auto last_matches = _mm_cmpeq_epi8(FoldCase16(Load16(text.data() + i + size - 1)), last);
+        for (auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(first_matches, last_matches))); mask != 0; mask &= mask - 1) {
+            const size_t start = i + std::countr_zero(mask);
+            if (EqualsFolded(text.data() + start, folded_needle.data(), size)) return start;
+        }
+    }
+#endif
+    for (; i <= last_start; ++i) {
+        if (FoldChar(text[i]) == folded_needle.front() && EqualsFolded(text.data() + i, folded_needle.data(), size)) return i;
+    }
+    return std::string_view::npos;
+}
+
+std::unique_ptr<TextSearchIndex> TextSearchIndex::Build(const std::vector<std::string>& paths, unsigned thread_count) {
+    FALCON_UI_TRACE_SCOPE("TextSearchIndex::Build");
+    std::vector<ReadFile> files(paths.size());
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    thread_count = static_cast<unsigned>(std::min<size_t>(thread_count != 0 ? thread_count : cores, std::max<size_t>(paths.size(), 1)));
+    std::vector<std::vector<uint64_t>> seen(thread_count);
+    ParallelFor(paths.size(), thread_count, "Text Indexer", [&](size_t i, unsigned worker) {
+        // 2 MB per thread, which is less than sorting the trigrams of a big file.
+        if (seen[worker].empty()) seen[worker].resize(kTrigramCount / 64);
+        ReadAndScan(paths[i], seen[worker], files[i]);
+    });
+
+    // (trigram, file) pairs sorted by trigram then file give the posting lists in order.
+    std::vector<uint64_t> pairs;
+    size_t path_size = 0;
+    size_t text_size = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        for (const auto trigram : files[i].trigrams) pairs.push_back((uint64_t{ trigram } << 32) | i);
+        std::vector<uint32_t>().swap(files[i].trigrams);
+        path_size += paths[i].size();
+        text_size += files[i].text.size();
+    }
+    std::sort(pairs.begin(), pairs.end());
+    size_t trigram_count = 0;
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        if (i == 0 || (pairs[i] >> 32) != (pairs[i - 1] >> 32)) ++trigram_count;
+    }
+
+    IndexHeader header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.file_entry_size = sizeof(FileEntry);
+    header.file_count = files.size();
+    header.path_size = path_size;
+    header.trigram_count = trigram_count;
+    header.posting_count = pairs.size();
+    header.text_size = text_size;
+    header.files_offset = AlignSection(sizeof(header));
+    header.paths_offset = AlignSection(header.files_offset + files.size() * sizeof(FileEntry));
+    header.trigrams_offset = AlignSection(header.paths_offset + path_size);
+    header.posting_offsets_offset = AlignSection(header.trigrams_offset + trigram_count * sizeof(uint32_t));
+    header.postings_offset = AlignSection(header.posting_offsets_offset + (trigram_count + 1) * sizeof(uint32_t));
+    header.text_offset = AlignSection(header.postings_offset + pairs.size() * sizeof(uint32_t));
+
+    std::string bytes(header.text_offset + text_size, '\0');
+    std::memcpy(bytes.data(), &header, sizeof(header));
+    auto* entries = reinterpret_cast<FileEntry*>(bytes.data() + header.files_offset);
+    size_t path_offset = 0;
+    size_t text_offset = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+        entries[i] = { { static_cast<uint32_t>(path_offset), static_cast<uint32_t>(paths[i].size()) }, text_offset, files[i].key.size, files[i].key.mtime };
+        std::memcpy(bytes.data() + header.paths_offset + path_offset, paths[i].data(), paths[i].size());
+        std::memcpy(bytes.data() + header.text_offset + text_offset, files[i].text.data(), files[i].text.size());
+        path_offset += paths[i].size();
+        text_offset += files[i].text.size();
+        std::string().swap(files[i].text);
+    }
+    auto* trigrams = reinterpret_cast<uint32_t*>(bytes.data() + header.trigrams_offset);
+    auto* posting_offsets = reinterpret_cast<uint32_t*>(bytes.data() + header.posting_offsets_offset);
+    auto* postings = reinterpret_cast<uint32_t*>(bytes.data() + header.postings_offset);
+    size_t trigram = 0;
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        if (i == 0 || (pairs[i] >> 32) != (pairs[i - 1] >> 32)) {
+            trigrams[trigram] = static_cast<uint32_t>(pairs[i] >> 32);
+            posting_offsets[trigram++] = static_cast<uint32_t>(i);
+        }
+        postings[i] = static_cast<uint32_t>(pairs[i]);
+    }
+    posting_offsets[trigram_count] = static_cast<uint32_t>(pairs.size());
+
+    std::unique_ptr<TextSearchIndex> index(new TextSearchIndex());
+    index->storage_.Assign(std::move(bytes));
+    if (!index->Attach()) return nullptr;
+    return index;
+}
+
+std::unique_ptr<TextSearchIndex> TextSearchIndex::Load(const std::filesystem::path& index_path, const std::vector<std::string>& paths) {
+    FALCON_UI_TRACE_SCOPE("TextSearchIndex::Load");
+    const auto generations = IndexGenerations(index_path);
+    if (generations.empty()) return nullptr;
+    std::unique_ptr<TextSearchIndex> index(new TextSearchIndex());
+    if (!index->storage_.Map(generations.back().second.string()) || !index->Attach()) return nullptr;
+    if (index->FileCount() != paths.size()) return nullptr;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        const auto& entry = index->files_[i];
+        if (index->FilePath(static_cast<uint32_t>(i)) != paths[i]) return nullptr;
+        const auto key = StatFile(paths[i]);
+        // Files which could not be read are indexed empty, and must still be missing.
+        const FileKey indexed{ entry.size, entry.mtime };
+        if (key.has_value() ? *key != indexed : indexed != FileKey{}) return nullptr;
+    }
+    return index;
+}
+
+bool TextSearchIndex::Save(const std::filesystem::path& index_path) const {
+    FALCON_UI_TRACE_SCOPE("TextSearchIndex::Save");
+    const auto bytes = storage_.View();
+    std::error_code error;
+    std::filesystem::create_directories(index_path.parent_path(), error);
+    auto generations = IndexGenerations(index_path);
+    const uint64_t generation = generations.empty() ? 1 : generations.back().first + 1;
+    auto path = index_path;
+    path.replace_extension(std::to_string(generation) + index_path.extension().string());
+    if (!WriteFileAtomically(path, { bytes.data(), bytes.size() })) return false;
+    // The ones still mapped cannot be removed on Windows, a later save does.
+    for (const auto& previous : generations) std::filesystem::remove(previous.second, error);
+    return true;
+}
+
+bool TextSearchIndex::Attach() {
+    const auto bytes = storage_.View();
+    IndexHeader header;
+    if (bytes.size() < sizeof(header)) return false;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion || header.file_entry_size != sizeof(FileEntry)) return false;
+    if (header.trigram_count >= kTrigramCount || header.posting_count > UINT32_MAX) return false;
+    if (!InBounds(header.files_offset, header.file_count * sizeof(FileEntry), bytes.size()) ||
+        !InBounds(header.paths_offset, header.path_size, bytes.size()) ||
+        !InBounds(header.trigrams_offset, header.trigram_count * sizeof(uint32_t), bytes.size()) ||
+        !InBounds(header.posting_offsets_offset, (header.trigram_count + 1) * sizeof(uint32_t), bytes.size()) ||
+        !InBounds(header.postings_offset, header.posting_count * sizeof(uint32_t), bytes.size()) ||
+        !InBounds(header.text_offset, header.text_size, bytes.size())) {
+        return false;
+    }
+    const char* base = bytes.data();
+    files_ = { reinterpret_cast<const FileEntry*>(base + header.files_offset), header.file_count };
+    paths_ = { base + header.paths_offset, header.path_size };
+    trigrams_ = { reinterpret_cast<const uint32_t*>(base + header.trigrams_offset), header.trigram_count };
+    posting_offsets_ = { reinterpret_cast<const uint32_t*>(base + header.posting_offsets_offset), header.trigram_count + 1 };
+    postings_ = { reinterpret_cast<const uint32_t*>(base + header.postings_offset), header.posting_count };
+    text_ = { base + header.text_offset, header.text_size };
+
+    // Searches then only need the cheap checks.
+    for (const auto& file : files_) {
+        if (size_t{ file.path.offset } + file.path.length > paths_.size() || file.text_offset > text_.size() || file.size > text_.size() - file.text_offset) return false;
+    }
+    if (posting_offsets_.back() != postings_.size()) return false;
+    for (size_t i = 0; i < trigrams_.size(); ++i) {
+        if (posting_offsets_[i] > posting_offsets_[i + 1] || (i > 0 && trigrams_[i - 1] >= trigrams_[i])) return false;
+    }
+    for (const auto file : postings_) {
+        if (file >= files_.size()) return false;
+    }
+    return true;
+}
+
+std::string_view TextSearchIndex::FileText(uint32_t file) const {
+    return text_.substr(files_[file].text_offset, files_[file].size);
+}
+
+std::span<const uint32_t> TextSearchIndex::Postings(uint32_t trigram) const {
+    const auto it = std::lower_bound(trigrams_.begin(), trigrams_.end(), trigram);
+    if (it == trigrams_.end() || *it != trigram) return {};
+    const size_t i = it - trigrams_.begin();
+    return postings_.subspan(posting_offsets_[i], posting_offsets_[i + 1] - posting_offsets_[i]);
+}
+
+std::vector<uint32_t> TextSearchIndex::Candidates(std::string_view folded_query) const {
+    std::vector<std::span<const uint32_t>> lists;
+    for (size_t i = 0; i + 3 <= folded_query.size(); ++i) {
+        const auto postings = Postings(Trigram(folded_query.data() + i));
+        if (postings.empty()) return {};
+        lists.push_back(postings);
+    }
+    // Starting from the shortest list, each step can only shrink the candidates.
+    std::sort(lists.begin(), lists.end(), [](const auto& a, const auto& b) { return a.size() < b.size(); });
+    std::vector<uint32_t> candidates(lists.front().begin(), lists.front().end());
+    for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+        // Repeated trigrams of the query give the same list.
+        if (lists[i].data() == lists[i - 1].data()) continue;
+        const auto list = lists[i];
+        // Candidates and lists are sorted, so each search starts where the previous one ended.
+        auto from = list.begin();
+        std::erase_if(candidates, [&](uint32_t file) {
+            from = std::lower_bound(from, list.end(), file);
+            return from == list.end() || *from != file;
+        });
+    }
+    return candidates;
+}
+
+TextSearchResult TextSearchIndex::Search(std::string_view query, size_t max_matches) const {
+    FALCON_UI_TRACE_SCOPE("TextSearchIndex::Search");
+    TextSearchResult result;
+    const auto folded = FoldCase(query);
+    if (folded.empty()) return result;
+
+    std::vector<uint32_t> candidates;
+    if (folded.size() >= 3) {
+        candidates = Candidates(folded);
+    } else {
+        // Too short for a trigram, every file is a candidate.
+        candidates.resize(files_.size());
+        for (uint32_t file = 0; file < candidates.size(); ++file) candidates[file] = file;
+    }
+    result.candidate_files = candidates.size();
+
+    for (const auto file : candidates) {
+        const auto text = FileText(file);
+        uint32_t line = 1;
+        size_t line_start = 0;
+        size_t counted = 0;
+        for (size_t position = FindCaseInsensitive(text, folded); position != std::string_view::npos;) {
+            if (result.matches.size() == max_matches) {
+                result.truncated = true;
+                return result;
+            }
+            line += static_cast<uint32_t>(std::count(text.begin() + counted, text.begin() + position, '\n'));
+            counted = position;
+            const auto newline = text.rfind('\n', position);
+            line_start = newline == std::string_view::npos ? 0 : newline + 1;
+            auto line_end = text.find('\n', position);
+            if (line_end == std::string_view::npos) line_end = text.size();
+            auto line_text = text.substr(line_start, line_end - line_start);
+            if (!line_text.empty() && line_text.back() == '\r') line_text.remove_suffix(1);
+            result.matches.push_back({ file, line, static_cast<uint32_t>(position - line_start), line_text });
+            // One match per line, the search goes on from the next one.
+            position = line_end < text.size() ? FindCaseInsensitive(text, folded, line_end + 1) : std::string_view::npos;
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> ListTextSearchFiles(const std::string& install_dir) {
+    FALCON_UI_TRACE_SCOPE_DETAIL("ListTextSearchFiles", install_dir);
+    std::vector<std::string> paths;
+    std::error_code error;
+    if (std::filesystem::is_regular_file(TheaterListPath(install_dir), error)) paths.push_back(TheaterListPath(install_dir));
+    for (const auto& theater : ListTheaters(install_dir)) {
+        const auto art_dir = ArtDirForTheater(install_dir + DataDirForTheater(theater));
+        std::vector<std::string> theater_paths;
+        for (auto it = std::filesystem::recursive_directory_iterator(art_dir, error); !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+            if (!it->is_regular_file(error)) continue;
+            auto extension = it->path().extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return FoldChar(c); });
+            if (extension == ".scf" || extension == ".lst") theater_paths.push_back(it->path().string());
+        }
+        // Directory order is not stable, a sorted list lets a saved index be reused.
+        std::sort(theater_paths.begin(), theater_paths.end());
+        paths.insert(paths.end(), theater_paths.begin(), theater_paths.end());
+    }
+    return paths;
+}
+
+}  // namespace falcon_ui
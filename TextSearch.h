@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ScfRecords.h"
+#include "ScfTokenizer.h"
+
+
+namespace falcon_ui {
+
+// Returns the position of the first case insensitive (ASCII) occurrence of folded_needle in text at or after from, or
+// npos. folded_needle must be lower case (see FoldCase). Compares 16 positions at a time where SSE2 is available.
+size_t FindCaseInsensitive(std::string_view text, std::string_view folded_needle, size_t from = 0);
+
+// ASCII lower case of text.
+std::string FoldCase(std::string_view text);
+
+// One line matching a search.
+struct TextMatch {
+    uint32_t file;
+    // 1 based.
+    uint32_t line;
+    // 0 based byte of the match in the line.
+    uint32_t column;
+    // Without its line ending, points inside the index.
+    std::string_view line_text;
+};
+
+struct TextSearchResult {
+    std::vector<TextMatch> matches;
+    // Files whose trigrams contain all the trigrams of the query, which were searched.
+    size_t candidate_files = 0;
+    // True if the search stopped at the maximum number of matches.
+    bool truncated = false;
+};
+
+// Case insensitive substring search over the text of many files (the .scf and .lst files of the installations).
+// Each file is indexed by the case folded trigrams (3 byte sequences) it contains. A query only searches the files
+// which contain all of its trigrams, found by intersecting their sorted lists of files.
+// The index is one buffer holding the file table, the trigram lists and a copy of the texts, which is also its file
+// format: saving writes the buffer and loading maps it. Immutable once built, so it can be searched from any thread.
+class TextSearchIndex {
+public:
+    // Reads and indexes paths, thread_count threads (0 for one per core). Files which cannot be read are indexed empty.
+    static std::unique_ptr<TextSearchIndex> Build(const std::vector<std::string>& paths, unsigned thread_count = 0);
+    // Maps the index last saved for index_path. Returns nullptr if it cannot be read, or if it does not index exactly
+    // paths in their current version (size and modification time).
+    static std::unique_ptr<TextSearchIndex> Load(const std::filesystem::path& index_path, const std::vector<std::string>& paths);
+    // Writes the index to a new generation of index_path (text_search.f4ti is saved as text_search.1.f4ti, then
+    // text_search.2.f4ti...), never over the one a loaded index maps, and removes the previous ones. Returns false on
+    // error.
+    bool Save(const std::filesystem::path& index_path) const;
+
+    // Lines of the files containing query, in file and line order. Up to max_matches.
+    TextSearchResult Search(std::string_view query, size_t max_matches) const;
+
+    size_t FileCount() const { return files_.size(); }
+    std::string_view FilePath(uint32_t file) const { return Resolve(paths_, files_[file].path); }
+    std::string_view FileText(uint32_t file) const;
+    size_t TextSize() const { return text_.size(); }
+    size_t TrigramCount() const { return trigrams_.size(); }
+
+private:
+    struct FileEntry {
+        // In the path text.
+        TextSpan path;
+        uint64_t text_offset;
+        uint64_t size;
+        int64_t mtime;
+    };
+
+    TextSearchIndex() = default;
+    // Points the arrays to the sections of storage_. Returns false if the buffer is not a valid index.
+    bool Attach();
+    // The files containing all trigrams of folded_query (at least 3 bytes), in file order.
+    std::vector<uint32_t> Candidates(std::string_view folded_query) const;
+    std::span<const uint32_t> Postings(uint32_t trigram) const;
+
+    SourceBuffer storage_;
+    std::span<const FileEntry> files_;
+    std::string_view paths_;
+    // Sorted trigrams, and for trigram i its files are postings_[posting_offsets_[i], posting_offsets_[i + 1]).
+    std::span<const uint32_t> trigrams_;
+    std::span<const uint32_t> posting_offsets_;
+    std::span<const uint32_t> postings_;
+    std::string_view text_;
+};
+
+// Every .scf and .lst file of the Art folders of the theaters of install_dir, and the theater list.
+std::vector<std::string> ListTextSearchFiles(const std::string& install_dir);
+
+}  // namespace falcon_ui
@@ -0,0 +1,130 @@
+#include "TextSearchPanel.h"
+
+#include <cstring>
+
+#include "Header.h"
+#include "imgui.h"
+#include "Tracing.h"
+
+
+namespace falcon_ui {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+}  // namespace
+
+void TextSearchPanel::IndexAllInstallations(bool rebuild) {
+    if (Indexing()) return;
+    started_ = true;
+    index_start_ = Clock::now();
+    pending_ = JobSystem::Get().Submit(JobPriority::BACKGROUND, [index_path = index_path_, rebuild](const CancellationToken& token) {
+        std::vector<std::string> paths;
+        for (const auto& installation : GetAllBMSInstallations()) {
+            auto installation_paths = ListTextSearchFiles(InstallDirForInstallation(installation));
+            paths.insert(paths.end(), installation_paths.begin(), installation_paths.end());
+        }
+        if (token.Cancelled()) return std::unique_ptr<TextSearchIndex>();
+        auto index = rebuild ? nullptr : TextSearchIndex::Load(index_path, paths);
+        if (index == nullptr && !token.Cancelled()) {
+            index = TextSearchIndex::Build(paths);
+            if (index != nullptr) index->Save(index_path);
+        }
+        return index;
+    });
+}
+
+void TextSearchPanel::FinishIndexing() {
+    if (!pending_.Ready()) return;
+    auto index = pending_.Get();
+    index_time_ = Clock::now() - index_start_;
+    if (index == nullptr) return;
+    index_ = std::move(index);
+    // The query is searched again in the new index, right away.
+    search_due_ = true;
+    query_edit_ = {};
+}
+
+void TextSearchPanel::UpdateSearch() {
+    if (searching_.Ready()) shown_ = searching_.Get();
+    if (!search_due_ || searching_.Valid() || index_ == nullptr || Clock::now() - query_edit_ < kSearchDelay) return;
+    search_due_ = false;
+    std::string query(query_.data());
+    if (query.size() < kMinQueryLength) {
+        shown_ = {};
+        return;
+    }
+    searching_ = JobSystem::Get().Submit(JobPriority::INTERACTIVE, [index = index_, query = std::move(query)](const CancellationToken&) {
+        const auto start = Clock::now();
+        auto result = index->Search(query, kMaxMatches);
+        return Search{ index, std::move(result), Clock::now() - start };
+    });
+}
+
+void TextSearchPanel::Draw(bool* open) {
+    // The first time the panel shows up.
+    if (!started_) IndexAllInstallations(/*rebuild=*/false);
+    FinishIndexing();
+    UpdateSearch();
+    if (!ImGui::Begin("Search Text", open)) {
+        ImGui::End();
+        return;
+    }
+
+    ImGui::BeginDisabled(Indexing());
+    if (ImGui::Button("Rebuild Index")) IndexAllInstallations(/*rebuild=*/true);
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    if (Indexing()) {
+        ImGui::TextUnformatted("Indexing...");
+    } else if (index_ != nullptr) {
+        ImGui::Text("%zu files, %.1f MB, %zu trigrams, ready in %.0f ms", index_->FileCount(), index_->TextSize() / 1e6, index_->TrigramCount(), std::chrono::duration<double, std::milli>(index_time_).count());
+    } else {
+        ImGui::TextUnformatted("Indexing failed");
+    }
+
+    if (ImGui::InputText("Text", query_.data(), query_.size())) {
+        search_due_ = true;
+        query_edit_ = Clock::now();
+    }
+    if (index_ == nullptr || query_[0] == '\0') {
+        ImGui::End();
+        return;
+    }
+    if (std::strlen(query_.data()) < kMinQueryLength) {
+        ImGui::Text("Type at least %zu characters", kMinQueryLength);
+        ImGui::End();
+        return;
+    }
+    const auto& result = shown_.result;
+    ImGui::Text("%s%zu matches in %zu files searched, %.2f ms%s", result.truncated ? "First " : "", result.matches.size(), result.candidate_files, std::chrono::duration<double, std::milli>(shown_.time).count(),
+        search_due_ || searching_.Valid() ? ", searching..." : "");
+
+    if (!result.matches.empty() && ImGui::BeginTable("Matches", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY | ImGuiTableFlags_Resizable)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("File");
+        ImGui::TableSetupColumn("Line", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Text");
+        ImGui::TableHeadersRow();
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(result.matches.size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                const auto& match = result.matches[row];
+                const auto path = shown_.index->FilePath(match.file);
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(path.data(), path.data() + path.size());
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", match.line);
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(match.line_text.data(), match.line_text.data() + match.line_text.size());
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+}  // namespace falcon_ui
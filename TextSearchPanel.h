@@ -0,0 +1,67 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "JobSystem.h"
+#include "TextSearch.h"
+
+
+namespace falcon_ui {
+
+// ImGui window searching the text of every .scf and .lst file of every installation as the query is typed.
+// The index is loaded from index_path, or built on a background thread and saved there when the files changed.
+// Searches run on the job system once typing pauses, the last results showing meanwhile. Used from the UI thread.
+class TextSearchPanel {
+public:
+    static constexpr size_t kMaxMatches = 1000;
+    // Shorter queries have no trigram, so they would read every file: they are not searched.
+    static constexpr size_t kMinQueryLength = 3;
+    // The search starts once the query is left unchanged this long.
+    static constexpr std::chrono::milliseconds kSearchDelay{ 150 };
+
+    explicit TextSearchPanel(std::filesystem::path index_path) : index_path_(std::move(index_path)) {}
+
+    // Indexes all installations in the background. The saved index is used if it is still up to date, unless rebuild.
+    void IndexAllInstallations(bool rebuild);
+    // True while indexing, the UI must keep drawing frames to pick up the result.
+    bool Indexing() const { return pending_.Valid(); }
+    // True while indexing or until the search of the last query is done, the UI must keep drawing frames.
+    bool Busy() const { return Indexing() || searching_.Valid() || (search_due_ && index_ != nullptr); }
+
+    void Draw(bool* open);
+
+private:
+    // Swaps in the index built in the background, if it is done.
+    void FinishIndexing();
+    // Takes the result of the search in flight, if it is done, and starts the one of the query once due.
+    void UpdateSearch();
+
+    // A search and the index its matches point inside.
+    struct Search {
+        std::shared_ptr<const TextSearchIndex> index;
+        TextSearchResult result;
+        std::chrono::nanoseconds time{};
+    };
+
+    std::filesystem::path index_path_;
+    bool started_ = false;
+    // Shared with the search jobs, which keep the index they search alive.
+    std::shared_ptr<const TextSearchIndex> index_;
+    // The index being built. Its destructor cancels the build and waits for it.
+    JobFuture<std::unique_ptr<TextSearchIndex>> pending_;
+    std::chrono::steady_clock::time_point index_start_;
+    std::chrono::nanoseconds index_time_{};
+    std::array<char, 256> query_{};
+    // Set when the query or the index changes, the search starts kSearchDelay after query_edit_.
+    bool search_due_ = false;
+    std::chrono::steady_clock::time_point query_edit_;
+    // At most one search in flight, the query changes meanwhile are searched after it.
+    JobFuture<Search> searching_;
+    Search shown_;
+};
+
+}  // namespace falcon_ui
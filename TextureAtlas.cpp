@@ -0,0 +1,86 @@
+#include "TextureAtlas.h"
+
+#include <vector>
+
+#include "TextureCache.h"
+#include "Tracing.h"
+
+// imgui_draw.cpp keeps its implementation static, this one is ours.
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#if defined(__GNUC__)
+// Static, the heuristic setter we do not call is unused.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+#include "imstb_rectpack.h"
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+
+namespace falcon_ui {
+
+namespace {
+
+// Transparent pixels between the images, so the bilinear filtering of one never samples its neighbors.
+constexpr int kPadding = 1;
+
+}  // namespace
+
+// The context points into itself, it is never moved.
+struct TextureAtlas::Packer {
+    stbrp_context context;
+    std::vector<stbrp_node> nodes;
+};
+
+TextureAtlas::Page::Page() = default;
+TextureAtlas::Page::~Page() = default;
+
+TextureAtlas::~TextureAtlas() {
+    Clear();
+}
+
+bool TextureAtlas::Add(const uint32_t* pixels, int width, int height, Placement& placement) {
+    FALCON_UI_TRACE_SCOPE("TextureAtlas::Add");
+    stbrp_rect rect{};
+    rect.w = width + kPadding;
+    rect.h = height + kPadding;
+    Page* target = nullptr;
+    // A rectangle which does not fit leaves the packer as it was, so the pages are tried in turn.
+    for (auto& page : pages_) {
+        if (stbrp_pack_rects(&page.packer->context, &rect, 1) && rect.was_packed) {
+            target = &page;
+            break;
+        }
+    }
+    if (target == nullptr) {
+        const auto id = backend_.CreateDynamic(kPageSize, kPageSize);
+        if (id == nullptr) return false;
+        auto& page = pages_.emplace_back();
+        page.id = id;
+        page.packer = std::make_unique<Packer>();
+        page.packer->nodes.resize(kPageSize);
+        stbrp_init_target(&page.packer->context, kPageSize, kPageSize, page.packer->nodes.data(), kPageSize);
+        // Always fits an empty page.
+        stbrp_pack_rects(&page.packer->context, &rect, 1);
+        target = &page;
+    }
+    backend_.Update(target->id, rect.x, rect.y, pixels, width, height);
+    placement.page = target;
+    placement.uv0 = ImVec2(static_cast<float>(rect.x) / kPageSize, static_cast<float>(rect.y) / kPageSize);
+    placement.uv1 = ImVec2(static_cast<float>(rect.x + width) / kPageSize, static_cast<float>(rect.y + height) / kPageSize);
+    return true;
+}
+
+void TextureAtlas::Remove(Page* page) {
+    backend_.Destroy(page->id);
+    pages_.remove_if([page](const Page& candidate) { return &candidate == page; });
+}
+
+void TextureAtlas::Clear() {
+    for (auto& page : pages_) backend_.Destroy(page.id);
+    pages_.clear();
+}
+
+}  // namespace falcon_ui
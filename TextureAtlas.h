@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+
+#include "imgui.h"
+
+
+namespace falcon_ui {
+
+class TextureBackend;
+
+// Packs the small and medium images into a few large textures, the pages, with imstb_rectpack. The images of a page
+// share its texture, so ImGui merges their draw commands: a window of bitmaps draws in a few commands instead of one
+// per bitmap. Images are added for good, a page is only freed as a whole (see TextureCache::Evict).
+// Used from the UI thread only, between frames like the backend.
+class TextureAtlas {
+public:
+    static constexpr int kPageSize = 2048;
+    // Images larger than this in either dimension get a texture of their own, they would fill pages fast.
+    static constexpr int kMaxImageSize = 256;
+
+    // The packer state of a page, defined with the imstb_rectpack implementation.
+    struct Packer;
+
+    struct Page {
+        Page();
+        ~Page();
+
+        ImTextureID id = nullptr;
+        // Set by the texture cache, which evicts the pages.
+        uint64_t last_used = 0;
+        std::unique_ptr<Packer> packer;
+    };
+
+    // Where an image went.
+    struct Placement {
+        Page* page = nullptr;
+        ImVec2 uv0;
+        ImVec2 uv1;
+    };
+
+    explicit TextureAtlas(TextureBackend& backend) : backend_(backend) {}
+    // Destroys the pages.
+    ~TextureAtlas();
+
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    static bool Fits(int width, int height) { return width > 0 && height > 0 && width <= kMaxImageSize && height <= kMaxImageSize; }
+
+    // Packs the image in the first page with room for it, or a new one, and uploads it there. pixels are as for
+    // TextureBackend::Create, the size must fit. Returns false if a new page was needed and could not be created.
+    bool Add(const uint32_t* pixels, int width, int height, Placement& placement);
+    // Destroys page. The placements in it are left dangling.
+    void Remove(Page* page);
+    void Clear();
+
+    size_t PageCount() const { return pages_.size(); }
+    static constexpr size_t kPageBytes = size_t{ kPageSize } * kPageSize * sizeof(uint32_t);
+
+private:
+    TextureBackend& backend_;
+    std::list<Page> pages_;
+};
+
+}  // namespace falcon_ui
@@ -0,0 +1,277 @@
+#include "TextureCache.h"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <d3d11.h>
+#endif
+
+#include "Tracing.h"
+
+
+namespace falcon_ui {
+
+namespace {
+
+// Transparent in the images with kResourceImageColorKey: magenta.
+constexpr uint16_t kColorKey = 0xF81F;
+
+// The images are RGB565, red in the top bits. The top bits of each channel are repeated in its low ones, so full
+// channels stay full.
+uint32_t ToRgba(uint16_t color, bool color_key) {
+    if (color_key && color == kColorKey) return 0;
+    const uint32_t r = (color >> 11) & 0x1F;
+    const uint32_t g = (color >> 5) & 0x3F;
+    const uint32_t b = color & 0x1F;
+    return ((r << 3) | (r >> 2)) | (((g << 2) | (g >> 4)) << 8) | (((b << 3) | (b >> 2)) << 16) | 0xFF000000u;
+}
+
+uint16_t ReadColor(std::string_view bytes, size_t index) {
+    return static_cast<uint16_t>(static_cast<uint8_t>(bytes[index * 2]) | (static_cast<uint8_t>(bytes[index * 2 + 1]) << 8));
+}
+
+// The RGBA pixels of an image resource. Palette indices past the palette are transparent.
+std::vector<uint32_t> DecodeImage(const Resource& resource) {
+    FALCON_UI_TRACE_SCOPE_DETAIL("DecodeImage", std::string(resource.id));
+    const size_t count = size_t{ static_cast<uint16_t>(resource.width) } * static_cast<uint16_t>(resource.height);
+    const bool color_key = (resource.flags & kResourceImageColorKey) != 0;
+    std::vector<uint32_t> pixels(count);
+    if (resource.flags & kResourceImage16Bit) {
+        for (size_t i = 0; i < count; ++i) pixels[i] = ToRgba(ReadColor(resource.data, i), color_key);
+        return pixels;
+    }
+    uint32_t palette[256] = {};
+    const size_t palette_size = std::min<size_t>(resource.palette.size() / 2, 256);
+    for (size_t i = 0; i < palette_size; ++i) palette[i] = ToRgba(ReadColor(resource.palette, i), color_key);
+    for (size_t i = 0; i < count; ++i) pixels[i] = palette[static_cast<uint8_t>(resource.data[i])];
+    return pixels;
+}
+
+}  // namespace
+
+#ifdef _WIN32
+ImTextureID D3D11TextureBackend::Create(const uint32_t* pixels, int width, int height) {
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = width;
+    desc.Height = height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_IMMUTABLE;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    D3D11_SUBRESOURCE_DATA data = {};
+    data.pSysMem = pixels;
+    data.SysMemPitch = width * 4;
+    ID3D11Texture2D* texture = nullptr;
+    if (FAILED(device_->CreateTexture2D(&desc, &data, &texture))) return nullptr;
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC view_desc = {};
+    view_desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    view_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    view_desc.Texture2D.MipLevels = 1;
+    ID3D11ShaderResourceView* view = nullptr;
+    const auto result = device_->CreateShaderResourceView(texture, &view_desc, &view);
+    // The view holds the texture.
+    texture->Release();
+    return SUCCEEDED(result) ? view : nullptr;
+}
+
+ImTextureID D3D11TextureBackend::CreateDynamic(int width, int height) {
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width = width;
+    desc.Height = height;
+    desc.MipLevels = 1;
+    desc.ArraySize = 1;
+    desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.SampleDesc.Count = 1;
+    desc.Usage = D3D11_USAGE_DEFAULT;
+    desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    const std::vector<uint32_t> transparent(size_t{ static_cast<uint32_t>(width) } * static_cast<uint32_t>(height), 0);
+    D3D11_SUBRESOURCE_DATA data = {};
+    data.pSysMem = transparent.data();
+    data.SysMemPitch = width * 4;
+    ID3D11Texture2D* texture = nullptr;
+    if (FAILED(device_->CreateTexture2D(&desc, &data, &texture))) return nullptr;
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC view_desc = {};
+    view_desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    view_desc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    view_desc.Texture2D.MipLevels = 1;
+    ID3D11ShaderResourceView* view = nullptr;
+    const auto result = device_->CreateShaderResourceView(texture, &view_desc, &view);
+    texture->Release();
+    return SUCCEEDED(result) ? view : nullptr;
+}
+
+void D3D11TextureBackend::Update(ImTextureID texture, int x, int y, const uint32_t* pixels, int width, int height) {
+    ID3D11Resource* resource = nullptr;
+    static_cast<ID3D11ShaderResourceView*>(texture)->GetResource(&resource);
+    const D3D11_BOX box = { static_cast<UINT>(x), static_cast<UINT>(y), 0, static_cast<UINT>(x + width), static_cast<UINT>(y + height), 1 };
+    context_->UpdateSubresource(resource, 0, &box, pixels, width * 4, 0);
+    resource->Release();
+}
+
+void D3D11TextureBackend::Destroy(ImTextureID texture) {
+    static_cast<ID3D11ShaderResourceView*>(texture)->Release();
+}
+#endif
+
+TextureCache::TextureCache(TextureBackend& backend, size_t budget) : backend_(backend), budget_(budget) {}
+
+TextureCache::~TextureCache() {
+    Clear();
+}
+
+void TextureCache::SetArchives(std::vector<std::shared_ptr<const ResourceArchive>> archives) {
+    Clear();
+    archives_ = std::move(archives);
+}
+
+void TextureCache::SetBudget(size_t budget) {
+    budget_ = budget;
+}
+
+void TextureCache::Clear() {
+    const size_t retired = retired_decodes_.size();
+    for (auto& entry : entries_) {
+        // The pages go with the atlas.
+        if (entry.texture.id != nullptr && entry.page == nullptr) backend_.Destroy(entry.texture.id);
+        // Running decodes read the archives, they are not waited for.
+        if (entry.decode.Valid()) {
+            entry.decode.Cancel();
+            retired_decodes_.push_back(std::move(entry.decode));
+        }
+    }
+    if (retired_decodes_.size() > retired) retired_archives_.insert(retired_archives_.end(), archives_.begin(), archives_.end());
+    index_.clear();
+    pending_.clear();
+    entries_.clear();
+    atlas_.Clear();
+    bytes_ = 0;
+    missing_ = 0;
+}
+
+const Texture* TextureCache::Find(std::string_view id) {
+    auto found = index_.find(id);
+    if (found == index_.end()) {
+        entries_.emplace_front();
+        auto& entry = entries_.front();
+        entry.id = id;
+        for (const auto& archive : archives_) {
+            const auto* resource = archive->Find(id);
+            if (resource == nullptr || resource->type != ResourceType::IMAGE) continue;
+            entry.resource = resource;
+            entry.texture.width = resource->width;
+            entry.texture.height = resource->height;
+            entry.decode = JobSystem::Get().Submit(JobPriority::PREVIEW, [resource](const CancellationToken& token) {
+                return token.Cancelled() ? std::vector<uint32_t>() : DecodeImage(*resource);
+            });
+            pending_.push_back(entries_.begin());
+            break;
+        }
+        if (entry.resource == nullptr) ++missing_;
+        found = index_.emplace(entry.id, entries_.begin()).first;
+    } else if (found->second != entries_.begin()) {
+        entries_.splice(entries_.begin(), entries_, found->second);
+    }
+    auto& entry = *found->second;
+    entry.last_used = frame_;
+    if (entry.page != nullptr) entry.page->last_used = frame_;
+    return entry.resource != nullptr ? &entry.texture : nullptr;
+}
+
+void TextureCache::Update() {
+    FALCON_UI_TRACE_SCOPE("TextureCache::Update");
+    size_t uploaded = 0;
+    std::erase_if(pending_, [&](const std::list<Entry>::iterator& entry) {
+        if (uploaded >= kUploadBytesPerFrame || !entry->decode.Ready()) return false;
+        const auto pixels = entry->decode.Get();
+        // Empty images keep their placeholder.
+        if (!pixels.empty()) Upload(*entry, pixels);
+        uploaded += pixels.size() * sizeof(uint32_t);
+        return true;
+    });
+    std::erase_if(retired_decodes_, [](const JobFuture<std::vector<uint32_t>>& decode) { return decode.Ready(); });
+    if (retired_decodes_.empty()) retired_archives_.clear();
+    Evict();
+    ++frame_;
+}
+
+void TextureCache::Upload(Entry& entry, const std::vector<uint32_t>& pixels) {
+    auto& texture = entry.texture;
+    TextureAtlas::Placement placement;
+    if (use_atlas_ && TextureAtlas::Fits(texture.width, texture.height) && atlas_.Add(pixels.data(), texture.width, texture.height, placement)) {
+        entry.page = placement.page;
+        entry.page->last_used = std::max(entry.page->last_used, entry.last_used);
+        texture.id = entry.page->id;
+        texture.uv0 = placement.uv0;
+        texture.uv1 = placement.uv1;
+    } else {
+        texture.id = backend_.Create(pixels.data(), texture.width, texture.height);
+        if (texture.id == nullptr) return;
+        bytes_ += pixels.size() * sizeof(uint32_t);
+    }
+    ++uploads_;
+}
+
+void TextureCache::Evict() {
+    // From the least recently used, up to the ones drawn in the last frame.
+    for (auto entry = entries_.end(); Bytes() > budget_ && entry != entries_.begin();) {
+        --entry;
+        if (entry->last_used == frame_) break;
+        // Waiting for its upload.
+        if (entry->decode.Valid()) continue;
+        if (entry->page != nullptr) {
+            // Kept while another image of its page is in use.
+            if (entry->page->last_used == frame_) continue;
+            EvictPage(entry->page);
+            entry = entries_.end();
+            continue;
+        }
+        if (entry->texture.id != nullptr) {
+            backend_.Destroy(entry->texture.id);
+            bytes_ -= size_t{ static_cast<uint32_t>(entry->texture.width) } * static_cast<uint32_t>(entry->texture.height) * sizeof(uint32_t);
+            ++evictions_;
+        }
+        if (entry->resource == nullptr) --missing_;
+        index_.erase(entry->id);
+        entry = entries_.erase(entry);
+    }
+    // The same for the missing ids, over their count.
+    for (auto entry = entries_.end(); missing_ > kMaxMissingEntries && entry != entries_.begin();) {
+        --entry;
+        if (entry->last_used == frame_) break;
+        if (entry->resource != nullptr) continue;
+        index_.erase(entry->id);
+        entry = entries_.erase(entry);
+        --missing_;
+    }
+}
+
+void TextureCache::EvictPage(TextureAtlas::Page* page) {
+    for (auto entry = entries_.begin(); entry != entries_.end();) {
+        if (entry->page != page) {
+            ++entry;
+            continue;
+        }
+        index_.erase(entry->id);
+        entry = entries_.erase(entry);
+    }
+    atlas_.Remove(page);
+    ++evictions_;
+}
+
+TextureCache::Stats TextureCache::GetStats() const {
+    Stats stats;
+    stats.entries = entries_.size();
+    stats.bytes = Bytes();
+    stats.budget = budget_;
+    stats.pending = pending_.size();
+    stats.uploads = uploads_;
+    stats.evictions = evictions_;
+    stats.atlas_pages = atlas_.PageCount();
+    return stats;
+}
+
+}  // namespace falcon_ui
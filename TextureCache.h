@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "imgui.h"
+#include "JobSystem.h"
+#include "ResourceArchive.h"
+#include "TextureAtlas.h"
+
+#ifdef _WIN32
+struct ID3D11Device;
+struct ID3D11DeviceContext;
+#endif
+
+
+namespace falcon_ui {
+
+// Creates the GPU textures of the cache. Only called from the UI thread, between frames.
+class TextureBackend {
+public:
+    virtual ~TextureBackend() = default;
+
+    // pixels are width x height RGBA colors, 8 bits per channel, row by row from the top. Returns nullptr on failure.
+    virtual ImTextureID Create(const uint32_t* pixels, int width, int height) = 0;
+    // A texture cleared to transparent, whose pixels Update can change (the pages of TextureAtlas).
+    virtual ImTextureID CreateDynamic(int width, int height) = 0;
+    // Copies the width x height pixels to (x, y) of a texture from CreateDynamic.
+    virtual void Update(ImTextureID texture, int x, int y, const uint32_t* pixels, int width, int height) = 0;
+    virtual void Destroy(ImTextureID texture) = 0;
+};
+
+#ifdef _WIN32
+// Immutable D3D11 textures, handed to ImGui as their shader resource view (what imgui_impl_dx11 expects).
+class D3D11TextureBackend final : public TextureBackend {
+public:
+    D3D11TextureBackend(ID3D11Device* device, ID3D11DeviceContext* context) : device_(device), context_(context) {}
+
+    ImTextureID Create(const uint32_t* pixels, int width, int height) override;
+    ImTextureID CreateDynamic(int width, int height) override;
+    void Update(ImTextureID texture, int x, int y, const uint32_t* pixels, int width, int height) override;
+    void Destroy(ImTextureID texture) override;
+
+private:
+    ID3D11Device* device_;
+    ID3D11DeviceContext* context_;
+};
+#endif
+
+// A texture of the cache. Its size is known as soon as the resource is found, its id once it is uploaded: until then
+// the elements draw a placeholder of its size. Images in the atlas share the texture of their page, and are the uv0 to
+// uv1 part of it.
+struct Texture {
+    ImTextureID id = nullptr;
+    int32_t width = 0;
+    int32_t height = 0;
+    ImVec2 uv0{ 0.0f, 0.0f };
+    ImVec2 uv1{ 1.0f, 1.0f };
+};
+
+// The textures of the image resources, by resource id. Find() never blocks: the first time an id is asked for, the image
+// is decoded on a worker (see JobSystem) and the texture is created by the next Update(), at the frame boundary, so the
+// frames go on with placeholders while images decode.
+// The small and medium images are packed in the pages of a TextureAtlas, the others get a texture of their own.
+// The textures are kept within a memory budget, the least recently used ones being destroyed first (a page with all
+// its images). The ones used in the last frame are kept even over the budget, so a window drawing more than the budget
+// does not reload every frame.
+// Used from the UI thread only.
+class TextureCache {
+public:
+    static constexpr size_t kDefaultBudget = 256 * 1024 * 1024;
+
+    struct Stats {
+        // Resource ids asked for, uploaded or not, found or not.
+        size_t entries = 0;
+        // Bytes of the textures and the atlas pages, 4 per pixel.
+        size_t bytes = 0;
+        size_t budget = 0;
+        // Images being decoded or waiting to be uploaded.
+        size_t pending = 0;
+        uint64_t uploads = 0;
+        // Textures and atlas pages destroyed to stay within the budget.
+        uint64_t evictions = 0;
+        size_t atlas_pages = 0;
+    };
+
+    explicit TextureCache(TextureBackend& backend, size_t budget = kDefaultBudget);
+    // Destroys the textures, and waits for the decodes.
+    ~TextureCache();
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    // The archives the images are found in, searched in order. Drops the textures of the previous ones without waiting
+    // for their decodes: those are cancelled and left to finish on the workers, the previous archives being kept until
+    // they do.
+    void SetArchives(std::vector<std::shared_ptr<const ResourceArchive>> archives);
+    void SetBudget(size_t budget);
+    // Whether the small and medium images go to the atlas (the default) or get a texture of their own like the others,
+    // for the benchmarks to compare. Applies to the images uploaded from then on.
+    void SetUseAtlas(bool use_atlas) { use_atlas_ = use_atlas; }
+
+    // The texture of the image resource id, and marks it used in this frame. nullptr if no archive has an image id.
+    const Texture* Find(std::string_view id);
+
+    // To call once per frame before drawing anything: uploads the decoded images (up to kUploadBytesPerFrame, the rest
+    // waits for the next frames), then destroys the least recently used textures over the budget.
+    void Update();
+
+    // True while images decode or wait to be uploaded, for the UI to ask for frames until they show, or while decodes
+    // of previous archives finish (Update releases those archives).
+    bool Pending() const { return !pending_.empty() || !retired_decodes_.empty(); }
+    Stats GetStats() const;
+
+private:
+    // Bytes uploaded by one Update, so a window of large images spreads them over frames instead of stalling one.
+    static constexpr size_t kUploadBytesPerFrame = 16 * 1024 * 1024;
+    // The ids no archive has are kept so they are not searched again every frame. They take no texture memory, so they
+    // are capped by count instead of the budget: the least recently used ones over this are dropped.
+    static constexpr size_t kMaxMissingEntries = 1024;
+
+    struct Entry {
+        std::string id;
+        // Null if no archive has the image.
+        const Resource* resource = nullptr;
+        Texture texture;
+        // Set if the image is in the atlas.
+        TextureAtlas::Page* page = nullptr;
+        // Valid from the request of the image until its upload.
+        JobFuture<std::vector<uint32_t>> decode;
+        uint64_t last_used = 0;
+    };
+
+    void Clear();
+    // Uploads the decoded pixels of entry, to the atlas if they fit.
+    void Upload(Entry& entry, const std::vector<uint32_t>& pixels);
+    void Evict();
+    // Destroys page and drops its images.
+    void EvictPage(TextureAtlas::Page* page);
+    size_t Bytes() const { return bytes_ + atlas_.PageCount() * TextureAtlas::kPageBytes; }
+
+    TextureBackend& backend_;
+    size_t budget_;
+    std::vector<std::shared_ptr<const ResourceArchive>> archives_;
+    // Most recently used first. The map keys view the ids of the entries.
+    std::list<Entry> entries_;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index_;
+    TextureAtlas atlas_{ backend_ };
+    bool use_atlas_ = true;
+    uint64_t frame_ = 0;
+    // Of the textures outside the atlas.
+    size_t bytes_ = 0;
+    // The entries with a decode, in request order.
+    std::vector<std::list<Entry>::iterator> pending_;
+    // The entries without a resource.
+    size_t missing_ = 0;
+    uint64_t uploads_ = 0;
+    uint64_t evictions_ = 0;
+    // The decodes of the entries dropped by Clear, and the archives they read until they finish. Destroyed in reverse
+    // order, the decodes first.
+    std::vector<std::shared_ptr<const ResourceArchive>> retired_archives_;
+    std::vector<JobFuture<std::vector<uint32_t>>> retired_decodes_;
+};
+
+}  // namespace falcon_ui
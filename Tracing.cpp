@@ -0,0 +1,157 @@
+#include "Tracing.h"
+
+#include <cstdio>
+#include <fstream>
+#include <ostream>
+
+
+namespace falcon_ui {
+
+namespace {
+
+// Chrome trace timestamps are in microseconds.
+void WriteMicroseconds(std::ostream& out, int64_t ns) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.3f", ns / 1000.0);
+    out << buffer;
+}
+
+}  // namespace
+
+void WriteJsonString(std::ostream& out, std::string_view text) {
+    out << '"';
+    for (const char c : text) {
+        switch (c) {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\r': out << "\\r"; break;
+        case '\t': out << "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                char buffer[8];
+                snprintf(buffer, sizeof(buffer), "\\u%04x", static_cast<unsigned>(c));
+                out << buffer;
+            } else {
+                out << c;
+            }
+        }
+    }
+    out << '"';
+}
+
+Tracer::Tracer() : epoch_(Clock::now()) {}
+
+Tracer& Tracer::Get() {
+    static Tracer tracer;
+    return tracer;
+}
+
+void Tracer::Start() {
+    {
+        std::lock_guard lock(threads_mutex_);
+        for (auto& thread : threads_) {
+            std::lock_guard thread_lock(thread->mutex);
+            thread->events.clear();
+            thread->dropped = 0;
+        }
+    }
+    active_.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::Stop() {
+    active_.store(false, std::memory_order_relaxed);
+}
+
+Tracer::ThreadBuffer& Tracer::CurrentThread() {
+    // Only the one tracer exists (see Get), so one buffer per thread is enough.
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (buffer == nullptr) {
+        std::lock_guard lock(threads_mutex_);
+        auto& thread = threads_.emplace_back(std::make_unique<ThreadBuffer>());
+        thread->id = static_cast<uint32_t>(threads_.size());
+        buffer = thread.get();
+    }
+    return *buffer;
+}
+
+void Tracer::Add(Event event) {
+    auto& thread = CurrentThread();
+    std::lock_guard lock(thread.mutex);
+    if (thread.events.size() >= kMaxEventsPerThread) {
+        ++thread.dropped;
+        return;
+    }
+    thread.events.push_back(std::move(event));
+}
+
+void Tracer::Span(const char* name, Clock::time_point start, Clock::time_point end, std::string_view detail) {
+    const auto start_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch_).count();
+    const auto duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    Add({ name, 'X', start_ns, duration_ns, 0.0, std::string(detail) });
+}
+
+void Tracer::Counter(const char* name, double value) {
+    const auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch_).count();
+    Add({ name, 'C', now_ns, 0, value, {} });
+}
+
+void Tracer::SetThreadName(std::string_view name) {
+    auto& thread = CurrentThread();
+    std::lock_guard lock(thread.mutex);
+    thread.name = name;
+}
+
+void Tracer::WriteJson(std::ostream& out) const {
+    size_t dropped = 0;
+    bool first = true;
+    const auto begin_event = [&out, &first] {
+        out << (first ? "\n" : ",\n");
+        first = false;
+    };
+
+    out << "{\"traceEvents\":[";
+    std::lock_guard lock(threads_mutex_);
+    for (const auto& thread : threads_) {
+        std::lock_guard thread_lock(thread->mutex);
+        dropped += thread->dropped;
+        if (!thread->name.empty()) {
+            begin_event();
+            out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread->id << ",\"args\":{\"name\":";
+            WriteJsonString(out, thread->name);
+            out << "}}";
+        }
+        for (const auto& event : thread->events) {
+            begin_event();
+            out << "{\"name\":";
+            WriteJsonString(out, event.name);
+            out << ",\"cat\":\"falcon_ui\",\"ph\":\"" << event.type << "\",\"pid\":1,\"tid\":" << thread->id << ",\"ts\":";
+            WriteMicroseconds(out, event.start_ns);
+            if (event.type == 'X') {
+                out << ",\"dur\":";
+                WriteMicroseconds(out, event.duration_ns);
+                if (!event.detail.empty()) {
+                    out << ",\"args\":{\"detail\":";
+                    WriteJsonString(out, event.detail);
+                    out << '}';
+                }
+            } else {
+                // The counter series is named after the counter.
+                out << ",\"args\":{";
+                WriteJsonString(out, event.name);
+                out << ':' << event.value << '}';
+            }
+            out << '}';
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":" << dropped << "}}\n";
+}
+
+bool Tracer::WriteJsonFile(const std::string& path) const {
+    std::ofstream file(path, std::ios::trunc);
+    if (!file) return false;
+    WriteJson(file);
+    return static_cast<bool>(file);
+}
+
+}  // namespace falcon_ui
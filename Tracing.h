@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Set FALCON_UI_TRACING to 0 to compile out all the FALCON_UI_TRACE_* instrumentation. The Tracer itself stays, it then
+// writes empty traces.
+#ifndef FALCON_UI_TRACING
+#define FALCON_UI_TRACING 1
+#endif
+
+
+namespace falcon_ui {
+
+// Records spans and counters from any thread and writes them as Chrome trace event JSON, which chrome://tracing and
+// Perfetto (ui.perfetto.dev) open. Each thread records into its own buffer, so threads only contend when the trace is
+// started or written. While not tracing, an instrumented scope costs one relaxed load.
+class Tracer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Events recorded by a thread past this are dropped (and counted), so a forgotten trace does not eat the memory.
+    static constexpr size_t kMaxEventsPerThread = size_t{ 1 } << 20;
+
+    static Tracer& Get();
+
+    // Starts a new trace, the events of the previous one are discarded.
+    void Start();
+    void Stop();
+    bool Active() const { return active_.load(std::memory_order_relaxed); }
+
+    // name must outlive the tracer (a string literal), detail is copied.
+    void Span(const char* name, Clock::time_point start, Clock::time_point end, std::string_view detail = {});
+    void Counter(const char* name, double value);
+    // Names the calling thread in the trace, works whether tracing or not.
+    void SetThreadName(std::string_view name);
+
+    void WriteJson(std::ostream& out) const;
+    // Returns false if the file could not be written.
+    bool WriteJsonFile(const std::string& path) const;
+
+private:
+    struct Event {
+        const char* name;
+        // 'X' (span) or 'C' (counter).
+        char type;
+        int64_t start_ns;
+        int64_t duration_ns;
+        double value;
+        std::string detail;
+    };
+
+    struct ThreadBuffer {
+        uint32_t id = 0;
+        // Only contended by Start and WriteJson.
+        mutable std::mutex mutex;
+        std::string name;
+        std::vector<Event> events;
+        size_t dropped = 0;
+    };
+
+    Tracer();
+
+    ThreadBuffer& CurrentThread();
+    void Add(Event event);
+
+    std::atomic<bool> active_{ false };
+    Clock::time_point epoch_;
+    mutable std::mutex threads_mutex_;
+    // Kept after their thread exits, for its events.
+    std::vector<std::unique_ptr<ThreadBuffer>> threads_;
+};
+
+// Records its scope as a span, if the tracer is active when the scope starts.
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, std::string_view detail = {})
+        : active_(Tracer::Get().Active()), name_(name) {
+        if (!active_) return;
+        detail_ = detail;
+        start_ = Tracer::Clock::now();
+    }
+    ~TraceScope() {
+        if (active_) Tracer::Get().Span(name_, start_, Tracer::Clock::now(), detail_);
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    bool active_;
+    const char* name_;
+    std::string detail_;
+    Tracer::Clock::time_point start_;
+};
+
+// Writes text as a quoted and escaped JSON string. Shared with the other JSON writers of the editor.
+void WriteJsonString(std::ostream& out, std::string_view text);
+
+}  // namespace falcon_ui
+
+#define FALCON_UI_TRACE_CONCAT_INNER(a, b) a##b
+#define FALCON_UI_TRACE_CONCAT(a, b) FALCON_UI_TRACE_CONCAT_INNER(a, b)
+
+#if FALCON_UI_TRACING
+// Span named name (a string literal) covering the rest of the enclosing scope.
+#define FALCON_UI_TRACE_SCOPE(name) ::falcon_ui::TraceScope FALCON_UI_TRACE_CONCAT(trace_scope_, __LINE__)(name)
+// Same, with a detail (the file, the UI set...) shown in the span arguments.
+#define FALCON_UI_TRACE_SCOPE_DETAIL(name, detail) ::falcon_ui::TraceScope FALCON_UI_TRACE_CONCAT(trace_scope_, __LINE__)(name, detail)
+#define FALCON_UI_TRACE_COUNTER(name, value) \
+    do { if (::falcon_ui::Tracer::Get().Active()) ::falcon_ui::Tracer::Get().Counter(name, static_cast<double>(value)); } while (false)
+#define FALCON_UI_TRACE_THREAD_NAME(name) ::falcon_ui::Tracer::Get().SetThreadName(name)
+#else
+#define FALCON_UI_TRACE_SCOPE(name) static_cast<void>(0)
+#define FALCON_UI_TRACE_SCOPE_DETAIL(name, detail) static_cast<void>(0)
+#define FALCON_UI_TRACE_COUNTER(name, value) static_cast<void>(0)
+#define FALCON_UI_TRACE_THREAD_NAME(name) static_cast<void>(0)
+#endif
@@ -0,0 +1,134 @@
+#include "TreeDiff.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "Tracing.h"
+
+
+namespace falcon_ui {
+
+namespace {
+
+constexpr uint32_t kMaxRank = (1u << 24) - 1;
+
+// The label of the [SETUP] of element, kNoSymbol if it has none.
+SymbolId Label(const WindowModel& model, const ElementRecord& element) {
+    for (const auto& attribute : model.attributes.subspan(element.first_attribute, element.attribute_count)) {
+        if (attribute.tag == Tag::SETUP) return attribute.setup.label;
+    }
+    return kNoSymbol;
+}
+
+// Keys of the elements of model: label, tag and rank among the elements with the same label and tag, so the third
+// NID bitmap of both versions are matched together.
+std::vector<uint64_t> ElementKeys(const WindowModel& model) {
+    std::vector<uint64_t> keys;
+    keys.reserve(model.elements.size());
+    std::unordered_map<uint64_t, uint32_t> ranks;
+    for (const auto& element : model.elements) {
+        const uint64_t base = (uint64_t{ Label(model, element) } << 32) | (uint64_t{ static_cast<uint8_t>(element.tag) } << 24);
+        const auto rank = std::min(ranks[base]++, kMaxRank);
+        keys.push_back(base | rank);
+    }
+    return keys;
+}
+
+std::string WindowKey(const std::string& window_path) {
+    std::string key = window_path;
+    std::transform(key.begin(), key.end(), key.begin(), [](char c) {
+        if (c == '/') return '\\';
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c | 0x20) : c;
+    });
+    return key;
+}
+
+// Window paths to their first index in windows.
+std::unordered_map<std::string, size_t> WindowsByKey(const std::vector<LoadedWindow>& windows) {
+    std::unordered_map<std::string, size_t> by_key;
+    by_key.reserve(windows.size());
+    for (size_t i = 0; i < windows.size(); ++i) {
+        by_key.try_emplace(WindowKey(windows[i].window_path), i);
+    }
+    return by_key;
+}
+
+// Windows which did not parse have no hash, their bytes are compared.
+bool SameWindow(const Window& left, const Window& right) {
+    const auto& left_elements = left.Model().elements;
+    const auto& right_elements = right.Model().elements;
+    if (left_elements.empty() || right_elements.empty()) return left_elements.empty() && right_elements.empty() && left.Source() == right.Source();
+    return left_elements.front().hash == right_elements.front().hash;
+}
+
+// Hash of element without its children.
+uint64_t OwnHash(const Window& window, size_t element) {
+    const auto& model = window.Model();
+    const auto& record = model.elements[element];
+    return HashElement(record.tag, model.attributes.subspan(record.first_attribute, record.attribute_count), window.Source());
+}
+
+}  // namespace
+
+std::vector<ElementDiff> DiffWindows(const Window& left_window, const Window& right_window) {
+    std::vector<ElementDiff> diffs;
+    const auto& left = left_window.Model();
+    const auto& right = right_window.Model();
+    if (!left.elements.empty() && !right.elements.empty() && left.elements.front().hash == right.elements.front().hash) return diffs;
+
+    const auto left_keys = ElementKeys(left);
+    const auto right_keys = ElementKeys(right);
+    std::unordered_map<uint64_t, uint32_t> right_by_key;
+    right_by_key.reserve(right_keys.size());
+    for (uint32_t i = 0; i < right_keys.size(); ++i) right_by_key.try_emplace(right_keys[i], i);
+
+    std::vector<bool> matched(right_keys.size());
+    for (uint32_t i = 0; i < left_keys.size(); ++i) {
+        const auto it = right_by_key.find(left_keys[i]);
+        if (it == right_by_key.end()) {
+            diffs.push_back({ DiffKind::REMOVED, i, ElementDiff::kNone });
+            continue;
+        }
+        matched[it->second] = true;
+        // The hash of the root covers the children, which are compared on their own: only its own content matters.
+        const bool root = i == 0 && it->second == 0;
+        const bool changed = root ? OwnHash(left_window, 0) != OwnHash(right_window, 0) : left.elements[i].hash != right.elements[it->second].hash;
+        if (changed) diffs.push_back({ DiffKind::CHANGED, i, it->second });
+    }
+    for (uint32_t i = 0; i < right_keys.size(); ++i) {
+        if (!matched[i]) diffs.push_back({ DiffKind::ADDED, ElementDiff::kNone, i });
+    }
+    return diffs;
+}
+
+TreeDiff DiffTrees(const BulkLoadResult& left, const BulkLoadResult& right) {
+    FALCON_UI_TRACE_SCOPE("DiffTrees");
+    TreeDiff diff;
+    const auto left_by_key = WindowsByKey(left.windows);
+    const auto right_by_key = WindowsByKey(right.windows);
+    for (const auto& [key, left_index] : left_by_key) {
+        const auto it = right_by_key.find(key);
+        if (it == right_by_key.end()) {
+            diff.windows.push_back({ DiffKind::REMOVED, key, left_index, WindowDiff::kNone, {} });
+            continue;
+        }
+        const auto& left_window = left.windows[left_index].window;
+        const auto& right_window = right.windows[it->second].window;
+        if (SameWindow(left_window, right_window)) {
+            ++diff.identical_windows;
+            continue;
+        }
+        WindowDiff window{ DiffKind::CHANGED, key, left_index, it->second, {} };
+        if (!left_window.Model().elements.empty() && !right_window.Model().elements.empty()) {
+            window.elements = DiffWindows(left_window, right_window);
+        }
+        diff.windows.push_back(std::move(window));
+    }
+    for (const auto& [key, right_index] : right_by_key) {
+        if (!left_by_key.contains(key)) diff.windows.push_back({ DiffKind::ADDED, key, WindowDiff::kNone, right_index, {} });
+    }
+    std::sort(diff.windows.begin(), diff.windows.end(), [](const WindowDiff& a, const WindowDiff& b) { return a.window_path < b.window_path; });
+    return diff;
+}
+
+}  // namespace falcon_ui
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "BulkLoader.h"
+#include "ScfRecords.h"
+
+
+namespace falcon_ui {
+
+enum class DiffKind : uint8_t {
+    ADDED,
+    REMOVED,
+    CHANGED,
+};
+
+// An element which differs between two versions of a window. Indices are in the elements of the window models.
+struct ElementDiff {
+    static constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+    DiffKind kind;
+    // kNone for added elements.
+    uint32_t left;
+    // kNone for removed elements.
+    uint32_t right;
+};
+
+// A window which differs between two trees.
+struct WindowDiff {
+    static constexpr size_t kNone = std::numeric_limits<size_t>::max();
+
+    DiffKind kind;
+    // Lower case window path, relative to the theater data dir as in the window lists.
+    std::string window_path;
+    // Indices in the windows of the load results, kNone on the side the window is missing from.
+    size_t left;
+    size_t right;
+    // For changed windows which parsed on both sides, empty otherwise.
+    std::vector<ElementDiff> elements;
+};
+
+struct TreeDiff {
+    // Sorted by path.
+    std::vector<WindowDiff> windows;
+    // Windows in both trees with the same hash, which were skipped.
+    size_t identical_windows = 0;
+};
+
+// Elements added, removed and changed from left to right, in left order then the added ones in right order.
+// Elements are matched by tag, label and rank among the elements with the same tag and label, and compared by hash.
+// Returns nothing without looking at the elements if the root hashes are equal.
+std::vector<ElementDiff> DiffWindows(const Window& left, const Window& right);
+
+// Windows added, removed and changed from left to right (two theaters, or two installations), matched by window path.
+// Linear in the number of windows, and windows with the same root hash cost one comparison.
+TreeDiff DiffTrees(const BulkLoadResult& left, const BulkLoadResult& right);
+
+}  // namespace falcon_ui
@@ -0,0 +1,126 @@
+#include "UsagesPanel.h"
+
+#include "BulkLoader.h"
+#include "imgui.h"
+#include "ScfTokenizer.h"
+#include "Tracing.h"
+
+
+namespace falcon_ui {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const char* SymbolUseName(SymbolUse use) {
+    switch (use) {
+        case SymbolUse::LABEL: return "Label";
+        case SymbolUse::BITMAP: return "Bitmap";
+        case SymbolUse::SOUND: return "Sound";
+        case SymbolUse::CURSOR: return "Cursor";
+    }
+    return "";
+}
+
+}  // namespace
+
+void UsagesPanel::IndexInstallation(const std::string& install_dir) {
+    if (Indexing()) return;
+    indexed_dir_ = install_dir;
+    index_start_ = Clock::now();
+    pending_ = JobSystem::Get().Submit(JobPriority::BACKGROUND, [install_dir, cache = cache_](const CancellationToken& token) {
+        BulkLoadOptions options;
+        options.cache = cache;
+        options.cancel = token;
+        // The windows are only needed for indexing, they are released right after.
+        const auto windows = LoadInstallation(install_dir, options);
+        auto index = std::make_unique<SymbolIndex>();
+        index->Add(*windows);
+        return index;
+    });
+}
+
+void UsagesPanel::FinishIndexing() {
+    if (!pending_.Ready()) return;
+    index_ = pending_.Get();
+    index_time_ = Clock::now() - index_start_;
+    if (watcher_ == nullptr) return;
+    for (size_t file = 0; file < index_->FileCount(); ++file) {
+        watcher_->Watch(index_->FilePath(static_cast<uint32_t>(file)));
+    }
+}
+
+bool UsagesPanel::OnFileChanged(const std::string& path) {
+    if (index_ == nullptr || !index_->Contains(path)) return false;
+    Window window;
+    if (cache_ != nullptr) {
+        cache_->Load(path, window);
+    } else {
+        window.SetupFromFile(path);
+    }
+    // A half saved file keeps the references of its last good version.
+    if (window.Good()) index_->Update(path, window);
+    return true;
+}
+
+void UsagesPanel::Draw(bool* open, const std::string& install_dir) {
+    FinishIndexing();
+    if (!ImGui::Begin("Find Usages", open)) {
+        ImGui::End();
+        return;
+    }
+
+    ImGui::BeginDisabled(install_dir.empty() || Indexing());
+    if (ImGui::Button("Index Installation")) IndexInstallation(install_dir);
+    ImGui::EndDisabled();
+    ImGui::SameLine();
+    if (Indexing()) {
+        ImGui::Text("Indexing %s...", indexed_dir_.c_str());
+    } else if (index_ != nullptr) {
+        ImGui::Text("%zu files, %zu references, indexed in %.0f ms", index_->FileCount(), index_->ReferenceCount(), std::chrono::duration<double, std::milli>(index_time_).count());
+    } else {
+        ImGui::TextUnformatted("Nothing indexed");
+    }
+
+    ImGui::InputText("Label, bitmap, sound or cursor", query_.data(), query_.size());
+    const auto query = Tokenizer::Trim(query_.data());
+    if (index_ == nullptr || query.empty()) {
+        ImGui::End();
+        return;
+    }
+
+    const auto start = Clock::now();
+    const auto usages = index_->Usages(query);
+    const auto lookup_time = Clock::now() - start;
+    ImGui::Text("%zu usages, found in %.1f us", usages.size(), std::chrono::duration<double, std::micro>(lookup_time).count());
+
+    if (!usages.empty() && ImGui::BeginTable("Usages", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY)) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("File");
+        ImGui::TableSetupColumn("Element", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Line", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Use", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableHeadersRow();
+        // Common labels are used thousands of times, only the visible rows are drawn.
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(usages.size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                const auto& usage = usages[row];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(index_->FilePath(usage.file).c_str());
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", usage.element);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", usage.line);
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(SymbolUseName(usage.use));
+            }
+        }
+        ImGui::EndTable();
+    }
+    ImGui::End();
+}
+
+}  // namespace falcon_ui
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "FileWatcher.h"
+#include "JobSystem.h"
+#include "ModelCache.h"
+#include "SymbolIndex.h"
+
+
+namespace falcon_ui {
+
+// ImGui window to find the usages of a label, bitmap, sound or cursor in all the windows of an installation.
+// The installation is loaded and indexed on background threads, then its files are watched and re-indexed one by one
+// when they change. Used from the UI thread.
+class UsagesPanel {
+public:
+    // watcher and cache are optional, and must outlive the panel.
+    UsagesPanel(FileWatcher* watcher, ModelCache* cache) : watcher_(watcher), cache_(cache) {}
+
+    // Indexes all windows of all theaters of install_dir, replacing the current index once done.
+    void IndexInstallation(const std::string& install_dir);
+    // True while an installation is being indexed, the UI must keep drawing frames to pick up the result.
+    bool Indexing() const { return pending_.Valid(); }
+
+    // Re-indexes path (a change from FileWatcher::PollChanges) if it is indexed. Returns true if it was.
+    bool OnFileChanged(const std::string& path);
+
+    // install_dir is the installation the index button indexes, none if empty.
+    void Draw(bool* open, const std::string& install_dir);
+
+private:
+    // Swaps in the index built in the background, if it is done.
+    void FinishIndexing();
+
+    FileWatcher* watcher_;
+    ModelCache* cache_;
+    std::unique_ptr<SymbolIndex> index_;
+    // The index being built. Its destructor cancels the build and waits for it.
+    JobFuture<std::unique_ptr<SymbolIndex>> pending_;
+    std::string indexed_dir_;
+    std::chrono::nanoseconds index_time_{};
+    std::chrono::steady_clock::time_point index_start_;
+    std::array<char, 256> query_{};
+};
+
+}  // namespace falcon_ui
@@ -0,0 +1,478 @@
+#include "Validation.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <ostream>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include "ParallelFor.h"
+#include "ScfSchema.h"
+#include "Tracing.h"
+
+
+namespace falcon_ui {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// A window being validated, with the lookups the validators share.
+class WindowContext {
+public:
+    WindowContext(const Window& window, const std::string& path)
+        : window_(window), model_(window.Model()), source_(window.Source()), path_(path) {}
+
+    const Window& GetWindow() const { return window_; }
+    const WindowModel& Model() const { return model_; }
+    std::string_view Source() const { return source_; }
+    const std::string& Path() const { return path_; }
+
+    // 1 based line of the byte at offset of the source.
+    uint32_t Line(size_t offset) const {
+        if (newlines_.empty()) {
+            for (size_t i = source_.find('\n'); i != std::string_view::npos; i = source_.find('\n', i + 1)) newlines_.push_back(i);
+            // Marks the table as built for sources without newlines.
+            newlines_.push_back(source_.size());
+        }
+        return static_cast<uint32_t>(std::lower_bound(newlines_.begin(), newlines_.end(), offset) - newlines_.begin()) + 1;
+    }
+
+    // Line of the tag of element, after its comments. 0 for new elements, which have no source.
+    uint32_t ElementLine(uint32_t element) const {
+        const auto span = model_.elements[element].source;
+        Tokenizer tokenizer(Resolve(source_, span));
+        while (tokenizer.NextLine()) {
+            const auto line = tokenizer.Line();
+            if (!line.empty() && !Tokenizer::IsComment(line)) return Line(span.offset + tokenizer.LineOffset());
+        }
+        return 0;
+    }
+
+    std::span<const AttributeRecord> Attributes(uint32_t element) const {
+        const auto& record = model_.elements[element];
+        return model_.attributes.subspan(record.first_attribute, record.attribute_count);
+    }
+
+    // The [SETUP] of element, if it is the first attribute, as FalconWindow.cpp sets elements up.
+    const SetupRecord* Setup(uint32_t element) const {
+        const auto attributes = Attributes(element);
+        if (attributes.empty() || attributes.front().tag != Tag::SETUP) return nullptr;
+        return &attributes.front().setup;
+    }
+
+    // True if the window did not load because its file does not exist.
+    bool FileMissing() const {
+        std::error_code error;
+        return !window_.Good() && source_.empty() && !std::filesystem::exists(path_, error);
+    }
+
+    void Add(std::vector<ValidationIssue>& issues, Check check, Severity severity, uint32_t element, std::string message) const {
+        const auto line = element == ValidationIssue::kNoElement ? 0 : ElementLine(element);
+        issues.push_back({ check, severity, element, line, std::move(message) });
+    }
+
+private:
+    const Window& window_;
+    const WindowModel& model_;
+    std::string_view source_;
+    const std::string& path_;
+    // Offsets of the '\n' of the source, built on the first Line().
+    mutable std::vector<size_t> newlines_;
+};
+
+// Where an element is, in window coordinates. w and h are 0 when the element does not give its size.
+struct ElementRect {
+    int32_t x = 0;
+    int32_t y = 0;
+    int32_t w = 0;
+    int32_t h = 0;
+};
+
+// The rectangle of a child element: [XYWH], or [XY], or the [SETUP] values (x y, plus w h for some controls).
+std::optional<ElementRect> RectOf(const WindowContext& context, uint32_t element) {
+    std::optional<ElementRect> rect;
+    if (const auto* setup = context.Setup(element); setup != nullptr && setup->int_count >= 2) {
+        rect = ElementRect{ setup->ints[0], setup->ints[1] };
+        if (setup->int_count >= 4) {
+            rect->w = setup->ints[2];
+            rect->h = setup->ints[3];
+        }
+    }
+    for (const auto& attribute : context.Attributes(element)) {
+        if (attribute.tag == Tag::XYWH) return ElementRect{ attribute.xywh.x, attribute.xywh.y, attribute.xywh.w, attribute.xywh.h };
+        if (attribute.tag == Tag::XY) rect = ElementRect{ attribute.xy.x, attribute.xy.y, rect ? rect->w : 0, rect ? rect->h : 0 };
+    }
+    return rect;
+}
+
+std::string Format(const char* format, auto... args) {
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), format, args...);
+    return buffer;
+}
+
+//-----------
+// Validators
+//-----------
+
+void ValidateBounds(const WindowContext& context, std::vector<ValidationIssue>& issues) {
+    const auto& model = context.Model();
+    if (model.elements.empty() || model.elements.front().tag != Tag::WINDOW) return;
+    const auto* setup = context.Setup(0);
+    if (setup == nullptr || setup->int_count < 2) {
+        context.Add(issues, Check::BOUNDS, Severity::FAILURE, 0, "the window [SETUP] has no width and height");
+        return;
+    }
+    const int32_t width = setup->ints[0];
+    const int32_t height = setup->ints[1];
+    const bool window_good = width > 0 && height > 0 && width < kMaxX && height < kMaxY;
+    if (!window_good) {
+        context.Add(issues, Check::BOUNDS, Severity::FAILURE, 0, Format("window size %dx%d is not between 1x1 and %dx%d", width, height, kMaxX - 1, kMaxY - 1));
+    }
+    for (uint32_t i = 1; i < model.elements.size(); ++i) {
+        const auto rect = RectOf(context, i);
+        if (!rect.has_value()) continue;
+        if (rect->x <= -kMaxX || rect->y <= -kMaxY || rect->x >= kMaxX || rect->y >= kMaxY) {
+            context.Add(issues, Check::BOUNDS, Severity::FAILURE, i, Format("position %d,%d is out of range, the element is not set up", rect->x, rect->y));
+        } else if (!window_good) {
+            continue;
+        } else if (rect->x < 0 || rect->y < 0 || rect->x >= width || rect->y >= height) {
+            context.Add(issues, Check::BOUNDS, Severity::WARNING, i, Format("position %d,%d is outside the %dx%d window", rect->x, rect->y, width, height));
+        } else if (int64_t{ rect->x } + rect->w > width || int64_t{ rect->y } + rect->h > height) {
+            context.Add(issues, Check::BOUNDS, Severity::WARNING, i, Format("%dx%d at %d,%d extends past the %dx%d window", rect->w, rect->h, rect->x, rect->y, width, height));
+        }
+    }
+}
+
+// Calls on_line(line, check, message) for each line the parser rejected: the lines it skipped for windows which parsed,
+// all the bad lines for the others (the parser stops at the first one, this goes on to report them all).
+template <typename Function>
+void ForEachBadLine(const WindowContext& context, const Function& on_line) {
+    const auto source = context.Source();
+    if (!context.Model().elements.empty()) {
+        for (const auto& skipped : context.Model().skipped) {
+            on_line(context.Line(skipped.offset), Check::SCHEMA, "invalid arguments for " + std::string(Tokenizer::Tag(Resolve(source, skipped))));
+        }
+        return;
+    }
+    Tokenizer tokenizer(source);
+    bool in_element = false;
+    while (tokenizer.NextLine()) {
+        const auto line = tokenizer.Line();
+        if (line.empty() || Tokenizer::IsComment(line)) continue;
+        if (const auto* spec = FindTag(line); spec != nullptr && spec->starts_element) {
+            in_element = true;
+            continue;
+        }
+        const auto line_number = context.Line(tokenizer.LineOffset());
+        const auto tag = Tokenizer::Tag(line);
+        const auto* spec = FindTag(tag);
+        if (spec == nullptr) {
+            on_line(line_number, Check::UNKNOWN_TAG, tag.empty() ? std::string("line does not start with a tag") : "unknown tag " + std::string(tag));
+        } else if (!in_element) {
+            on_line(line_number, Check::SCHEMA, std::string(tag) + " before the first element");
+        } else if (!DecodeAttribute(line, source).has_value()) {
+            on_line(line_number, Check::SCHEMA, "invalid arguments for " + std::string(tag));
+        }
+    }
+}
+
+void ValidateUnknownTags(const WindowContext& context, std::vector<ValidationIssue>& issues) {
+    ForEachBadLine(context, [&issues](uint32_t line, Check check, std::string message) {
+        if (check == Check::UNKNOWN_TAG) issues.push_back({ check, Severity::FAILURE, ValidationIssue::kNoElement, line, std::move(message) });
+    });
+}
+
+void ValidateSchema(const WindowContext& context, std::vector<ValidationIssue>& issues) {
+    // Missing files are reported as missing assets.
+    if (context.FileMissing()) return;
+    bool bad_lines = false;
+    ForEachBadLine(context, [&issues, &bad_lines](uint32_t line, Check check, std::string message) {
+        bad_lines = true;
+        if (check == Check::SCHEMA) issues.push_back({ check, Severity::FAILURE, ValidationIssue::kNoElement, line, std::move(message) });
+    });
+    const auto& elements = context.Model().elements;
+    if (!elements.empty() && elements.front().tag != Tag::WINDOW) {
+        context.Add(issues, Check::SCHEMA, Severity::FAILURE, 0, "the first element is " + std::string(SpecForTag(elements.front().tag)->name) + ", not [WINDOW]");
+    } else if (elements.empty() && !bad_lines) {
+        issues.push_back({ Check::SCHEMA, Severity::FAILURE, ValidationIssue::kNoElement, 0, "no [WINDOW] element" });
+    }
+}
+
+void ValidateMissingAssets(const WindowContext& context, std::vector<ValidationIssue>& issues) {
+    if (context.FileMissing()) {
+        issues.push_back({ Check::MISSING_ASSET, Severity::FAILURE, ValidationIssue::kNoElement, 0, "file listed in the window list not found" });
+        return;
+    }
+    // The resources themselves are in the resource files, only their presence is checked.
+    const auto& model = context.Model();
+    for (uint32_t i = 1; i < model.elements.size(); ++i) {
+        const auto tag = model.elements[i].tag;
+        if (tag != Tag::BITMAP && tag != Tag::TILE) continue;
+        bool has_resource = false;
+        for (const auto& attribute : context.Attributes(i)) {
+            if (attribute.tag == Tag::SETUP) has_resource |= !attribute.setup.resource.empty();
+            if (attribute.tag == Tag::BITMAP || attribute.tag == Tag::TILE) has_resource |= !attribute.text.text.empty();
+        }
+        if (!has_resource) {
+            context.Add(issues, Check::MISSING_ASSET, Severity::WARNING, i, std::string(SpecForTag(tag)->name) + " element without a resource");
+        }
+    }
+}
+
+void ValidateDuplicateLabels(const WindowContext& context, std::vector<ValidationIssue>& issues) {
+    const auto& model = context.Model();
+    auto& symbols = SymbolTable::Global();
+    const auto no_id = symbols.Find("NID");
+    std::unordered_map<SymbolId, uint32_t> first_use;
+    for (uint32_t i = 0; i < model.elements.size(); ++i) {
+        const auto* setup = context.Setup(i);
+        if (setup == nullptr || setup->label == kNoSymbol || setup->label == no_id) continue;
+        const auto [it, added] = first_use.try_emplace(setup->label, i);
+        if (added) continue;
+        context.Add(issues, Check::DUPLICATE_LABEL, Severity::FAILURE, i,
+            Format("label %s is already used by element %u (line %u)", std::string(symbols.Name(setup->label)).c_str(), it->second, context.ElementLine(it->second)));
+    }
+}
+
+void ValidateOverlap(const WindowContext& context, std::vector<ValidationIssue>& issues) {
+    struct Button {
+        uint32_t element;
+        ElementRect rect;
+    };
+    const auto& model = context.Model();
+    std::vector<Button> buttons;
+    for (uint32_t i = 1; i < model.elements.size(); ++i) {
+        if (model.elements[i].tag != Tag::BUTTON) continue;
+        const auto rect = RectOf(context, i);
+        if (rect.has_value() && rect->w > 0 && rect->h > 0) buttons.push_back({ i, *rect });
+    }
+    // Sweep along x: each button is only compared with the previous ones still open at its left edge.
+    std::sort(buttons.begin(), buttons.end(), [](const Button& a, const Button& b) { return a.rect.x < b.rect.x; });
+    std::vector<const Button*> open;
+    for (const auto& button : buttons) {
+        std::erase_if(open, [&button](const Button* other) { return int64_t{ other->rect.x } + other->rect.w <= button.rect.x; });
+        for (const auto* other : open) {
+            if (int64_t{ other->rect.y } + other->rect.h <= button.rect.y || int64_t{ button.rect.y } + button.rect.h <= other->rect.y) continue;
+            const auto& [first, second] = other->element < button.element ? std::pair(other, &button) : std::pair(&button, other);
+            context.Add(issues, Check::OVERLAP, Severity::WARNING, second->element,
+                Format("overlaps button %u (line %u)", first->element, context.ElementLine(first->element)));
+        }
+        open.push_back(&button);
+    }
+}
+
+using ValidatorFunction = void (*)(const WindowContext& context, std::vector<ValidationIssue>& issues);
+
+struct Validator {
+    Check check;
+    std::string_view name;
+    ValidatorFunction function;
+};
+
+// In Check order. Adding a check is adding an entry to Check and a line here.
+constexpr std::array<Validator, kCheckCount> kValidators = { {
+    { Check::BOUNDS, "bounds", ValidateBounds },
+    { Check::UNKNOWN_TAG, "unknown_tag", ValidateUnknownTags },
+    { Check::SCHEMA, "schema", ValidateSchema },
+    { Check::MISSING_ASSET, "missing_asset", ValidateMissingAssets },
+    { Check::DUPLICATE_LABEL, "duplicate_label", ValidateDuplicateLabels },
+    { Check::OVERLAP, "overlap", ValidateOverlap },
+} };
+
+constexpr bool ValidatorsInCheckOrder() {
+    for (size_t i = 0; i < kValidators.size(); ++i) {
+        if (static_cast<size_t>(kValidators[i].check) != i) return false;
+    }
+    return true;
+}
+static_assert(ValidatorsInCheckOrder());
+
+// Key of a window file, the same for the loads of the file through different lists.
+std::string FileKey(const std::string& path) {
+    std::string key = path;
+    std::transform(key.begin(), key.end(), key.begin(), [](char c) {
+        if (c == '\\') return '/';
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c | 0x20) : c;
+    });
+    return key;
+}
+
+//--------
+// Reports
+//--------
+
+double Seconds(std::chrono::nanoseconds time) {
+    return std::chrono::duration<double>(time).count();
+}
+
+void WriteXmlText(std::ostream& out, std::string_view text) {
+    for (const char c : text) {
+        switch (c) {
+        case '<': out << "&lt;"; break;
+        case '>': out << "&gt;"; break;
+        case '&': out << "&amp;"; break;
+        case '"': out << "&quot;"; break;
+        default:
+            // Control characters are not allowed in XML 1.0.
+            if (static_cast<unsigned char>(c) >= 0x20 || c == '\n' || c == '\t') out << c;
+        }
+    }
+}
+
+}  // namespace
+
+std::string_view CheckName(Check check) {
+    return kValidators[static_cast<size_t>(check)].name;
+}
+
+std::optional<Check> CheckFromName(std::string_view name) {
+    for (const auto& validator : kValidators) {
+        if (validator.name == name) return validator.check;
+    }
+    return std::nullopt;
+}
+
+std::string_view SeverityName(Severity severity) {
+    return severity == Severity::FAILURE ? "error" : "warning";
+}
+
+std::vector<ValidationIssue> ValidateWindow(const Window& window, const std::string& path, uint32_t checks) {
+    FALCON_UI_TRACE_SCOPE_DETAIL("ValidateWindow", path);
+    std::vector<ValidationIssue> issues;
+    const WindowContext context(window, path);
+    for (const auto& validator : kValidators) {
+        if ((checks >> static_cast<uint32_t>(validator.check)) & 1) validator.function(context, issues);
+    }
+    std::stable_sort(issues.begin(), issues.end(), [](const ValidationIssue& a, const ValidationIssue& b) { return a.line < b.line; });
+    return issues;
+}
+
+ValidationReport Validate(std::shared_ptr<const BulkLoadResult> load, const ValidationOptions& options) {
+    FALCON_UI_TRACE_SCOPE("Validate");
+    ValidationReport report;
+    const auto& windows = load->windows;
+    {
+        std::unordered_map<std::string, size_t> seen;
+        seen.reserve(windows.size());
+        for (size_t i = 0; i < windows.size(); ++i) {
+            if (seen.try_emplace(FileKey(windows[i].full_path), i).second) report.files.push_back({ i, {} });
+        }
+    }
+
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    report.thread_count = static_cast<unsigned>(std::min<size_t>(options.thread_count != 0 ? options.thread_count : cores, std::max<size_t>(report.files.size(), 1)));
+    const auto start = Clock::now();
+    ParallelFor(report.files.size(), report.thread_count, "Validator", [&report, &windows, &options](size_t i, unsigned) {
+        auto& file = report.files[i];
+        const auto& window = windows[file.window];
+        file.issues = ValidateWindow(window.window, window.full_path, options.checks);
+    });
+    report.wall_time = Clock::now() - start;
+
+    for (const auto& file : report.files) {
+        for (const auto& issue : file.issues) {
+            ++(issue.severity == Severity::FAILURE ? report.errors : report.warnings);
+        }
+    }
+    report.load = std::move(load);
+    return report;
+}
+
+void WriteIssue(std::ostream& out, const std::string& path, const ValidationIssue& issue) {
+    out << path;
+    if (issue.line != 0) out << ':' << issue.line;
+    out << ": " << SeverityName(issue.severity) << ": " << issue.message << " [" << CheckName(issue.check) << "]\n";
+}
+
+void WriteTextReport(const ValidationReport& report, std::ostream& out) {
+    for (const auto& file : report.files) {
+        for (const auto& issue : file.issues) WriteIssue(out, report.load->windows[file.window].full_path, issue);
+    }
+}
+
+void WriteJsonReport(const ValidationReport& report, std::ostream& out) {
+    const auto& windows = report.load->windows;
+    out << "{\"summary\":{\"windows\":" << windows.size() << ",\"files\":" << report.files.size()
+        << ",\"errors\":" << report.errors << ",\"warnings\":" << report.warnings
+        << ",\"load_seconds\":" << Seconds(report.load->wall_time) << ",\"validate_seconds\":" << Seconds(report.wall_time)
+        << ",\"threads\":" << report.thread_count << "},\n\"files\":[";
+    // Only the files with issues, a clean installation gives a short report.
+    bool first_file = true;
+    for (const auto& file : report.files) {
+        if (file.issues.empty()) continue;
+        const auto& window = windows[file.window];
+        out << (first_file ? "\n" : ",\n") << "{\"path\":";
+        first_file = false;
+        WriteJsonString(out, window.full_path);
+        out << ",\"theater\":";
+        WriteJsonString(out, window.theater);
+        out << ",\"ui_set\":";
+        WriteJsonString(out, window.ui_set);
+        out << ",\"window\":";
+        WriteJsonString(out, window.window_path);
+        out << ",\"issues\":[";
+        for (size_t i = 0; i < file.issues.size(); ++i) {
+            const auto& issue = file.issues[i];
+            out << (i == 0 ? "" : ",") << "{\"check\":\"" << CheckName(issue.check) << "\",\"severity\":\"" << SeverityName(issue.severity) << '"';
+            if (issue.element != ValidationIssue::kNoElement) out << ",\"element\":" << issue.element;
+            out << ",\"line\":" << issue.line << ",\"message\":";
+            WriteJsonString(out, issue.message);
+            out << '}';
+        }
+        out << "]}";
+    }
+    out << "\n]}\n";
+}
+
+void WriteJUnitReport(const ValidationReport& report, std::ostream& out) {
+    const auto& windows = report.load->windows;
+    size_t failures = 0;
+    for (const auto& file : report.files) {
+        failures += std::any_of(file.issues.begin(), file.issues.end(), [](const ValidationIssue& issue) { return issue.severity == Severity::FAILURE; });
+    }
+    out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    out << "<testsuites name=\"falcon_ui_validate\" tests=\"" << report.files.size() << "\" failures=\"" << failures
+        << "\" time=\"" << Seconds(report.load->wall_time + report.wall_time) << "\">\n";
+    out << "<testsuite name=\"windows\" tests=\"" << report.files.size() << "\" failures=\"" << failures << "\">\n";
+    for (const auto& file : report.files) {
+        const auto& window = windows[file.window];
+        out << "<testcase classname=\"";
+        WriteXmlText(out, window.theater + "." + window.ui_set);
+        out << "\" name=\"";
+        WriteXmlText(out, window.window_path);
+        out << "\" time=\"" << Seconds(window.load_time) << '"';
+        if (file.issues.empty()) {
+            out << "/>\n";
+            continue;
+        }
+        out << ">\n";
+        // Errors fail the test case, warnings only show in its output.
+        std::string errors, warnings;
+        size_t error_count = 0;
+        for (const auto& issue : file.issues) {
+            std::ostringstream line;
+            WriteIssue(line, window.full_path, issue);
+            (issue.severity == Severity::FAILURE ? errors : warnings) += line.str();
+            error_count += issue.severity == Severity::FAILURE;
+        }
+        if (error_count > 0) {
+            out << "<failure message=\"" << error_count << " error(s)\" type=\"validation\">";
+            WriteXmlText(out, errors);
+            out << "</failure>\n";
+        }
+        if (!warnings.empty()) {
+            out << "<system-out>";
+            WriteXmlText(out, warnings);
+            out << "</system-out>\n";
+        }
+        out << "</testcase>\n";
+    }
+    out << "</testsuite>\n</testsuites>\n";
+}
+
+}  // namespace falcon_ui
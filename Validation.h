@@ -0,0 +1,93 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BulkLoader.h"
+#include "FalconWindow.h"
+
+
+namespace falcon_ui {
+
+// What the validation checks, one validator each.
+enum class Check : uint8_t {
+    BOUNDS,           // Window size and element positions: within kMaxX/kMaxY, and inside the window.
+    UNKNOWN_TAG,      // Lines whose tag is not part of the schema.
+    SCHEMA,           // Lines not valid for their tag, files without a root [WINDOW].
+    MISSING_ASSET,    // Window files listed but not found, [BITMAP] and [TILE] elements without a resource.
+    DUPLICATE_LABEL,  // Elements of a window with the same label (NID excepted).
+    OVERLAP,          // Buttons overlapping other buttons of their window.
+};
+
+inline constexpr size_t kCheckCount = 6;
+
+// Failures are the errors, which fail the validation (not called ERROR, a macro of Windows.h).
+enum class Severity : uint8_t {
+    WARNING,
+    FAILURE,
+};
+
+struct ValidationIssue {
+    static constexpr uint32_t kNoElement = std::numeric_limits<uint32_t>::max();
+
+    Check check;
+    Severity severity;
+    // Index in the window model (0 is the root window), kNoElement for issues of the whole file.
+    uint32_t element;
+    // 1 based, 0 for issues of the whole file.
+    uint32_t line;
+    std::string message;
+};
+
+// The issues of one window file.
+struct FileValidation {
+    // First load of the file in BulkLoadResult::windows, files listed by several UI sets are validated once.
+    size_t window;
+    // In line order.
+    std::vector<ValidationIssue> issues;
+};
+
+struct ValidationReport {
+    std::shared_ptr<const BulkLoadResult> load;
+    // One per distinct file, in load order.
+    std::vector<FileValidation> files;
+    size_t errors = 0;
+    size_t warnings = 0;
+    std::chrono::nanoseconds wall_time{};
+    unsigned thread_count = 0;
+};
+
+struct ValidationOptions {
+    // Bit i enables Check i.
+    uint32_t checks = (1u << kCheckCount) - 1;
+    // 0 uses one thread per core.
+    unsigned thread_count = 0;
+};
+
+// Name of check in the reports and on the command line: "bounds", "unknown_tag"...
+std::string_view CheckName(Check check);
+std::optional<Check> CheckFromName(std::string_view name);
+std::string_view SeverityName(Severity severity);
+
+// The issues of window, loaded (or not) from path. checks as in ValidationOptions.
+std::vector<ValidationIssue> ValidateWindow(const Window& window, const std::string& path, uint32_t checks);
+
+// Validates every window of load in parallel. The report keeps load alive for the paths.
+ValidationReport Validate(std::shared_ptr<const BulkLoadResult> load, const ValidationOptions& options = {});
+
+// One line per issue, "path:line: error: message [check]" as compilers write them, which editors and CI logs link.
+void WriteIssue(std::ostream& out, const std::string& path, const ValidationIssue& issue);
+void WriteTextReport(const ValidationReport& report, std::ostream& out);
+// Every file with its issues and the totals, as one JSON object.
+void WriteJsonReport(const ValidationReport& report, std::ostream& out);
+// One test case per file, failed by its errors, for the CI test result viewers.
+void WriteJUnitReport(const ValidationReport& report, std::ostream& out);
+
+}  // namespace falcon_ui
@@ -0,0 +1,175 @@
+#pragma once
+
+// The options, timing loop and JSON lines the benchmarks share.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ScfCorpus.h"
+
+
+namespace falcon_ui::bench {
+
+// The options of every benchmark: --elements, --tag-mix, --seed, --min-time, --label and --output.
+struct BenchOptions {
+    // The window sizes, each measured in turn.
+    std::vector<size_t> elements;
+    ScfCorpusOptions corpus;
+    double min_time = 1.0;
+    std::string label;
+    std::string output;
+    // Set by --help, once the usage is printed: the benchmark exits with 0.
+    bool help = false;
+};
+
+// The usage lines of the options of BenchOptions, printed after those of the benchmark.
+inline constexpr char kCommonUsage[] =
+    "  --elements <sizes>     Comma separated window sizes, in elements, each measured in turn.\n"
+    "  --tag-mix <weights>    BUTTON:BITMAP:TILE weights of the generated elements, default 6:3:1.\n"
+    "  --seed <n>             Seed of the generated windows, default 1.\n"
+    "  --min-time <seconds>   Least time each path is measured for, default 1.\n"
+    "  --label <text>         Tags the results, with a commit hash for example.\n"
+    "  --output <file>        Appends the results to file instead of printing them.\n"
+    "  --help, -h             Prints this usage.\n";
+
+inline void PrintUsage(std::ostream& out, const char* program, const char* usage) {
+    out << "Usage: " << program << usage << kCommonUsage;
+}
+
+// Comma separated positive sizes, the others are left out.
+inline std::vector<size_t> ParseSizes(const std::string& text) {
+    std::vector<size_t> sizes;
+    for (size_t begin = 0; begin <= text.size();) {
+        const size_t end = std::min(text.find(',', begin), text.size());
+        const auto size = std::strtoull(text.substr(begin, end - begin).c_str(), nullptr, 10);
+        if (size > 0) sizes.push_back(static_cast<size_t>(size));
+        begin = end + 1;
+    }
+    return sizes;
+}
+
+// BUTTON:BITMAP:TILE weights, none negative and not all zero.
+inline bool ParseTagMix(const std::string& text, ScfCorpusOptions& corpus) {
+    double weights[3];
+    if (std::sscanf(text.c_str(), "%lf:%lf:%lf", &weights[0], &weights[1], &weights[2]) != 3) return false;
+    if (weights[0] < 0 || weights[1] < 0 || weights[2] < 0 || weights[0] + weights[1] + weights[2] <= 0) return false;
+    corpus.button_weight = weights[0];
+    corpus.bitmap_weight = weights[1];
+    corpus.tile_weight = weights[2];
+    return true;
+}
+
+// Parses the command line into options. The options of the benchmark itself go to parse_other(arg, value), which
+// returns false if arg is unknown or value invalid (after saying why). usage follows the program name in the usage
+// printed for --help and after errors: the synopsis, what the benchmark measures and its own options.
+// Returns false on errors, without sizes, or for --help (options.help is then set).
+template <typename ParseOther>
+bool ParseOptions(int argc, char** argv, const char* usage, BenchOptions& options, const ParseOther& parse_other) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            PrintUsage(std::cout, argv[0], usage);
+            options.help = true;
+            return false;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            PrintUsage(std::cerr, argv[0], usage);
+            return false;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--elements") {
+            options.elements = ParseSizes(value);
+        } else if (arg == "--tag-mix") {
+            if (!ParseTagMix(value, options.corpus)) {
+                std::cerr << "--tag-mix wants BUTTON:BITMAP:TILE weights, for example 6:3:1" << std::endl;
+                return false;
+            }
+        } else if (arg == "--seed") {
+            options.corpus.seed = std::strtoull(value.c_str(), nullptr, 10);
+        } else if (arg == "--min-time") {
+            options.min_time = std::strtod(value.c_str(), nullptr);
+        } else if (arg == "--label") {
+            options.label = value;
+        } else if (arg == "--output") {
+            options.output = value;
+        } else if (!parse_other(arg, value)) {
+            PrintUsage(std::cerr, argv[0], usage);
+            return false;
+        }
+    }
+    if (options.elements.empty()) {
+        std::cerr << "--elements wants positive sizes, for example 1000,10000" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Says an option is unknown, for the benchmarks with none of their own.
+inline bool UnknownOption(const std::string& arg, const std::string&) {
+    std::cerr << "Unknown option " << arg << std::endl;
+    return false;
+}
+
+// The stream the results go to: the file of --output (appended to), or stdout. Returns nullptr if the file cannot be
+// opened.
+inline std::ostream* OpenOutput(const BenchOptions& options, std::ofstream& file) {
+    if (options.output.empty()) return &std::cout;
+    file.open(options.output, std::ios::app);
+    if (!file) {
+        std::cerr << "Unable to open " << options.output << std::endl;
+        return nullptr;
+    }
+    return &file;
+}
+
+struct Timing {
+    size_t iterations = 0;
+    double seconds = 0.0;
+};
+
+// Runs pass(prepare()) until min_time is spent in pass, at least once. Only the passes are timed.
+template <typename Prepare, typename Pass>
+Timing Repeat(double min_time, const Prepare& prepare, const Pass& pass) {
+    using Clock = std::chrono::steady_clock;
+    Timing timing;
+    Clock::duration spent{};
+    do {
+        auto inputs = prepare();
+        const auto start = Clock::now();
+        pass(inputs);
+        spent += Clock::now() - start;
+        ++timing.iterations;
+    } while (std::chrono::duration<double>(spent).count() < min_time);
+    timing.seconds = std::chrono::duration<double>(spent).count();
+    return timing;
+}
+
+inline std::string JsonEscape(const std::string& text) {
+    std::string escaped;
+    for (const char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) escaped += c;
+    }
+    return escaped;
+}
+
+// The fields every result line starts with, without the braces: the label, the benchmark, the corpus and the timing.
+inline std::string CommonFields(const BenchOptions& options, const char* benchmark, size_t elements_per_window, const Timing& timing) {
+    const auto& corpus = options.corpus;
+    char fields[512];
+    std::snprintf(fields, sizeof(fields),
+        "\"benchmark\":\"%s\",\"elements_per_window\":%zu,\"comment_density\":%.3f,\"tag_mix\":[%.3f,%.3f,%.3f],\"seed\":%llu,"
+        "\"iterations\":%zu,\"seconds\":%.6f",
+        benchmark, elements_per_window, corpus.comment_density, corpus.button_weight, corpus.bitmap_weight, corpus.tile_weight,
+        static_cast<unsigned long long>(corpus.seed), timing.iterations, timing.seconds);
+    return "\"label\":\"" + JsonEscape(options.label) + "\"," + fields;
+}
+
+}  // namespace falcon_ui::bench
@@ -0,0 +1,245 @@
+// Benchmark of the element setup and draw passes on one big synthetic window (see ScfCorpus.h).
+//
+//   element_draw_bench [--elements 50000] [--tag-mix BUTTON:BITMAP:TILE] [--seed N] [--min-time SECONDS]
+//                      [--label TEXT] [--output FILE]
+//
+// Each window size is measured on these paths:
+//   element_setup: Window::SetupFromModel, which builds and sets up the elements of an already parsed model.
+//   element_draw: one ImGui frame drawing the window (NewFrame, Window::Draw, Render), without a GPU.
+//   element_draw_profiled: the same with the frame profiler recording, which times every element.
+//   element_raster: element_draw, then the draw data rasterized to a 1920x1080 framebuffer on the CPU (see
+//   imgui_impl_softraster.h), what a headless render of the window costs.
+//   element_draw_textured: element_draw with the images of the bitmaps, from a synthetic resource archive through a
+//   TextureCache on a stub backend (see StubTextureBackend.h), once they are all uploaded.
+//   element_draw_textured_no_atlas: the same with a texture per image instead of the atlas pages.
+//   element_draw_evicting: two windows drawn in turn, each until its images are uploaded, with no texture budget: every
+//   switch evicts the textures and atlas pages of the other window and decodes its images again.
+// One JSON object per line and path is written, with the time per element. Tag the results with --label (a commit
+// hash) to compare them. The drawing paths also report the draw commands of their last frame, the atlas pages and the
+// evictions per iteration.
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BenchCommon.h"
+#include "FalconWindow.h"
+#include "FrameProfiler.h"
+#include "imgui.h"
+#include "imgui_impl_softraster.h"
+#include "ResourceArchive.h"
+#include "ScfCorpus.h"
+#include "StubTextureBackend.h"
+#include "TextureCache.h"
+
+
+namespace {
+
+using falcon_ui::TextureCache;
+using falcon_ui::Window;
+using falcon_ui::bench::BenchOptions;
+using falcon_ui::bench::StubTextureBackend;
+
+constexpr char kUsage[] =
+    " [options]\n"
+    "Measures the setup and draw passes of one generated window, one JSON line per path and size (see DrawBench.cpp).\n"
+    "The size defaults to 50000 elements.\n";
+
+constexpr int kDisplayWidth = 1920;
+constexpr int kDisplayHeight = 1080;
+constexpr ImU32 kClearColor = IM_COL32(0, 0, 0, 255);
+
+struct Result {
+    const char* benchmark;
+    size_t elements;
+    falcon_ui::bench::Timing timing{};
+    bool good = true;
+    // Of the last frame drawn.
+    size_t draw_commands = 0;
+    size_t atlas_pages = 0;
+    uint64_t evictions = 0;
+};
+
+// Runs pass until min_time is spent, at least once.
+template <typename Pass>
+Result Measure(const char* benchmark, size_t elements, double min_time, const Pass& pass) {
+    Result result{ benchmark, elements, {}, true };
+    result.timing = falcon_ui::bench::Repeat(min_time, [] { return 0; }, [&](int) { result.good &= pass(); });
+    return result;
+}
+
+// One frame of a headless ImGui context drawing window, with the textures of textures if not null.
+bool DrawFrame(const Window& window, TextureCache* textures = nullptr) {
+    if (textures != nullptr) textures->Update();
+    ImGui::NewFrame();
+    window.Draw(textures);
+    ImGui::Render();
+    return ImGui::GetDrawData()->TotalVtxCount > 0;
+}
+
+// Of the last frame rendered.
+size_t DrawCommands() {
+    const auto* draw_data = ImGui::GetDrawData();
+    size_t commands = 0;
+    for (int i = 0; i < draw_data->CmdListsCount; ++i) commands += draw_data->CmdLists[i]->CmdBuffer.Size;
+    return commands;
+}
+
+// Draws frames until the images of window are uploaded. Returns false if textures gave a bad call to the backend.
+bool DrawUntilUploaded(const Window& window, TextureCache& textures, const StubTextureBackend& backend) {
+    bool good = DrawFrame(window, &textures);
+    while (textures.Pending()) {
+        // The decodes run on the workers.
+        std::this_thread::yield();
+        good &= DrawFrame(window, &textures);
+    }
+    return good && backend.bad_calls == 0;
+}
+
+// The same frame rasterized to pixels, which must not all keep the clear color.
+bool RasterFrame(const Window& window, std::vector<ImU32>& pixels) {
+    ImGui_ImplSoftraster_NewFrame();
+    if (!DrawFrame(window)) return false;
+    std::fill(pixels.begin(), pixels.end(), kClearColor);
+    const ImGui_ImplSoftraster_Framebuffer framebuffer{ pixels.data(), kDisplayWidth, kDisplayHeight, kDisplayWidth };
+    ImGui_ImplSoftraster_RenderDrawData(ImGui::GetDrawData(), framebuffer);
+    return std::any_of(pixels.begin(), pixels.end(), [](ImU32 pixel) { return pixel != kClearColor; });
+}
+
+void WriteResult(std::ostream& out, const BenchOptions& options, const Result& result) {
+    const auto& timing = result.timing;
+    const double total_elements = static_cast<double>(result.elements) * timing.iterations;
+    char line[1024];
+    snprintf(line, sizeof(line),
+        "{%s,\"ms_per_iteration\":%.3f,\"ns_per_element\":%.2f,\"draw_commands\":%zu,\"atlas_pages\":%zu,"
+        "\"evictions_per_iteration\":%.1f,\"good\":%s}",
+        falcon_ui::bench::CommonFields(options, result.benchmark, result.elements, timing).c_str(), timing.seconds * 1e3 / timing.iterations,
+        timing.seconds * 1e9 / total_elements, result.draw_commands, result.atlas_pages,
+        static_cast<double>(result.evictions) / timing.iterations, result.good ? "true" : "false");
+    out << line << std::endl;
+}
+
+}  // namespace
+
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    options.elements = { 50000 };
+    if (!falcon_ui::bench::ParseOptions(argc, argv, kUsage, options, falcon_ui::bench::UnknownOption)) return options.help ? 0 : 2;
+    std::ofstream output_file;
+    auto* const output = falcon_ui::bench::OpenOutput(options, output_file);
+    if (output == nullptr) return 1;
+    std::ostream& out = *output;
+
+    // A context with a display is all NewFrame needs, the CPU renderer builds the font atlas.
+    ImGui::CreateContext();
+    auto& io = ImGui::GetIO();
+    io.DisplaySize = ImVec2(static_cast<float>(kDisplayWidth), static_cast<float>(kDisplayHeight));
+    io.DeltaTime = 1.0f / 60.0f;
+    io.IniFilename = nullptr;
+    ImGui_ImplSoftraster_Init();
+    ImGui_ImplSoftraster_NewFrame();
+    std::vector<ImU32> framebuffer(size_t{ kDisplayWidth } * kDisplayHeight);
+    const auto archive_directory = std::filesystem::temp_directory_path() / "falcon_ui_draw_bench";
+    std::error_code error;
+    std::filesystem::create_directories(archive_directory, error);
+
+    int status = 0;
+    auto& profiler = falcon_ui::FrameProfiler::Get();
+    for (const size_t elements : options.elements) {
+        auto corpus_options = options.corpus;
+        corpus_options.elements_per_window = elements;
+        const auto contents = falcon_ui::bench::GenerateScfWindow(corpus_options, 0);
+        Window parsed;
+        parsed.SetupFromContents(contents);
+        if (!parsed.Good()) {
+            std::cerr << "The generated window does not parse" << std::endl;
+            return 1;
+        }
+
+        const auto setup = Measure("element_setup", elements, options.min_time, [&] {
+            falcon_ui::SourceBuffer source;
+            source.Assign(contents);
+            Window window;
+            window.SetupFromModel(std::move(source), parsed.Model());
+            return window.Good();
+        });
+        WriteResult(out, options, setup);
+
+        profiler.SetEnabled(false);
+        auto draw = Measure("element_draw", elements, options.min_time, [&] { return DrawFrame(parsed); });
+        draw.draw_commands = DrawCommands();
+        WriteResult(out, options, draw);
+
+        profiler.SetEnabled(true);
+        auto draw_profiled = Measure("element_draw_profiled", elements, options.min_time, [&] {
+            profiler.BeginFrame();
+            return DrawFrame(parsed);
+        });
+        profiler.SetEnabled(false);
+        draw_profiled.draw_commands = DrawCommands();
+        WriteResult(out, options, draw_profiled);
+
+        auto raster = Measure("element_raster", elements, options.min_time, [&] { return RasterFrame(parsed, framebuffer); });
+        raster.draw_commands = DrawCommands();
+        WriteResult(out, options, raster);
+        if (!setup.good || !draw.good || !draw_profiled.good || !raster.good) status = 1;
+
+        // The images of this window and of a second one, for element_draw_evicting.
+        const auto other_contents = falcon_ui::bench::GenerateScfWindow(corpus_options, 1);
+        Window other;
+        other.SetupFromContents(other_contents);
+        auto images = falcon_ui::bench::ScfWindowImages(contents);
+        const auto other_images = falcon_ui::bench::ScfWindowImages(other_contents);
+        images.insert(images.end(), other_images.begin(), other_images.end());
+        const auto archive_path = (archive_directory / "BENCH.IDX").string();
+        std::shared_ptr<const falcon_ui::ResourceArchive> archive;
+        if (falcon_ui::bench::WriteImageArchive(images, archive_path)) archive = falcon_ui::ResourceArchive::Open(archive_path);
+        if (archive == nullptr || !other.Good()) {
+            std::cerr << "Unable to write the resource archive of the generated windows to " << archive_directory.string() << std::endl;
+            return 1;
+        }
+
+        for (const bool use_atlas : { true, false }) {
+            StubTextureBackend backend;
+            TextureCache textures(backend);
+            textures.SetUseAtlas(use_atlas);
+            textures.SetArchives({ archive });
+            const bool uploaded = DrawUntilUploaded(parsed, textures, backend);
+            const auto evictions = textures.GetStats().evictions;
+            auto textured = Measure(use_atlas ? "element_draw_textured" : "element_draw_textured_no_atlas", elements, options.min_time,
+                [&] { return DrawFrame(parsed, &textures); });
+            const auto stats = textures.GetStats();
+            textured.good &= uploaded && backend.bad_calls == 0;
+            textured.draw_commands = DrawCommands();
+            textured.atlas_pages = stats.atlas_pages;
+            textured.evictions = stats.evictions - evictions;
+            WriteResult(out, options, textured);
+            if (!textured.good) status = 1;
+        }
+
+        StubTextureBackend backend;
+        TextureCache textures(backend, 0);
+        textures.SetArchives({ archive });
+        auto evicting = Measure("element_draw_evicting", elements, options.min_time, [&] {
+            return DrawUntilUploaded(parsed, textures, backend) && DrawUntilUploaded(other, textures, backend);
+        });
+        const auto stats = textures.GetStats();
+        evicting.draw_commands = DrawCommands();
+        evicting.atlas_pages = stats.atlas_pages;
+        evicting.evictions = stats.evictions;
+        // Each switch must have evicted something.
+        evicting.good &= stats.evictions >= evicting.timing.iterations;
+        WriteResult(out, options, evicting);
+        if (!evicting.good) status = 1;
+    }
+    ImGui_ImplSoftraster_Shutdown();
+    ImGui::DestroyContext();
+    return status;
+}
@@ -0,0 +1,178 @@
+// FrameScheduler driven by HeadlessFrameBackend: frames are only drawn when asked for, and the UI thread sleeps
+// in between. The bounds are loose, these run on loaded CI machines and in the sanitizer builds.
+
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include "FalconWindow.h"
+#include "FileWatcher.h"
+#include "FrameScheduler.h"
+#include "ModelCache.h"
+#include "UnitTest.h"
+
+
+namespace {
+
+using falcon_ui::FrameScheduler;
+using falcon_ui::HeadlessFrameBackend;
+using Clock = FrameScheduler::Clock;
+using std::chrono::milliseconds;
+
+// Should a wake up be missed, the tests end with a failure instead of blocking ctest.
+constexpr auto kSafetyNet = std::chrono::seconds(5);
+
+// Time WaitForNextFrame blocked.
+Clock::duration TimeNextFrame(FrameScheduler& scheduler) {
+    const auto start = Clock::now();
+    scheduler.WaitForNextFrame();
+    return Clock::now() - start;
+}
+
+}  // namespace
+
+
+FALCON_UI_TEST(FrameScheduler, FirstFrameAndRequestedFramesDoNotWait) {
+    HeadlessFrameBackend backend;
+    FrameScheduler scheduler(backend);
+    FALCON_UI_EXPECT(TimeNextFrame(scheduler) < milliseconds(100));
+    scheduler.RequestFrames(2);
+    FALCON_UI_EXPECT(TimeNextFrame(scheduler) < milliseconds(100));
+    FALCON_UI_EXPECT(TimeNextFrame(scheduler) < milliseconds(100));
+    FALCON_UI_EXPECT(scheduler.FrameCount() == 3);
+}
+
+FALCON_UI_TEST(FrameScheduler, SleepsUntilRequestedTime) {
+    HeadlessFrameBackend backend;
+    FrameScheduler scheduler(backend);
+    scheduler.WaitForNextFrame();
+
+    scheduler.RequestFrameIn(milliseconds(200));
+    const auto cpu_start = std::clock();
+    const auto waited = TimeNextFrame(scheduler);
+    const double cpu_seconds = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    FALCON_UI_EXPECT(waited >= milliseconds(190) && waited < milliseconds(2000));
+    // Blocked, not polling.
+    FALCON_UI_EXPECT(cpu_seconds < 0.1);
+
+    // The earliest of the requests wins.
+    scheduler.RequestFrameIn(kSafetyNet);
+    scheduler.RequestFrameIn(milliseconds(50));
+    FALCON_UI_EXPECT(TimeNextFrame(scheduler) < milliseconds(1000));
+}
+
+FALCON_UI_TEST(FrameScheduler, InputWakesUpForSeveralFrames) {
+    HeadlessFrameBackend backend;
+    FrameScheduler scheduler(backend);
+    scheduler.WaitForNextFrame();
+
+    scheduler.RequestFrameIn(kSafetyNet);
+    std::thread input([&backend] {
+        std::this_thread::sleep_for(milliseconds(50));
+        backend.PostInput();
+    });
+    const auto waited = TimeNextFrame(scheduler);
+    input.join();
+    FALCON_UI_EXPECT(waited >= milliseconds(40) && waited < milliseconds(2000));
+    FALCON_UI_EXPECT(Clock::now() - scheduler.LastInputTime() < milliseconds(2000));
+    // The input frame was the first of them.
+    for (int i = 1; i < FrameScheduler::kFramesAfterInput; ++i) FALCON_UI_EXPECT(TimeNextFrame(scheduler) < milliseconds(100));
+    // Then back to sleep, the safety net request is still pending.
+    scheduler.RequestFrameIn(milliseconds(100));
+    FALCON_UI_EXPECT(TimeNextFrame(scheduler) >= milliseconds(90));
+}
+
+FALCON_UI_TEST(FrameScheduler, WakeWithoutRequestDrawsNoFrame) {
+    HeadlessFrameBackend backend;
+    FrameScheduler scheduler(backend);
+    scheduler.WaitForNextFrame();
+
+    scheduler.RequestFrameIn(milliseconds(300));
+    std::thread waker([&backend] {
+        std::this_thread::sleep_for(milliseconds(50));
+        backend.Wake();
+    });
+    const auto waited = TimeNextFrame(scheduler);
+    waker.join();
+    FALCON_UI_EXPECT(waited >= milliseconds(290));
+}
+
+FALCON_UI_TEST(FrameScheduler, FileChangesWakeUp) {
+    const auto directory = std::filesystem::temp_directory_path() / "falcon_ui_tests_frame_scheduler";
+    std::filesystem::create_directories(directory);
+    const auto path = (directory / "window.scf").string();
+    std::ofstream(path) << "[WINDOW]\n";
+    {
+        falcon_ui::FileWatcher watcher;
+        FALCON_UI_EXPECT(watcher.Watch(path));
+        HeadlessFrameBackend backend;
+        FrameScheduler scheduler(backend, &watcher);
+        scheduler.WaitForNextFrame();
+
+        scheduler.RequestFrameIn(kSafetyNet);
+        std::thread writer([&path] {
+            std::this_thread::sleep_for(milliseconds(50));
+            std::ofstream(path, std::ios::app) << "[SETUP] W C_TYPE_NORMAL 10 10\n";
+        });
+        const auto waited = TimeNextFrame(scheduler);
+        writer.join();
+        FALCON_UI_EXPECT(waited < milliseconds(3000));
+        FALCON_UI_EXPECT(!watcher.PollChanges().empty());
+    }
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+}
+
+FALCON_UI_TEST(FrameScheduler, InPlaceSaveReloadsTheShownWindow) {
+    // The flow of the editor (WindowUI::ReloadChangedFiles): a window loaded and watched, an external editor writing its
+    // file in place, the watcher reporting it and the window loaded again.
+    const auto directory = std::filesystem::temp_directory_path() / "falcon_ui_tests_reload";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const auto path = (directory / "window.scf").string();
+    const std::string before = "[WINDOW]\r\n[SETUP] W C_TYPE_NORMAL 100 100\r\n";
+    const std::string after = "[WINDOW]\r\n[SETUP] W C_TYPE_NORMAL 640 480\r\n[BITMAP]\r\n[SETUP] PIC C_TYPE_NORMAL 1 2 IMG\r\n";
+    std::ofstream(path, std::ios::binary) << before;
+    {
+        falcon_ui::ModelCache cache(directory / "cache");
+        falcon_ui::Window shown;
+        cache.Load(path, shown);
+        FALCON_UI_EXPECT(shown.Good() && shown.Source() == before);
+        falcon_ui::FileWatcher watcher;
+        FALCON_UI_EXPECT(watcher.Watch(path));
+
+        {
+            std::ofstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file << after;
+            FALCON_UI_EXPECT(static_cast<bool>(file.flush()));
+        }
+        FALCON_UI_EXPECT(watcher.WaitForChanges(kSafetyNet));
+        const auto changes = watcher.PollChanges();
+        FALCON_UI_EXPECT(changes.size() == 1 && changes[0] == path);
+        falcon_ui::Window reloaded;
+        cache.Load(path, reloaded);
+        FALCON_UI_EXPECT(reloaded.Good() && reloaded.Source() == after && reloaded.Model().elements.size() == 2);
+        FALCON_UI_EXPECT(shown.Source() == before);
+    }
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+}
+
+FALCON_UI_TEST(FrameScheduler, StatsCountFramesAndIdleTime) {
+    HeadlessFrameBackend backend;
+    FrameScheduler scheduler(backend);
+    scheduler.WaitForNextFrame();
+    // About 50 frames a second for a bit more than the one second of the stats.
+    const auto start = Clock::now();
+    while (Clock::now() - start < milliseconds(1200)) {
+        scheduler.RequestFrameIn(milliseconds(20));
+        scheduler.WaitForNextFrame();
+    }
+    const auto& stats = scheduler.GetStats();
+    FALCON_UI_EXPECT(stats.frames_per_second > 20.0 && stats.frames_per_second < 60.0);
+    FALCON_UI_EXPECT(stats.idle_fraction > 0.5 && stats.idle_fraction <= 1.05);
+    FALCON_UI_EXPECT(stats.cpu_usage >= 0.0 && stats.cpu_usage < 0.5);
+    FALCON_UI_EXPECT(scheduler.FrameCount() > 20);
+}
@@ -0,0 +1,86 @@
+// JobSystem lanes, on a system of its own with one worker so the order jobs are taken in is known.
+
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "JobSystem.h"
+#include "UnitTest.h"
+
+
+namespace {
+
+using falcon_ui::CancellationToken;
+using falcon_ui::JobPriority;
+using falcon_ui::JobSystem;
+
+// Holds the worker of system until Release, so the jobs submitted meanwhile queue up.
+class BlockedWorker {
+public:
+    explicit BlockedWorker(JobSystem& system) {
+        std::promise<void> started;
+        auto started_future = started.get_future();
+        job_ = system.Submit(JobPriority::INTERACTIVE, [&started, release = release_.get_future()](const CancellationToken&) {
+            started.set_value();
+            release.wait();
+            return 0;
+        });
+        started_future.wait();
+    }
+    ~BlockedWorker() { Release(); }
+
+    void Release() {
+        if (!job_.Valid()) return;
+        release_.set_value();
+        job_.Get();
+    }
+
+private:
+    std::promise<void> release_;
+    falcon_ui::JobFuture<int> job_;
+};
+
+// The jobs which ran, in order, with the lane each ran in.
+struct RunLog {
+    std::mutex mutex;
+    std::vector<int> jobs;
+    std::vector<JobPriority> priorities;
+
+    int Record(int job) {
+        std::lock_guard lock(mutex);
+        jobs.push_back(job);
+        priorities.push_back(JobSystem::CurrentPriority());
+        return job;
+    }
+};
+
+}  // namespace
+
+
+FALCON_UI_TEST(JobSystem, ReprioritizedJobRunsOnceInItsNewLane) {
+    JobSystem system(1);
+    RunLog log;
+    BlockedWorker blocked(system);
+    auto preview = system.Submit(JobPriority::PREVIEW, [&log](const CancellationToken&) { return log.Record(1); });
+    auto interactive = system.Submit(JobPriority::INTERACTIVE, [&log](const CancellationToken&) { return log.Record(2); });
+    auto background = system.Submit(JobPriority::BACKGROUND, [&log](const CancellationToken&) { return log.Record(3); });
+    // Without it, the preview would run after the interactive job.
+    system.Reprioritize(preview, JobPriority::INTERACTIVE);
+    blocked.Release();
+    FALCON_UI_EXPECT(preview.Get() == 1 && interactive.Get() == 2 && background.Get() == 3);
+
+    // The worker takes its newest job of the highest lane first, the copy left in the preview lane does nothing.
+    FALCON_UI_EXPECT((log.jobs == std::vector<int>{ 1, 2, 3 }));
+    FALCON_UI_EXPECT((log.priorities == std::vector<JobPriority>{ JobPriority::INTERACTIVE, JobPriority::INTERACTIVE, JobPriority::BACKGROUND }));
+}
+
+FALCON_UI_TEST(JobSystem, ReprioritizingADoneJobDoesNothing) {
+    JobSystem system(1);
+    auto job = system.Submit(JobPriority::BACKGROUND, [](const CancellationToken&) { return 1; });
+    while (!job.Ready()) std::this_thread::yield();
+    BlockedWorker blocked(system);
+    system.Reprioritize(job, JobPriority::INTERACTIVE);
+    FALCON_UI_EXPECT(system.GetStats().queued[static_cast<size_t>(JobPriority::INTERACTIVE)] == 0);
+    FALCON_UI_EXPECT(job.Get() == 1);
+}
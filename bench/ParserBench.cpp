@@ -0,0 +1,333 @@
+// Benchmark of the .scf parsing and setup on synthetic corpora (see ScfCorpus.h).
+//
+//   scf_parser_bench [--elements 10,100,1000,10000,100000] [--windows N] [--tag-mix BUTTON:BITMAP:TILE]
+//                    [--comment-density P] [--seed N] [--min-time SECONDS] [--label TEXT] [--output FILE]
+//                    [--write-corpus DIR]
+//
+// Each window size is one corpus of --windows windows (by default sized to about 200k elements, 10k windows at most).
+// These paths are measured on it:
+//   parse_setup: Window::SetupFromContents, what loading a window from its file costs after the read.
+//   model_setup: Window::SetupFromModel, the same without the parsing, what a model cache hit costs.
+//   header_setup: Window::SetupHeaderFromContents, which only parses the header until the children are needed. Its
+//   bytes are those of the header lines, up to the [SETUP] of the root, and it has no element throughput.
+//   serialize: SerializeWindow of the unmodified windows, which must give back the original bytes.
+//   serialize_edited: SerializeWindow with every element edited (written from its records), which must parse again.
+// One JSON object per line and path is written, with the throughput, the time per window, the heap allocations and
+// the peak RSS.
+// Tag the results with --label (a commit hash) to compare them.
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define VC_EXTRALEAN
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "BenchCommon.h"
+#include "FalconWindow.h"
+#include "ScfCorpus.h"
+#include "ScfWriter.h"
+
+
+//-------------------------------------------------
+// Allocation counting: every heap allocation of the process goes through these.
+//-------------------------------------------------
+namespace {
+std::atomic<uint64_t> g_allocations{ 0 };
+std::atomic<uint64_t> g_allocated_bytes{ 0 };
+
+void* CountedAllocate(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* CountedAllocate(size_t size, std::align_val_t alignment) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    const auto align = static_cast<size_t>(alignment);
+#ifdef _WIN32
+    return _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    // aligned_alloc wants a multiple of the alignment.
+    return std::aligned_alloc(align, (std::max(size, size_t{ 1 }) + align - 1) / align * align);
+#endif
+}
+
+void AlignedFree(void* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+}  // namespace
+
+void* operator new(size_t size) {
+    if (void* p = CountedAllocate(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) {
+    if (void* p = CountedAllocate(size)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return CountedAllocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return CountedAllocate(size); }
+void* operator new(size_t size, std::align_val_t alignment) {
+    if (void* p = CountedAllocate(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size, std::align_val_t alignment) {
+    if (void* p = CountedAllocate(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { AlignedFree(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { AlignedFree(p); }
+
+
+namespace {
+
+using falcon_ui::Window;
+using falcon_ui::bench::BenchOptions;
+using falcon_ui::bench::ScfCorpusFile;
+
+constexpr size_t kMaxWindows = 10000;
+constexpr size_t kDefaultCorpusElements = 200000;
+
+struct Options {
+    BenchOptions bench;
+    // 0 sizes the corpus from kDefaultCorpusElements.
+    size_t windows = 0;
+    std::string write_corpus;
+};
+
+struct Result {
+    const char* benchmark;
+    size_t elements_per_window;
+    size_t windows;
+    // The bytes the pass reads, per iteration.
+    uint64_t bytes = 0;
+    falcon_ui::bench::Timing timing{};
+    uint64_t allocations = 0;
+    uint64_t allocated_bytes = 0;
+    size_t bad_windows = 0;
+    // False if the pass does not go through the elements, which then have no throughput.
+    bool all_elements = true;
+};
+
+// Peak resident set of the process so far, in KiB. It never goes down, so later results include the earlier ones.
+uint64_t PeakRssKib() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return counters.PeakWorkingSetSize / 1024;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<uint64_t>(usage.ru_maxrss) / 1024;
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+constexpr char kUsage[] =
+    " [options]\n"
+    "Measures the parsing, setup and writing of windows on generated corpora, one JSON line per path and size.\n"
+    "The sizes default to 10,100,1000,10000,100000 elements.\n"
+    "  --windows <n>          Windows per corpus, default about 200k elements in all (10000 at most).\n"
+    "  --comment-density <p>  Probability of comments before each element, default 0.3.\n"
+    "  --write-corpus <dir>   Also writes each corpus under dir, with a window list.\n";
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+    return falcon_ui::bench::ParseOptions(argc, argv, kUsage, options.bench, [&options](const std::string& arg, const std::string& value) {
+        if (arg == "--windows") {
+            options.windows = std::min<size_t>(std::strtoull(value.c_str(), nullptr, 10), kMaxWindows);
+        } else if (arg == "--comment-density") {
+            options.bench.corpus.comment_density = std::clamp(std::strtod(value.c_str(), nullptr), 0.0, 1.0);
+        } else if (arg == "--write-corpus") {
+            options.write_corpus = value;
+        } else {
+            return falcon_ui::bench::UnknownOption(arg, value);
+        }
+        return true;
+    });
+}
+
+// The bytes ParseWindowHeader reads: the generated windows start with comments, the [WINDOW] line and the [SETUP] of
+// the root, which ends the header.
+size_t HeaderSize(const std::string& contents) {
+    const auto setup = contents.find("[SETUP]");
+    const auto end = setup == std::string::npos ? std::string::npos : contents.find('\n', setup);
+    return end == std::string::npos ? contents.size() : end + 1;
+}
+
+// Runs pass (over the whole corpus) until min_time is spent, at least once. Only the passes are measured.
+template <typename Prepare, typename Pass>
+Result Measure(const char* benchmark, const std::vector<ScfCorpusFile>& corpus, size_t elements, double min_time, const Prepare& prepare, const Pass& pass) {
+    Result result{ benchmark, elements, corpus.size() };
+    for (const auto& file : corpus) {
+        result.bytes += file.contents.size();
+    }
+    result.timing = falcon_ui::bench::Repeat(min_time, prepare, [&](auto& inputs) {
+        const uint64_t allocations = g_allocations.load(std::memory_order_relaxed);
+        const uint64_t allocated_bytes = g_allocated_bytes.load(std::memory_order_relaxed);
+        result.bad_windows = pass(inputs);
+        result.allocations += g_allocations.load(std::memory_order_relaxed) - allocations;
+        result.allocated_bytes += g_allocated_bytes.load(std::memory_order_relaxed) - allocated_bytes;
+    });
+    return result;
+}
+
+void WriteResult(std::ostream& out, const Options& options, const Result& result) {
+    const auto& timing = result.timing;
+    const double total_elements = static_cast<double>(result.elements_per_window) * result.windows * timing.iterations;
+    const double total_bytes = static_cast<double>(result.bytes) * timing.iterations;
+    const auto elements_per_s = result.all_elements ? std::to_string(std::llround(total_elements / timing.seconds)) : std::string("null");
+    char line[1024];
+    snprintf(line, sizeof(line),
+        "{%s,\"windows\":%zu,\"bytes\":%llu,\"mb_per_s\":%.3f,\"us_per_window\":%.3f,\"elements_per_s\":%s,"
+        "\"allocations_per_element\":%.4f,\"allocated_bytes_per_element\":%.2f,\"peak_rss_kib\":%llu,\"bad_windows\":%zu}",
+        falcon_ui::bench::CommonFields(options.bench, result.benchmark, result.elements_per_window, timing).c_str(), result.windows,
+        static_cast<unsigned long long>(result.bytes), total_bytes / 1e6 / timing.seconds,
+        timing.seconds * 1e6 / (static_cast<double>(result.windows) * timing.iterations), elements_per_s.c_str(), result.allocations / total_elements, result.allocated_bytes / total_elements, static_cast<unsigned long long>(PeakRssKib()),
+        result.bad_windows);
+    out << line << std::endl;
+}
+
+}  // namespace
+
+
+int main(int argc, char** argv) {
+    Options options;
+    options.bench.elements = { 10, 100, 1000, 10000, 100000 };
+    if (!ParseOptions(argc, argv, options)) return options.bench.help ? 0 : 2;
+
+    std::ofstream output_file;
+    auto* const output = falcon_ui::bench::OpenOutput(options.bench, output_file);
+    if (output == nullptr) return 1;
+    std::ostream& out = *output;
+    const double min_time = options.bench.min_time;
+
+    int status = 0;
+    for (const size_t elements : options.bench.elements) {
+        auto corpus_options = options.bench.corpus;
+        corpus_options.elements_per_window = elements;
+        corpus_options.windows = options.windows != 0 ? options.windows : std::clamp<size_t>(kDefaultCorpusElements / elements, 1, kMaxWindows);
+        const auto corpus = falcon_ui::bench::GenerateScfCorpus(corpus_options);
+        if (!options.write_corpus.empty()) {
+            const auto directory = options.write_corpus + "/" + std::to_string(elements);
+            if (!falcon_ui::bench::WriteScfCorpus(corpus, directory)) std::cerr << "Unable to write the corpus to " << directory << std::endl;
+        }
+
+        // The contents are copied before each pass, the windows take ownership of them.
+        const auto copy_contents = [&corpus] {
+            std::vector<std::string> contents;
+            contents.reserve(corpus.size());
+            for (const auto& file : corpus) contents.push_back(file.contents);
+            return contents;
+        };
+        const auto parse_setup = Measure("parse_setup", corpus, elements, min_time, copy_contents, [](std::vector<std::string>& contents) {
+            size_t bad = 0;
+            for (auto& text : contents) {
+                Window window;
+                window.SetupFromContents(std::move(text));
+                bad += !window.Good();
+            }
+            return bad;
+        });
+        WriteResult(out, options, parse_setup);
+
+        std::vector<Window> parsed(corpus.size());
+        for (size_t i = 0; i < corpus.size(); ++i) parsed[i].SetupFromContents(corpus[i].contents);
+        const auto model_setup = Measure("model_setup", corpus, elements, min_time, copy_contents, [&parsed](std::vector<std::string>& contents) {
+            size_t bad = 0;
+            for (size_t i = 0; i < contents.size(); ++i) {
+                falcon_ui::SourceBuffer source;
+                source.Assign(std::move(contents[i]));
+                Window window;
+                window.SetupFromModel(std::move(source), parsed[i].Model());
+                bad += !window.Good();
+            }
+            return bad;
+        });
+        WriteResult(out, options, model_setup);
+
+        auto header_setup = Measure("header_setup", corpus, elements, min_time, copy_contents, [](std::vector<std::string>& contents) {
+            size_t bad = 0;
+            for (auto& text : contents) {
+                Window window;
+                window.SetupHeaderFromContents(std::move(text));
+                bad += !window.Header().has_value();
+            }
+            return bad;
+        });
+        header_setup.bytes = 0;
+        for (const auto& file : corpus) header_setup.bytes += HeaderSize(file.contents);
+        header_setup.all_elements = false;
+        WriteResult(out, options, header_setup);
+
+        const auto no_inputs = [] { return 0; };
+        const auto serialize = Measure("serialize", corpus, elements, min_time, no_inputs, [&parsed, &corpus](int) {
+            size_t bad = 0;
+            std::string text;
+            for (size_t i = 0; i < parsed.size(); ++i) {
+                text.clear();
+                falcon_ui::SerializeWindow(parsed[i].Model(), parsed[i].Source(), text);
+                bad += text != corpus[i].contents;
+            }
+            return bad;
+        });
+        WriteResult(out, options, serialize);
+
+        // Copies of the models with every element edited.
+        std::vector<std::vector<falcon_ui::ElementRecord>> edited_elements(parsed.size());
+        for (size_t i = 0; i < parsed.size(); ++i) {
+            const auto& elements = parsed[i].Model().elements;
+            edited_elements[i].assign(elements.begin(), elements.end());
+            for (auto& element : edited_elements[i]) element.edited = true;
+        }
+        std::vector<std::string> edited_texts(parsed.size());
+        auto serialize_edited = Measure("serialize_edited", corpus, elements, min_time, no_inputs, [&](int) {
+            for (size_t i = 0; i < parsed.size(); ++i) {
+                auto model = parsed[i].Model();
+                model.elements = edited_elements[i];
+                edited_texts[i].clear();
+                falcon_ui::SerializeWindow(model, parsed[i].Source(), edited_texts[i]);
+            }
+            // Checked outside of the measure.
+            return size_t{ 0 };
+        });
+        for (size_t i = 0; i < parsed.size(); ++i) {
+            Window window;
+            window.SetupFromContents(edited_texts[i]);
+            serialize_edited.bad_windows += !window.Good() || window.Model().elements.size() != parsed[i].Model().elements.size();
+        }
+        WriteResult(out, options, serialize_edited);
+
+        // The generator only writes valid windows, a bad one is a parser (or generator, or writer) bug.
+        if (parse_setup.bad_windows != 0 || model_setup.bad_windows != 0 || header_setup.bad_windows != 0 || serialize.bad_windows != 0 || serialize_edited.bad_windows != 0) status = 1;
+    }
+    return status;
+}
@@ -0,0 +1,261 @@
+#include "ScfCorpus.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <unordered_set>
+
+#include "Hash.h"
+#include "ResourceArchive.h"
+
+
+namespace falcon_ui::bench {
+
+namespace {
+
+// splitmix64. The standard distributions differ between standard libraries, the corpus must not.
+class Random {
+public:
+    explicit Random(uint64_t seed) : state_(seed) {}
+
+    uint64_t Next() {
+        state_ += 0x9E3779B97F4A7C15ull;
+        return MixHash(state_);
+    }
+    // In [0, bound).
+    int Int(int bound) { return static_cast<int>(Next() % static_cast<uint64_t>(bound)); }
+    int Int(int low, int high) { return low + Int(high - low + 1); }
+    // In [0, 1).
+    double Unit() { return (Next() >> 11) * 0x1.0p-53; }
+    bool Chance(double probability) { return Unit() < probability; }
+
+private:
+    uint64_t state_;
+};
+
+// Symbols in the style of the game resources.
+const char* const kScreens[] = { "MAIN_SCREEN", "TACTICAL", "CAMPAIGN", "LOGBOOK", "COMMS", "SETUP", "DOGFIGHT", "PLANNER" };
+const char* const kWords[] = { "CTRL", "OK", "CANCEL", "LOAD", "SAVE", "BRIEF", "MAP", "ZOOM", "FILTER", "TAB", "ALT", "SCROLL" };
+const char* const kStates[] = { "C_STATE_0", "C_STATE_1", "C_STATE_2", "C_STATE_DISABLED", "C_STATE_SELECTED" };
+const char* const kSounds[] = { "SND_CLICK", "SND_SCREAM", "SND_BUTTON", "SND_TAB" };
+const char* const kCursors[] = { "CRSR_F16", "CRSR_WAIT", "CRSR_DRAG" };
+const char* const kFlags[] = { "C_BIT_CANTMOVE", "C_BIT_ENABLED", "C_BIT_HCENTER", "C_BIT_VCENTER", "C_BIT_DRAGABLE" };
+const char* const kComments[] = {
+    "background", "Buttons of the toolbar", "TODO fix the position for FHD", "tab strip", "----------------",
+    "These are hidden until the campaign starts", "scroll bar",
+};
+
+template <typename T, size_t N>
+const T& Pick(Random& random, const T (&values)[N]) {
+    return values[random.Int(static_cast<int>(N))];
+}
+
+class WindowWriter {
+public:
+    WindowWriter(const ScfCorpusOptions& options, std::string& out) : options_(options), out_(out) {}
+
+    template <typename... Args>
+    void Line(const char* format, Args... args) {
+        char buffer[256];
+        const int length = snprintf(buffer, sizeof(buffer), format, args...);
+        out_.append(buffer, std::min(static_cast<size_t>(std::max(length, 0)), sizeof(buffer) - 1));
+        out_ += options_.crlf ? "\r\n" : "\n";
+    }
+    void Blank() { Line(""); }
+
+private:
+    const ScfCorpusOptions& options_;
+    std::string& out_;
+};
+
+void WriteComments(Random& random, WindowWriter& writer) {
+    for (int i = random.Int(1, 3); i > 0; --i) {
+        writer.Line("# %s", Pick(random, kComments));
+    }
+}
+
+void WriteRoot(Random& random, size_t window_index, WindowWriter& writer) {
+    const int width = random.Chance(0.5) ? 1024 : 1920;
+    const int height = width == 1024 ? 768 : 1080;
+    const char* screen = Pick(random, kScreens);
+    writer.Line("# %s window %zu", screen, window_index);
+    writer.Line("[WINDOW]");
+    writer.Line("[SETUP]   UI_%s_%zu C_TYPE_NORMAL %d %d   ", screen, window_index, width, height);
+    writer.Line("[XY] 0 0");
+    writer.Line("[RANGES] 0 0 %d %d %d %d", width, height, width, height);
+    writer.Line("[GROUP] %d", 100 + random.Int(50));
+    writer.Line("[FLAGBITON] C_BIT_CANTMOVE");
+    writer.Line("[DEPTH] 1");
+}
+
+void WriteButton(Random& random, size_t id, WindowWriter& writer) {
+    writer.Line("[BUTTON]");
+    writer.Line("[SETUP] IA_%s_%s_%zu C_TYPE_NORMAL %d %d", Pick(random, kScreens), Pick(random, kWords), id, random.Int(0, 1900), random.Int(0, 1060));
+    const int states = random.Int(1, 3);
+    for (int state = 0; state < states; ++state) {
+        writer.Line("[BUTTONIMAGE] %s IA_%s_%s", kStates[state], Pick(random, kWords), state == 0 ? "OFF" : "ON");
+    }
+    if (random.Chance(0.7)) writer.Line("[BUTTONTEXT] C_STATE_0 TXT_%s_%zu", Pick(random, kWords), id);
+    if (random.Chance(0.5)) writer.Line("[SOUNDBITE] C_STATE_1 %s", Pick(random, kSounds));
+    if (random.Chance(0.3)) writer.Line("[CURSOR] %s", Pick(random, kCursors));
+    if (random.Chance(0.3)) writer.Line("[GROUP] %d", random.Int(1000));
+    if (random.Chance(0.2)) writer.Line("[FLAGBITON] %s %s", Pick(random, kFlags), Pick(random, kFlags));
+}
+
+void WriteBitmap(Random& random, size_t id, WindowWriter& writer) {
+    writer.Line("[BITMAP]");
+    writer.Line("[SETUP] NID C_TYPE_NORMAL %d %d %s_%s_%zu", random.Int(0, 1900), random.Int(0, 1060), Pick(random, kScreens), Pick(random, kWords), id);
+    if (random.Chance(0.4)) writer.Line("[XYWH] %d %d %d %d", random.Int(0, 1000), random.Int(0, 700), random.Int(1, 900), random.Int(1, 300));
+    if (random.Chance(0.3)) writer.Line("[DEPTH] %d", random.Int(1, 10));
+}
+
+void WriteTile(Random& random, size_t id, WindowWriter& writer) {
+    writer.Line("[TILE]");
+    writer.Line("[SETUP] NID C_TYPE_NORMAL %d %d TILE_%s_%zu", random.Int(0, 1900), random.Int(0, 1060), Pick(random, kWords), id);
+    writer.Line("[XYWH] %d %d %d %d", random.Int(0, 1000), random.Int(0, 700), random.Int(1, 900), random.Int(1, 300));
+    if (random.Chance(0.5)) writer.Line("[RANGES] 0 0 %d %d %d %d", random.Int(1, 900), random.Int(1, 300), random.Int(1, 900), random.Int(1, 300));
+}
+
+}  // namespace
+
+std::string GenerateScfWindow(const ScfCorpusOptions& options, size_t window_index) {
+    Random random(CombineHash(options.seed, window_index));
+    std::string out;
+    // About 150 bytes per element.
+    out.reserve(options.elements_per_window * 160 + 256);
+    WindowWriter writer(options, out);
+
+    WriteRoot(random, window_index, writer);
+    const double total_weight = options.button_weight + options.bitmap_weight + options.tile_weight;
+    for (size_t element = 1; element < options.elements_per_window; ++element) {
+        writer.Blank();
+        if (random.Chance(options.comment_density)) WriteComments(random, writer);
+        const double kind = random.Unit() * total_weight;
+        if (kind < options.button_weight) {
+            WriteButton(random, element, writer);
+        } else if (kind < options.button_weight + options.bitmap_weight) {
+            WriteBitmap(random, element, writer);
+        } else {
+            WriteTile(random, element, writer);
+        }
+    }
+    return out;
+}
+
+std::vector<ScfCorpusFile> GenerateScfCorpus(const ScfCorpusOptions& options) {
+    std::vector<ScfCorpusFile> corpus(options.windows);
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        char name[64];
+        snprintf(name, sizeof(name), "Art\\bench\\window_%05zu.scf", i);
+        corpus[i].name = name;
+        corpus[i].contents = GenerateScfWindow(options, i);
+    }
+    return corpus;
+}
+
+bool WriteScfCorpus(const std::vector<ScfCorpusFile>& corpus, const std::string& directory) {
+    std::error_code error;
+    const std::filesystem::path root(directory);
+    std::filesystem::create_directories(root / "Art" / "bench", error);
+    if (error) return false;
+
+    std::ofstream list(root / "Art" / "bench_Scf_fhd.lst", std::ios::binary | std::ios::trunc);
+    for (const auto& file : corpus) {
+        // The names use the game separators, the files the ones of this system.
+        auto relative = file.name;
+        for (auto& c : relative) {
+            if (c == '\\') c = static_cast<char>(std::filesystem::path::preferred_separator);
+        }
+        std::ofstream out(root / relative, std::ios::binary | std::ios::trunc);
+        out << file.contents;
+        if (!out) return false;
+        list << file.name << "\r\n";
+    }
+    return static_cast<bool>(list);
+}
+
+std::vector<ScfCorpusImage> ScfWindowImages(const std::string& window) {
+    std::vector<ScfCorpusImage> images;
+    std::unordered_set<std::string_view> ids;
+    const std::string_view text(window);
+    for (size_t bitmap = text.find("[BITMAP]"); bitmap != std::string_view::npos; bitmap = text.find("[BITMAP]", bitmap + 1)) {
+        // The resource id ends the [SETUP] line which follows.
+        const size_t setup = text.find('\n', bitmap) + 1;
+        size_t end = text.find('\n', setup);
+        if (setup == 0 || end == std::string_view::npos) break;
+        if (end > setup && text[end - 1] == '\r') --end;
+        const size_t begin = text.rfind(' ', end) + 1;
+        const auto id = text.substr(begin, end - begin);
+        if (!ids.insert(id).second) continue;
+        const uint64_t hash = HashBytes(id);
+        ScfCorpusImage image;
+        image.id = id;
+        if (hash % 64 == 0) {
+            image.width = 300;
+            image.height = 200;
+        } else {
+            image.width = 8 + static_cast<int>((hash >> 8) % 57);
+            image.height = 8 + static_cast<int>((hash >> 16) % 57);
+        }
+        image.rgb565 = (hash >> 24) % 2 == 0;
+        image.color_key = (hash >> 25) % 2 == 0;
+        images.push_back(std::move(image));
+    }
+    return images;
+}
+
+bool WriteImageArchive(const std::vector<ScfCorpusImage>& images, const std::string& idx_path) {
+    // The layouts ResourceArchive reads, little endian.
+    constexpr uint32_t kVersion = 1;
+    constexpr size_t kImageHeaderSize = 60;
+    constexpr size_t kIdSize = 32;
+    std::string headers;
+    std::string data;
+    const auto append = [](std::string& out, auto value) { out.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+    append(data, kVersion);
+    for (const auto& image : images) {
+        if (image.id.size() >= kIdSize) return false;
+        const size_t count = size_t{ static_cast<uint32_t>(image.width) } * static_cast<uint32_t>(image.height);
+        const auto pixels_offset = static_cast<uint32_t>(data.size());
+        for (size_t i = 0; i < count; ++i) {
+            if (image.rgb565) {
+                append(data, static_cast<uint16_t>(i));
+            } else {
+                append(data, static_cast<uint8_t>(i));
+            }
+        }
+        const auto palette_offset = static_cast<uint32_t>(data.size());
+        const uint32_t palette_colors = image.rgb565 ? 0 : 256;
+        for (uint32_t j = 0; j < palette_colors; ++j) append(data, static_cast<uint16_t>(j));
+
+        const size_t header = headers.size();
+        append(headers, static_cast<uint32_t>(ResourceType::IMAGE));
+        headers.append(image.id);
+        headers.resize(header + 4 + kIdSize, '\0');
+        append(headers, (image.rgb565 ? kResourceImage16Bit : kResourceImage8Bit) | (image.color_key ? kResourceImageColorKey : 0));
+        append(headers, static_cast<int16_t>(image.width / 2));
+        append(headers, static_cast<int16_t>(image.height / 2));
+        append(headers, static_cast<int16_t>(image.width));
+        append(headers, static_cast<int16_t>(image.height));
+        append(headers, pixels_offset);
+        append(headers, palette_colors);
+        append(headers, palette_offset);
+        if (headers.size() - header != kImageHeaderSize) return false;
+    }
+
+    auto rsc_path = std::filesystem::path(idx_path);
+    const auto extension = rsc_path.extension().string();
+    rsc_path.replace_extension(extension.size() > 1 && extension[1] == 'I' ? ".RSC" : ".rsc");
+    std::string preamble;
+    append(preamble, static_cast<uint32_t>(headers.size()));
+    append(preamble, kVersion);
+    std::ofstream index(idx_path, std::ios::binary | std::ios::trunc);
+    index << preamble << headers;
+    std::ofstream resources(rsc_path, std::ios::binary | std::ios::trunc);
+    resources << data;
+    return index && resources;
+}
+
+}  // namespace falcon_ui::bench
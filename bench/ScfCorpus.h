@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+namespace falcon_ui::bench {
+
+// Shape of a synthetic .scf corpus. The same options always generate the same bytes, on every platform.
+struct ScfCorpusOptions {
+    uint64_t seed = 1;
+    size_t windows = 1;
+    // Including the root [WINDOW] element.
+    size_t elements_per_window = 100;
+    // Relative weights of the elements after the root.
+    double button_weight = 6.0;
+    double bitmap_weight = 3.0;
+    double tile_weight = 1.0;
+    // Probability that an element is preceded by a block of 1 to 3 comment lines.
+    double comment_density = 0.3;
+    // The game files use CRLF.
+    bool crlf = true;
+};
+
+struct ScfCorpusFile {
+    // Relative path, as in a window list (art\bench\window_00001.scf).
+    std::string name;
+    std::string contents;
+};
+
+// One window of the corpus. Windows only depend on the options and their index, so they can be generated in any order.
+std::string GenerateScfWindow(const ScfCorpusOptions& options, size_t window_index);
+
+std::vector<ScfCorpusFile> GenerateScfCorpus(const ScfCorpusOptions& options);
+
+// Writes the corpus under directory, with a window list listing it (bench_Scf_fhd.lst). Returns false on error.
+bool WriteScfCorpus(const std::vector<ScfCorpusFile>& corpus, const std::string& directory);
+
+// An image resource of a synthetic archive.
+struct ScfCorpusImage {
+    std::string id;
+    int width = 16;
+    int height = 16;
+    // 16 bit colors, pixel i having color i (on 16 bits). Otherwise palette indices, pixel i having index i % 256 of a
+    // palette whose color j is j.
+    bool rgb565 = false;
+    // Magenta (0xF81F) is transparent.
+    bool color_key = false;
+};
+
+// The images the [BITMAP] elements of a generated window draw, once each, sized from a hash of their id: 8 to 64
+// pixels a side, one in 64 being 300 x 200 (too large for the texture atlas).
+std::vector<ScfCorpusImage> ScfWindowImages(const std::string& window);
+
+// Writes the images to the resource archive idx_path and the resource file next to it, as the game does (see
+// ResourceArchive.h). Returns false on error.
+bool WriteImageArchive(const std::vector<ScfCorpusImage>& images, const std::string& idx_path);
+
+}  // namespace falcon_ui::bench
@@ -0,0 +1,448 @@
+// Parser equivalence and round trip tests on the synthetic corpora of the benchmarks (see ScfCorpus.h): every way of
+// setting up a window must give the same model, and writing a window back must give a file which parses the same.
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "DiscoveryCatalog.h"
+#include "FalconWindow.h"
+#include "Header.h"
+#include "ModelCache.h"
+#include "ScfCorpus.h"
+#include "ScfWriter.h"
+#include "SymbolIndex.h"
+#include "UnitTest.h"
+
+
+namespace {
+
+using falcon_ui::Window;
+using falcon_ui::WindowModel;
+using falcon_ui::bench::ScfCorpusFile;
+using falcon_ui::bench::ScfCorpusOptions;
+
+// Small corpora with both line endings and with and without comments.
+std::vector<std::vector<ScfCorpusFile>> TestCorpora() {
+    std::vector<std::vector<ScfCorpusFile>> corpora;
+    for (const bool crlf : { true, false }) {
+        for (const double comment_density : { 0.0, 0.5 }) {
+            ScfCorpusOptions options;
+            options.seed = corpora.size() + 1;
+            options.windows = 8;
+            options.elements_per_window = 150;
+            options.comment_density = comment_density;
+            options.crlf = crlf;
+            corpora.push_back(falcon_ui::bench::GenerateScfCorpus(options));
+        }
+    }
+    return corpora;
+}
+
+bool SameSpans(std::span<const falcon_ui::TextSpan> a, std::span<const falcon_ui::TextSpan> b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].offset != b[i].offset || a[i].length != b[i].length) return false;
+    }
+    return true;
+}
+
+// Same structure (the element hashes cover the tags and attributes) and same spans of the same source.
+bool SameModel(const WindowModel& a, const WindowModel& b) {
+    if (a.elements.size() != b.elements.size() || a.attributes.size() != b.attributes.size()) return false;
+    for (size_t i = 0; i < a.elements.size(); ++i) {
+        const auto& x = a.elements[i];
+        const auto& y = b.elements[i];
+        if (x.tag != y.tag || x.hash != y.hash || x.attribute_count != y.attribute_count || x.comment_count != y.comment_count ||
+            x.source.offset != y.source.offset || x.source.length != y.source.length) {
+            return false;
+        }
+    }
+    return SameSpans(a.comments, b.comments) && SameSpans(a.skipped, b.skipped);
+}
+
+// Same structure only, for windows written back in another form.
+bool SameStructure(const WindowModel& a, const WindowModel& b) {
+    if (a.elements.size() != b.elements.size()) return false;
+    for (size_t i = 0; i < a.elements.size(); ++i) {
+        if (a.elements[i].tag != b.elements[i].tag || a.elements[i].hash != b.elements[i].hash) return false;
+    }
+    return true;
+}
+
+// A directory of the system temporary directory, removed with its contents when the test ends.
+class TempDirectory {
+public:
+    explicit TempDirectory(const char* name) : path_(std::filesystem::temp_directory_path() / name) {
+        std::filesystem::remove_all(path_);
+        std::filesystem::create_directories(path_);
+    }
+    ~TempDirectory() {
+        std::error_code error;
+        std::filesystem::remove_all(path_, error);
+    }
+
+    const std::filesystem::path& Path() const { return path_; }
+
+private:
+    std::filesystem::path path_;
+};
+
+}  // namespace
+
+
+FALCON_UI_TEST(Parser, SetupPathsAgree) {
+    for (const auto& corpus : TestCorpora()) {
+        for (const auto& file : corpus) {
+            Window parsed;
+            parsed.SetupFromContents(file.contents);
+            FALCON_UI_EXPECT(parsed.Good());
+            FALCON_UI_EXPECT(parsed.Model().skipped.empty());
+
+            Window lazy;
+            lazy.SetupHeaderFromContents(file.contents);
+            FALCON_UI_EXPECT(lazy.Header().has_value());
+            FALCON_UI_EXPECT(lazy.Good() && SameModel(lazy.Model(), parsed.Model()));
+
+            falcon_ui::SourceBuffer source;
+            source.Assign(file.contents);
+            Window from_model;
+            from_model.SetupFromModel(std::move(source), parsed.Model());
+            FALCON_UI_EXPECT(from_model.Good() && SameModel(from_model.Model(), parsed.Model()));
+        }
+    }
+}
+
+FALCON_UI_TEST(Parser, ModelCacheAgrees) {
+    const TempDirectory directory("falcon_ui_tests_model_cache");
+    ScfCorpusOptions options;
+    options.windows = 6;
+    options.elements_per_window = 120;
+    const auto corpus = falcon_ui::bench::GenerateScfCorpus(options);
+    const auto corpus_directory = (directory.Path() / "corpus").string();
+    FALCON_UI_EXPECT(falcon_ui::bench::WriteScfCorpus(corpus, corpus_directory));
+
+    falcon_ui::ModelCache cache(directory.Path() / "cache");
+    for (const auto& file : corpus) {
+        Window parsed;
+        parsed.SetupFromContents(file.contents);
+        const auto path = NativePath(corpus_directory + "\\" + file.name);
+        // The first load misses and writes the cache, the second maps it.
+        for (const bool hit : { false, true }) {
+            Window loaded;
+            FALCON_UI_EXPECT(cache.Load(path, loaded) == hit);
+            FALCON_UI_EXPECT(loaded.Good() && loaded.Source() == file.contents && SameModel(loaded.Model(), parsed.Model()));
+        }
+    }
+    FALCON_UI_EXPECT(cache.Hits() == corpus.size() && cache.Misses() == corpus.size());
+}
+
+FALCON_UI_TEST(Parser, DamagedModelCacheIsParsedAgain) {
+    const TempDirectory directory("falcon_ui_tests_damaged_cache");
+    ScfCorpusOptions options;
+    options.elements_per_window = 20;
+    options.comment_density = 0.5;
+    const auto contents = falcon_ui::bench::GenerateScfWindow(options, 0);
+    const auto path = (directory.Path() / "window.scf").string();
+    std::ofstream(path, std::ios::binary) << contents;
+    Window parsed;
+    parsed.SetupFromContents(contents);
+
+    falcon_ui::ModelCache cache(directory.Path() / "cache");
+    Window first;
+    cache.Load(path, first);
+    const auto cache_path = std::filesystem::directory_iterator(directory.Path() / "cache")->path();
+    std::string bytes;
+    {
+        std::ifstream file(cache_path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    // Every word of the header and the model arrays, up to the copy of the source, in turn: the window must load
+    // without reading outside the cache (which the sanitizer builds check), from the cache or parsed again.
+    const size_t model_end = bytes.find(contents);
+    FALCON_UI_EXPECT(model_end != std::string::npos);
+    uint64_t rejected = 0;
+    for (size_t offset = 0; model_end != std::string::npos && offset + 4 <= model_end; offset += 4) {
+        auto damaged = bytes;
+        damaged.replace(offset, 4, "\xff\xff\xff\x7f", 4);
+        std::ofstream(cache_path, std::ios::binary | std::ios::trunc) << damaged;
+        Window loaded;
+        rejected += !cache.Load(path, loaded);
+        FALCON_UI_EXPECT(loaded.Source() == contents);
+    }
+    FALCON_UI_EXPECT(rejected > 0);
+
+    // A span past the source is caught even though the header is fine.
+    std::ofstream(cache_path, std::ios::binary | std::ios::trunc) << bytes;
+    const auto& comment = parsed.Model().comments.front();
+    const std::string comment_bytes(reinterpret_cast<const char*>(&comment), sizeof(comment));
+    const size_t comment_offset = bytes.find(comment_bytes);
+    FALCON_UI_EXPECT(comment_offset != std::string::npos && comment_offset < model_end);
+    if (comment_offset != std::string::npos) {
+        auto damaged = bytes;
+        const falcon_ui::TextSpan past_end{ static_cast<uint32_t>(contents.size()), 1 };
+        damaged.replace(comment_offset, sizeof(past_end), reinterpret_cast<const char*>(&past_end), sizeof(past_end));
+        std::ofstream(cache_path, std::ios::binary | std::ios::trunc) << damaged;
+        Window loaded;
+        FALCON_UI_EXPECT(!cache.Load(path, loaded));
+        FALCON_UI_EXPECT(loaded.Good() && SameModel(loaded.Model(), parsed.Model()));
+    }
+}
+
+FALCON_UI_TEST(Parser, SkipsInvalidAttributeLines) {
+    const std::string contents =
+        "[WINDOW]\r\n[SETUP] W C_TYPE_NORMAL 100 100\r\n"
+        "[BUTTON]\r\n[SETUP] B C_TYPE_NORMAL 1 2\r\n[XY] one two\r\n[RANGES] 1 2 3 4 5 6 7 8 9\r\n[DEPTH] 3\r\n";
+    Window window;
+    window.SetupFromContents(contents);
+    FALCON_UI_EXPECT(window.Good());
+    const auto& model = window.Model();
+    FALCON_UI_EXPECT(model.elements.size() == 2 && model.elements[1].attribute_count == 2);
+    FALCON_UI_EXPECT(model.skipped.size() == 2);
+    if (model.skipped.size() == 2) {
+        FALCON_UI_EXPECT(falcon_ui::Resolve(window.Source(), model.skipped[0]) == "[XY] one two");
+        FALCON_UI_EXPECT(falcon_ui::Resolve(window.Source(), model.skipped[1]) == "[RANGES] 1 2 3 4 5 6 7 8 9");
+    }
+
+    // The largest [RANGES] the record holds.
+    Window ranges;
+    ranges.SetupFromContents("[WINDOW]\n[SETUP] W C_TYPE_NORMAL 100 100\n[RANGES] 1 2 3 4 5 6 7 8\n");
+    FALCON_UI_EXPECT(ranges.Good() && ranges.Model().skipped.empty() && ranges.Model().attributes.size() == 2);
+}
+
+FALCON_UI_TEST(Parser, UnknownTagFailsWindow) {
+    Window unknown;
+    unknown.SetupFromContents("[WINDOW]\n[SETUP] W C_TYPE_NORMAL 100 100\n[COLOUR] 1 2\n");
+    FALCON_UI_EXPECT(!unknown.Good() && unknown.Model().elements.empty());
+
+    Window orphan;
+    orphan.SetupFromContents("[XY] 1 2\n[WINDOW]\n[SETUP] W C_TYPE_NORMAL 100 100\n");
+    FALCON_UI_EXPECT(!orphan.Good());
+}
+
+FALCON_UI_TEST(RoundTrip, UnmodifiedWindowsAreUnchanged) {
+    for (const auto& corpus : TestCorpora()) {
+        for (const auto& file : corpus) {
+            Window window;
+            window.SetupFromContents(file.contents);
+            std::string text;
+            falcon_ui::SerializeWindow(window.Model(), window.Source(), text);
+            FALCON_UI_EXPECT(text == file.contents);
+            FALCON_UI_EXPECT(text.size() <= falcon_ui::SerializedWindowSizeBound(window.Model(), window.Source()));
+        }
+    }
+}
+
+FALCON_UI_TEST(RoundTrip, EditedWindowsParseTheSame) {
+    for (const auto& corpus : TestCorpora()) {
+        for (const auto& file : corpus) {
+            Window window;
+            window.SetupFromContents(file.contents);
+            std::vector<falcon_ui::ElementRecord> elements(window.Model().elements.begin(), window.Model().elements.end());
+            for (auto& element : elements) element.edited = true;
+            auto model = window.Model();
+            model.elements = elements;
+            std::string text;
+            falcon_ui::SerializeWindow(model, window.Source(), text);
+            FALCON_UI_EXPECT(text.size() <= falcon_ui::SerializedWindowSizeBound(model, window.Source()));
+
+            Window written;
+            written.SetupFromContents(text);
+            FALCON_UI_EXPECT(written.Good() && SameStructure(written.Model(), window.Model()));
+            // The element comments are kept.
+            FALCON_UI_EXPECT(written.Model().comments.size() == window.Model().comments.size());
+        }
+    }
+}
+
+FALCON_UI_TEST(RoundTrip, SaveWindowReplacesTheFile) {
+    const TempDirectory directory("falcon_ui_tests_save");
+    ScfCorpusOptions options;
+    options.elements_per_window = 50;
+    const auto contents = falcon_ui::bench::GenerateScfWindow(options, 0);
+    const auto path = (directory.Path() / "window.scf").string();
+    std::ofstream(path, std::ios::binary) << "[WINDOW]\r\n";
+    Window window;
+    window.SetupFromContents(contents);
+    FALCON_UI_EXPECT(falcon_ui::SaveWindow(window.Model(), window.Source(), path));
+    std::ifstream file(path, std::ios::binary);
+    FALCON_UI_EXPECT(std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()) == contents);
+
+    // A directory which does not exist: nothing is written, not even the temporary file.
+    const auto missing = (directory.Path() / "missing" / "window.scf").string();
+    FALCON_UI_EXPECT(!falcon_ui::SaveWindow(window.Model(), window.Source(), missing));
+    FALCON_UI_EXPECT(std::distance(std::filesystem::directory_iterator(directory.Path()), std::filesystem::directory_iterator()) == 1);
+}
+
+FALCON_UI_TEST(RoundTrip, SaveWindowReplacesTheLoadedFile) {
+    // Saved over the file the window was loaded from, while the window holds its source, as the editor does.
+    const TempDirectory directory("falcon_ui_tests_save_loaded");
+    ScfCorpusOptions options;
+    options.elements_per_window = 50;
+    const auto contents = falcon_ui::bench::GenerateScfWindow(options, 0);
+    const auto path = (directory.Path() / "window.scf").string();
+    falcon_ui::ModelCache cache(directory.Path() / "cache");
+    const uint32_t moved = 3;
+    for (int setup = 0; setup < 3; ++setup) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+        Window window;
+        if (setup == 0) window.SetupFromFile(path);
+        // A miss, then a hit (the reload of the previous save cached the saved file).
+        if (setup == 2) cache.Load(path, window);
+        if (setup >= 1) FALCON_UI_EXPECT(cache.Load(path, window) == (setup == 2));
+        FALCON_UI_EXPECT(window.MoveElement(moved, 200 + setup, 100));
+        FALCON_UI_EXPECT(falcon_ui::SaveWindow(window.Model(), window.Source(), path));
+        FALCON_UI_EXPECT(window.Source() == contents);
+
+        // What the watcher reload then reads.
+        Window reloaded;
+        cache.Load(path, reloaded);
+        const auto& model = reloaded.Model();
+        FALCON_UI_EXPECT(reloaded.Good() && !reloaded.Edited() && model.elements.size() == window.Model().elements.size());
+        if (reloaded.Good() && model.elements.size() > moved) {
+            const auto& setup_record = model.attributes[model.elements[moved].first_attribute].setup;
+            FALCON_UI_EXPECT(setup_record.ints[0] == 200 + setup && setup_record.ints[1] == 100);
+        }
+    }
+    // Only the window file and the cache directory, no temporary file left behind.
+    FALCON_UI_EXPECT(std::distance(std::filesystem::directory_iterator(directory.Path()), std::filesystem::directory_iterator()) == 2);
+}
+
+FALCON_UI_TEST(RoundTrip, MovedElementIsWrittenFromItsRecords) {
+    ScfCorpusOptions options;
+    options.elements_per_window = 40;
+    options.comment_density = 0.5;
+    Window window;
+    window.SetupFromContents(falcon_ui::bench::GenerateScfWindow(options, 0));
+    Window original;
+    original.SetupFromContents(std::string(window.Source()));
+    FALCON_UI_EXPECT(!window.Edited());
+    FALCON_UI_EXPECT(!window.MoveElement(0, 10, 10));
+    FALCON_UI_EXPECT(!window.MoveElement(1, falcon_ui::kMaxX, 10));
+    const uint32_t moved = 5;
+    FALCON_UI_EXPECT(window.MoveElement(moved, 123, 45));
+    FALCON_UI_EXPECT(window.Edited() && window.Model().elements[moved].edited);
+    FALCON_UI_EXPECT(window.Model().elements[moved].hash != original.Model().elements[moved].hash);
+    FALCON_UI_EXPECT(window.Model().elements[0].hash != original.Model().elements[0].hash);
+
+    std::string text;
+    falcon_ui::SerializeWindow(window.Model(), window.Source(), text);
+    Window written;
+    written.SetupFromContents(text);
+    FALCON_UI_EXPECT(written.Good() && SameStructure(written.Model(), window.Model()));
+    const auto& model = written.Model();
+    if (model.elements.size() == original.Model().elements.size()) {
+        const auto& setup = model.attributes[model.elements[moved].first_attribute].setup;
+        FALCON_UI_EXPECT(setup.int_count >= 2 && setup.ints[0] == 123 && setup.ints[1] == 45);
+        // The other elements are copied byte for byte.
+        for (uint32_t i = 0; i < model.elements.size(); ++i) {
+            if (i == moved) continue;
+            FALCON_UI_EXPECT(falcon_ui::Resolve(written.Source(), model.elements[i].source) ==
+                falcon_ui::Resolve(original.Source(), original.Model().elements[i].source));
+        }
+    }
+}
+
+FALCON_UI_TEST(RoundTrip, EditedElementsDropCommentsBetweenAttributes) {
+    const std::string contents =
+        "[WINDOW]\r\n[SETUP] W C_TYPE_NORMAL 100 100\r\n"
+        "# before\r\n[BUTTON]\r\n[SETUP] A C_TYPE_NORMAL 1 2\r\n# between\r\n[DEPTH] 3\r\n"
+        "[BUTTON]\r\n[SETUP] B C_TYPE_NORMAL 3 4\r\n# kept\r\n[DEPTH] 4\r\n";
+    Window window;
+    window.SetupFromContents(contents);
+    FALCON_UI_EXPECT(window.MoveElement(1, 5, 6));
+    std::string text;
+    falcon_ui::SerializeWindow(window.Model(), window.Source(), text);
+    FALCON_UI_EXPECT(text ==
+        "[WINDOW]\r\n[SETUP] W C_TYPE_NORMAL 100 100\r\n"
+        "# before\r\n[BUTTON]\r\n[SETUP] A C_TYPE_NORMAL 5 6\r\n[DEPTH] 3\r\n\r\n"
+        "[BUTTON]\r\n[SETUP] B C_TYPE_NORMAL 3 4\r\n# kept\r\n[DEPTH] 4\r\n");
+}
+
+FALCON_UI_TEST(Parser, CatalogHeaderFollowsItsFile) {
+    const TempDirectory directory("falcon_ui_tests_catalog");
+    const auto path = (directory.Path() / "window.scf").string();
+    const auto write = [&path](const char* contents) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+    };
+    falcon_ui::DiscoveryCatalog catalog;
+    FALCON_UI_EXPECT(!catalog.Header(path).has_value());
+    write("[WINDOW]\r\n[SETUP] W C_TYPE_NORMAL 100 200\r\n");
+    FALCON_UI_EXPECT(catalog.Header(path).has_value() && catalog.Header(path)->width == 100);
+    // Another size, the modification time may not change within the test.
+    write("[WINDOW]\r\n[SETUP] W C_TYPE_NORMAL 1024 768\r\n");
+    FALCON_UI_EXPECT(catalog.Header(path).has_value() && catalog.Header(path)->width == 1024);
+    std::filesystem::remove(path);
+    FALCON_UI_EXPECT(!catalog.Header(path).has_value());
+}
+
+FALCON_UI_TEST(Parser, AttributesKeepTheirLines) {
+    // Blank, comment, skipped and LF only lines all count.
+    const std::string contents =
+        "# root\r\n[WINDOW]\r\n[SETUP] W C_TYPE_NORMAL 100 100\r\n\r\n[BITMAP]\n# comment\r\n"
+        "[SETUP] PIC C_TYPE_NORMAL 1 2 IMG_ONE\r\n[XY] 1\r\n[BITMAP] IMG_TWO\r\n";
+    Window window;
+    window.SetupFromContents(contents);
+    const auto& attributes = window.Model().attributes;
+    FALCON_UI_EXPECT(attributes.size() == 3);
+    if (attributes.size() == 3) FALCON_UI_EXPECT(attributes[0].line == 3 && attributes[1].line == 7 && attributes[2].line == 9);
+
+    falcon_ui::SymbolIndex index;
+    index.Update("window.scf", window);
+    const auto label = index.Usages("PIC");
+    const auto bitmap = index.Usages("IMG_TWO");
+    FALCON_UI_EXPECT(label.size() == 1 && label[0].line == 7 && label[0].element == 1);
+    FALCON_UI_EXPECT(bitmap.size() == 1 && bitmap[0].line == 9 && bitmap[0].element == 1);
+}
+
+FALCON_UI_TEST(Parser, WindowsOwnTheirSource) {
+    // A window keeps nothing of its file open: the file may be written in place or replaced while it is shown. A mapped
+    // source would change with the file, or fault once the file is truncated.
+    const TempDirectory directory("falcon_ui_tests_source_ownership");
+    ScfCorpusOptions options;
+    options.elements_per_window = 60;
+    const auto contents = falcon_ui::bench::GenerateScfWindow(options, 0);
+    const auto path = (directory.Path() / "window.scf").string();
+    falcon_ui::ModelCache cache(directory.Path() / "cache");
+    for (int setup = 0; setup < 4; ++setup) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+        Window window;
+        if (setup == 0) window.SetupFromFile(path);
+        if (setup == 1) window.SetupHeaderFromFile(path);
+        // A miss, then a hit.
+        if (setup >= 2) FALCON_UI_EXPECT(cache.Load(path, window) == (setup == 3));
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << "[WINDOW]\r\n";
+        FALCON_UI_EXPECT(window.Source() == contents && window.Good());
+    }
+}
+
+FALCON_UI_TEST(Parser, ModelCacheIsRefreshedWhileLoaded) {
+    const TempDirectory directory("falcon_ui_tests_cache_refresh");
+    ScfCorpusOptions options;
+    options.elements_per_window = 60;
+    const auto before = falcon_ui::bench::GenerateScfWindow(options, 0);
+    const auto after = falcon_ui::bench::GenerateScfWindow(options, 1);
+    const auto path = (directory.Path() / "window.scf").string();
+    const auto cache_directory = directory.Path() / "cache";
+    falcon_ui::ModelCache cache(cache_directory);
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << before;
+    Window missed;
+    FALCON_UI_EXPECT(!cache.Load(path, missed));
+    Window shown;
+    FALCON_UI_EXPECT(cache.Load(path, shown));
+
+    // The shown window, loaded from the cache, does not hold the cache file: it is replaced when the source changes,
+    // and can even be rewritten in place.
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << after;
+    Window reloaded;
+    FALCON_UI_EXPECT(!cache.Load(path, reloaded) && reloaded.Source() == after);
+    Window hit;
+    FALCON_UI_EXPECT(cache.Load(path, hit) && hit.Source() == after);
+    for (const auto& entry : std::filesystem::directory_iterator(cache_directory)) {
+        std::ofstream(entry.path(), std::ios::binary | std::ios::trunc) << "damaged";
+    }
+    FALCON_UI_EXPECT(shown.Source() == before && shown.Good() && hit.Source() == after && hit.Good());
+}
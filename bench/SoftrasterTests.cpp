@@ -0,0 +1,105 @@
+// The CPU renderer (imgui_impl_softraster.h) on draw data of known pixels and on whole windows, where the pixel checksum
+// must not depend on the number of threads rendering the tiles.
+
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+#include "FalconWindow.h"
+#include "Hash.h"
+#include "imgui.h"
+#include "imgui_impl_softraster.h"
+#include "ScfCorpus.h"
+#include "UnitTest.h"
+
+
+namespace {
+
+constexpr ImU32 kClearColor = IM_COL32(0, 0, 0, 255);
+
+// A headless ImGui context rendering with the CPU renderer, for the duration of a test.
+class RasterContext {
+public:
+    RasterContext(int width, int height, int thread_count) : width_(width), height_(height), pixels_(size_t(width) * height) {
+        ImGui::CreateContext();
+        auto& io = ImGui::GetIO();
+        io.DisplaySize = ImVec2(static_cast<float>(width), static_cast<float>(height));
+        io.DeltaTime = 1.0f / 60.0f;
+        io.IniFilename = nullptr;
+        ImGui_ImplSoftraster_Init(thread_count);
+    }
+    ~RasterContext() {
+        ImGui_ImplSoftraster_Shutdown();
+        ImGui::DestroyContext();
+    }
+
+    // Renders the frame draw calls (with the current ImGui context) into the cleared framebuffer.
+    template <typename Draw>
+    const std::vector<ImU32>& Render(const Draw& draw) {
+        ImGui_ImplSoftraster_NewFrame();
+        ImGui::NewFrame();
+        draw();
+        ImGui::Render();
+        std::fill(pixels_.begin(), pixels_.end(), kClearColor);
+        ImGui_ImplSoftraster_RenderDrawData(ImGui::GetDrawData(), { pixels_.data(), width_, height_, width_ });
+        return pixels_;
+    }
+
+    ImU32 Pixel(int x, int y) const { return pixels_[size_t(y) * width_ + x]; }
+
+private:
+    int width_;
+    int height_;
+    std::vector<ImU32> pixels_;
+};
+
+uint64_t Checksum(const std::vector<ImU32>& pixels) {
+    return falcon_ui::HashBytes(std::string_view(reinterpret_cast<const char*>(pixels.data()), pixels.size() * sizeof(ImU32)));
+}
+
+// Renders a synthetic window at 640x480 with thread_count threads.
+uint64_t WindowChecksum(const falcon_ui::Window& window, int thread_count) {
+    RasterContext context(640, 480, thread_count);
+    // The first frame lays the window out.
+    context.Render([&window] { window.Draw(); });
+    const auto& pixels = context.Render([&window] { window.Draw(); });
+    return Checksum(pixels);
+}
+
+}  // namespace
+
+
+FALCON_UI_TEST(Softraster, FilledRectanglesHaveExactPixels) {
+    RasterContext context(64, 64, 2);
+    context.Render([] {
+        auto* draw_list = ImGui::GetForegroundDrawList();
+        draw_list->AddRectFilled(ImVec2(8, 8), ImVec2(24, 16), IM_COL32(255, 0, 0, 255));
+        // Half transparent white over the black clear color.
+        draw_list->AddRectFilled(ImVec2(32, 32), ImVec2(40, 40), IM_COL32(255, 255, 255, 128));
+        // Clipped to its left half.
+        draw_list->PushClipRect(ImVec2(48, 0), ImVec2(52, 64));
+        draw_list->AddRectFilled(ImVec2(48, 8), ImVec2(56, 16), IM_COL32(0, 255, 0, 255));
+        draw_list->PopClipRect();
+    });
+    FALCON_UI_EXPECT(context.Pixel(8, 8) == IM_COL32(255, 0, 0, 255));
+    FALCON_UI_EXPECT(context.Pixel(23, 15) == IM_COL32(255, 0, 0, 255));
+    FALCON_UI_EXPECT(context.Pixel(24, 8) == kClearColor && context.Pixel(8, 16) == kClearColor && context.Pixel(7, 7) == kClearColor);
+    const ImU32 blended = context.Pixel(35, 35);
+    FALCON_UI_EXPECT(((blended >> IM_COL32_R_SHIFT) & 0xFF) >= 126 && ((blended >> IM_COL32_R_SHIFT) & 0xFF) <= 130);
+    FALCON_UI_EXPECT(context.Pixel(51, 8) == IM_COL32(0, 255, 0, 255));
+    FALCON_UI_EXPECT(context.Pixel(52, 8) == kClearColor);
+}
+
+FALCON_UI_TEST(Softraster, WindowChecksumDoesNotDependOnThreads) {
+    falcon_ui::bench::ScfCorpusOptions options;
+    options.elements_per_window = 300;
+    falcon_ui::Window window;
+    window.SetupFromContents(falcon_ui::bench::GenerateScfWindow(options, 0));
+    FALCON_UI_EXPECT(window.Good());
+
+    const auto single = WindowChecksum(window, 1);
+    FALCON_UI_EXPECT(single == WindowChecksum(window, 1));
+    FALCON_UI_EXPECT(single == WindowChecksum(window, 4));
+    // Something was drawn.
+    FALCON_UI_EXPECT(single != Checksum(std::vector<ImU32>(640 * 480, kClearColor)));
+}
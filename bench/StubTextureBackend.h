@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "TextureCache.h"
+
+
+namespace falcon_ui::bench {
+
+// A TextureBackend without a GPU, for the benchmarks and tests of TextureCache: the textures are pixel arrays in
+// memory, their ids counters. It counts the calls and catches the destroys of textures it does not have (destroyed
+// twice, or never created).
+class StubTextureBackend final : public TextureBackend {
+public:
+    struct Pixels {
+        int width = 0;
+        int height = 0;
+        std::vector<uint32_t> pixels;
+    };
+
+    ImTextureID Create(const uint32_t* pixels, int width, int height) override {
+        ++creates;
+        return Add(width, height, std::vector<uint32_t>(pixels, pixels + size_t{ static_cast<uint32_t>(width) } * static_cast<uint32_t>(height)));
+    }
+    ImTextureID CreateDynamic(int width, int height) override {
+        ++creates;
+        return Add(width, height, std::vector<uint32_t>(size_t{ static_cast<uint32_t>(width) } * static_cast<uint32_t>(height), 0));
+    }
+    void Update(ImTextureID texture, int x, int y, const uint32_t* pixels, int width, int height) override {
+        ++updates;
+        const auto found = textures_.find(texture);
+        if (found == textures_.end()) {
+            ++bad_calls;
+            return;
+        }
+        auto& page = found->second;
+        for (int row = 0; row < height; ++row) {
+            std::copy_n(pixels + size_t{ static_cast<uint32_t>(row) } * width, width, page.pixels.begin() + size_t{ static_cast<uint32_t>(y + row) } * page.width + x);
+        }
+    }
+    void Destroy(ImTextureID texture) override {
+        ++destroys;
+        if (textures_.erase(texture) == 0) ++bad_calls;
+    }
+
+    // nullptr if texture was destroyed, or never created.
+    const Pixels* Find(ImTextureID texture) const {
+        const auto found = textures_.find(texture);
+        return found != textures_.end() ? &found->second : nullptr;
+    }
+    size_t Live() const { return textures_.size(); }
+
+    uint64_t creates = 0;
+    uint64_t updates = 0;
+    uint64_t destroys = 0;
+    // Updates and destroys of textures the backend does not have.
+    uint64_t bad_calls = 0;
+
+private:
+    ImTextureID Add(int width, int height, std::vector<uint32_t> pixels) {
+        // Never null, which means failure.
+        const auto id = reinterpret_cast<ImTextureID>(static_cast<uintptr_t>(++next_id_));
+        textures_[id] = Pixels{ width, height, std::move(pixels) };
+        return id;
+    }
+
+    uint64_t next_id_ = 0;
+    std::unordered_map<ImTextureID, Pixels> textures_;
+};
+
+}  // namespace falcon_ui::bench
@@ -0,0 +1,45 @@
+// TextSearchIndex saved and loaded again while a previous index is still in use, as the search panel rebuilds it.
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "TextSearch.h"
+#include "UnitTest.h"
+
+
+FALCON_UI_TEST(TextSearch, SavesWhileTheLoadedIndexIsInUse) {
+    const auto directory = std::filesystem::temp_directory_path() / "falcon_ui_tests_text_search";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    const std::vector<std::string> paths = { (directory / "a.scf").string(), (directory / "b.scf").string() };
+    std::ofstream(paths[0], std::ios::binary) << "[WINDOW]\r\n[SETUP] FIRST_WINDOW C_TYPE_NORMAL 100 100\r\n";
+    std::ofstream(paths[1], std::ios::binary) << "[WINDOW]\r\n[SETUP] OTHER_WINDOW C_TYPE_NORMAL 100 100\r\n";
+    const auto index_path = directory / "index" / "text_search.f4ti";
+    {
+        const auto built = falcon_ui::TextSearchIndex::Build(paths, 1);
+        FALCON_UI_EXPECT(built != nullptr && built->Save(index_path));
+        const auto loaded = falcon_ui::TextSearchIndex::Load(index_path, paths);
+        FALCON_UI_EXPECT(loaded != nullptr && loaded->Search("first_window", 10).matches.size() == 1);
+        if (loaded == nullptr) return;
+
+        // A file changes: the loaded index no longer matches, the rebuilt one is saved while the loaded one maps its
+        // file (which on Windows cannot be replaced).
+        std::ofstream(paths[0], std::ios::binary | std::ios::trunc) << "[WINDOW]\r\n[SETUP] RENAMED_WINDOW C_TYPE_NORMAL 200 100\r\n";
+        FALCON_UI_EXPECT(falcon_ui::TextSearchIndex::Load(index_path, paths) == nullptr);
+        const auto rebuilt = falcon_ui::TextSearchIndex::Build(paths, 1);
+        FALCON_UI_EXPECT(rebuilt != nullptr && rebuilt->Save(index_path));
+        const auto reloaded = falcon_ui::TextSearchIndex::Load(index_path, paths);
+        FALCON_UI_EXPECT(reloaded != nullptr && reloaded->Search("renamed_window", 10).matches.size() == 1);
+        FALCON_UI_EXPECT(reloaded != nullptr && reloaded->Search("first_window", 10).matches.empty());
+        // The old index still searches its own copy of the texts.
+        FALCON_UI_EXPECT(loaded->Search("first_window", 10).matches.size() == 1);
+    }
+    // The previous generation is removed by the save, or by the next one where it was still mapped.
+    const auto files = std::distance(std::filesystem::directory_iterator(index_path.parent_path()), std::filesystem::directory_iterator());
+    FALCON_UI_EXPECT(files >= 1 && files <= 2);
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+}
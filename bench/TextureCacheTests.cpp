@@ -0,0 +1,228 @@
+// TextureCache on the stub backend (see StubTextureBackend.h), with synthetic resource archives: the decoding of the
+// image formats, the upload cap per frame and the evictions.
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ResourceArchive.h"
+#include "ScfCorpus.h"
+#include "StubTextureBackend.h"
+#include "TextureCache.h"
+#include "UnitTest.h"
+
+
+namespace {
+
+using falcon_ui::ResourceArchive;
+using falcon_ui::Texture;
+using falcon_ui::TextureCache;
+using falcon_ui::bench::ScfCorpusImage;
+using falcon_ui::bench::StubTextureBackend;
+
+// Writes the images to an archive of the temporary directory and opens it. nullptr on error.
+std::shared_ptr<const ResourceArchive> OpenArchive(const char* name, const std::vector<ScfCorpusImage>& images) {
+    const auto directory = std::filesystem::temp_directory_path() / "falcon_ui_tests_texture_cache";
+    std::filesystem::create_directories(directory);
+    const auto path = (directory / (std::string(name) + ".IDX")).string();
+    if (!falcon_ui::bench::WriteImageArchive(images, path)) return nullptr;
+    return ResourceArchive::Open(path);
+}
+
+// Frames using ids until their images are uploaded.
+void UploadAll(TextureCache& textures, const std::vector<std::string>& ids) {
+    do {
+        std::this_thread::yield();
+        textures.Update();
+        for (const auto& id : ids) textures.Find(id);
+    } while (textures.Pending());
+}
+
+// The pixel (x, y) of texture, in the texture itself or its atlas page.
+uint32_t Pixel(const StubTextureBackend& backend, const Texture& texture, int x, int y) {
+    const auto* pixels = backend.Find(texture.id);
+    if (pixels == nullptr) return 0xDEADBEEF;
+    const int left = static_cast<int>(texture.uv0.x * pixels->width);
+    const int top = static_cast<int>(texture.uv0.y * pixels->height);
+    return pixels->pixels[static_cast<size_t>(top + y) * pixels->width + left + x];
+}
+
+}  // namespace
+
+FALCON_UI_TEST(TextureCache, DecodesImages) {
+    // Pixel i of the 16 bit images has color i, pixel i of the 8 bit ones palette color i % 256 (see ScfCorpusImage).
+    const auto archive = OpenArchive("decode", {
+        { "IMAGE_16", 300, 220, true, false },
+        { "IMAGE_16_KEYED", 300, 220, true, true },
+        { "IMAGE_8", 300, 220, false, false },
+        { "SMALL_16", 16, 16, true, false },
+    });
+    FALCON_UI_EXPECT(archive != nullptr);
+    if (archive == nullptr) return;
+    StubTextureBackend backend;
+    TextureCache textures(backend);
+    textures.SetArchives({ archive });
+    const std::vector<std::string> ids = { "IMAGE_16", "IMAGE_16_KEYED", "IMAGE_8", "SMALL_16" };
+    UploadAll(textures, ids);
+
+    const auto* image_16 = textures.Find("IMAGE_16");
+    FALCON_UI_EXPECT(image_16 != nullptr && image_16->width == 300 && image_16->height == 220 && image_16->id != nullptr);
+    // RGB565 to RGBA, red in the low byte: red 0xF800, green 0x07E0, blue 0x001F, magenta 0xF81F.
+    FALCON_UI_EXPECT(Pixel(backend, *image_16, 0, 0) == 0xFF000000u);
+    FALCON_UI_EXPECT(Pixel(backend, *image_16, 0xF800 % 300, 0xF800 / 300) == 0xFF0000FFu);
+    FALCON_UI_EXPECT(Pixel(backend, *image_16, 0x07E0 % 300, 0x07E0 / 300) == 0xFF00FF00u);
+    FALCON_UI_EXPECT(Pixel(backend, *image_16, 0x001F, 0) == 0xFFFF0000u);
+    FALCON_UI_EXPECT(Pixel(backend, *image_16, 0xF81F % 300, 0xF81F / 300) == 0xFFFF00FFu);
+
+    const auto* keyed = textures.Find("IMAGE_16_KEYED");
+    FALCON_UI_EXPECT(keyed != nullptr && Pixel(backend, *keyed, 0xF81F % 300, 0xF81F / 300) == 0);
+    FALCON_UI_EXPECT(keyed != nullptr && Pixel(backend, *keyed, 0xF800 % 300, 0xF800 / 300) == 0xFF0000FFu);
+
+    const auto* image_8 = textures.Find("IMAGE_8");
+    FALCON_UI_EXPECT(image_8 != nullptr && Pixel(backend, *image_8, 0x1F, 0) == 0xFFFF0000u);
+    FALCON_UI_EXPECT(image_8 != nullptr && Pixel(backend, *image_8, (512 + 0x1F) % 300, 1) == 0xFFFF0000u);
+
+    // In the atlas, on the page of its placement.
+    const auto* small = textures.Find("SMALL_16");
+    FALCON_UI_EXPECT(small != nullptr && textures.GetStats().atlas_pages == 1);
+    FALCON_UI_EXPECT(small != nullptr && Pixel(backend, *small, 0x1F % 16, 0x1F / 16) == 0xFFFF0000u);
+
+    FALCON_UI_EXPECT(textures.Find("NOT_IN_THE_ARCHIVE") == nullptr);
+    FALCON_UI_EXPECT(backend.bad_calls == 0);
+}
+
+FALCON_UI_TEST(TextureCache, CapsTheUploadsPerFrame) {
+    // 1 MB each, 16 fit in the 16 MB a frame uploads.
+    std::vector<ScfCorpusImage> images;
+    std::vector<std::string> ids;
+    for (int i = 0; i < 40; ++i) {
+        ids.push_back("LARGE_" + std::to_string(i));
+        images.push_back({ ids.back(), 512, 512, true, false });
+    }
+    const auto archive = OpenArchive("upload_cap", images);
+    FALCON_UI_EXPECT(archive != nullptr);
+    if (archive == nullptr) return;
+    StubTextureBackend backend;
+    TextureCache textures(backend);
+    textures.SetArchives({ archive });
+    size_t frames = 0;
+    uint64_t creates = 0;
+    do {
+        std::this_thread::yield();
+        textures.Update();
+        FALCON_UI_EXPECT(backend.creates - creates <= 16);
+        frames += backend.creates > creates;
+        creates = backend.creates;
+        for (const auto& id : ids) textures.Find(id);
+    } while (textures.Pending());
+    FALCON_UI_EXPECT(backend.creates == 40 && frames >= 3);
+    FALCON_UI_EXPECT(textures.GetStats().uploads == 40);
+}
+
+FALCON_UI_TEST(TextureCache, EvictsTheLeastRecentlyUsed) {
+    // Too large for the atlas, 240000 bytes each. The budget holds 3.
+    const auto archive = OpenArchive("lru", {
+        { "A", 300, 200, true, false },
+        { "B", 300, 200, true, false },
+        { "C", 300, 200, true, false },
+        { "D", 300, 200, true, false },
+    });
+    FALCON_UI_EXPECT(archive != nullptr);
+    if (archive == nullptr) return;
+    StubTextureBackend backend;
+    TextureCache textures(backend, 3 * 240000);
+    textures.SetArchives({ archive });
+    // Over the budget, but all used in the last frame: kept.
+    UploadAll(textures, { "A", "B", "C", "D" });
+    textures.Update();
+    FALCON_UI_EXPECT(backend.Live() == 4 && textures.GetStats().evictions == 0);
+    const auto a = textures.Find("A")->id;
+    const auto b = textures.Find("B")->id;
+    textures.Find("C");
+    textures.Find("D");
+
+    // B, C and D are used, not A.
+    textures.Update();
+    textures.Find("B");
+    textures.Find("C");
+    textures.Find("D");
+    textures.Update();
+    FALCON_UI_EXPECT(backend.Find(a) == nullptr && backend.Find(b) != nullptr);
+    FALCON_UI_EXPECT(backend.Live() == 3 && textures.GetStats().evictions == 1);
+    FALCON_UI_EXPECT(textures.GetStats().bytes == 3 * 240000);
+    // Asked for again, it decodes again.
+    const auto* again = textures.Find("A");
+    FALCON_UI_EXPECT(again != nullptr && again->id == nullptr && textures.Pending());
+    UploadAll(textures, { "A" });
+    // Now the others were not used in the last frame, the least recently used go until A fits.
+    FALCON_UI_EXPECT(backend.Find(b) == nullptr && backend.Live() == 3);
+    FALCON_UI_EXPECT(backend.bad_calls == 0);
+}
+
+FALCON_UI_TEST(TextureCache, EvictsAtlasPages) {
+    const auto archive = OpenArchive("pages", {
+        { "SMALL_A", 64, 64, true, false },
+        { "SMALL_B", 32, 32, false, false },
+    });
+    FALCON_UI_EXPECT(archive != nullptr);
+    if (archive == nullptr) return;
+    StubTextureBackend backend;
+    TextureCache textures(backend, 0);
+    textures.SetArchives({ archive });
+    UploadAll(textures, { "SMALL_A", "SMALL_B" });
+    FALCON_UI_EXPECT(textures.GetStats().atlas_pages == 1 && backend.Live() == 1);
+
+    // The page is kept while one of its images is used.
+    textures.Update();
+    textures.Find("SMALL_B");
+    textures.Update();
+    FALCON_UI_EXPECT(textures.GetStats().atlas_pages == 1 && textures.GetStats().entries == 2);
+
+    // Then destroyed with all its images.
+    textures.Update();
+    FALCON_UI_EXPECT(textures.GetStats().atlas_pages == 0 && textures.GetStats().entries == 0 && textures.GetStats().evictions == 1);
+    FALCON_UI_EXPECT(backend.Live() == 0 && backend.bad_calls == 0);
+}
+
+FALCON_UI_TEST(TextureCache, CapsTheMissingIds) {
+    const auto archive = OpenArchive("missing", { { "PRESENT", 16, 16, true, false } });
+    FALCON_UI_EXPECT(archive != nullptr);
+    if (archive == nullptr) return;
+    StubTextureBackend backend;
+    TextureCache textures(backend);
+    textures.SetArchives({ archive });
+    for (int i = 0; i < 3000; ++i) FALCON_UI_EXPECT(textures.Find("MISSING_" + std::to_string(i)) == nullptr);
+    UploadAll(textures, { "PRESENT" });
+    // Well under the budget, they take no memory, but only the most recent ones stay.
+    const auto entries = textures.GetStats().entries;
+    FALCON_UI_EXPECT(entries > 1 && entries <= 1025);
+    FALCON_UI_EXPECT(textures.Find("PRESENT") != nullptr && textures.Find("PRESENT")->id != nullptr);
+}
+
+FALCON_UI_TEST(TextureCache, SetArchivesDoesNotWaitForTheDecodes) {
+    std::vector<ScfCorpusImage> images;
+    std::vector<std::string> ids;
+    for (int i = 0; i < 64; ++i) {
+        ids.push_back("IMAGE_" + std::to_string(i));
+        images.push_back({ ids.back(), 256, 256, i % 2 == 0, false });
+    }
+    auto archive = OpenArchive("switch", images);
+    FALCON_UI_EXPECT(archive != nullptr);
+    if (archive == nullptr) return;
+    const std::weak_ptr<const ResourceArchive> weak_archive = archive;
+    StubTextureBackend backend;
+    TextureCache textures(backend);
+    textures.SetArchives({ std::move(archive) });
+    for (const auto& id : ids) textures.Find(id);
+    textures.SetArchives({});
+    FALCON_UI_EXPECT(textures.GetStats().entries == 0);
+    // The decodes still running keep the archive they read, Update lets it go once they finish.
+    while (textures.Pending()) {
+        std::this_thread::yield();
+        textures.Update();
+    }
+    FALCON_UI_EXPECT(weak_archive.expired());
+    FALCON_UI_EXPECT(backend.creates == 0 && backend.bad_calls == 0);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vector>
+
+
+// A minimal test registry for the ctest targets of this directory, so the tests build wherever the benchmarks do with
+// nothing but the standard library:
+//   FALCON_UI_TEST(Suite, Name) {
+//       FALCON_UI_EXPECT(condition);
+//   }
+// falcon_ui_tests runs the tests of the suite given as its argument (all of them without), ctest runs one suite per test.
+namespace falcon_ui::test {
+
+struct TestCase {
+    const char* suite;
+    const char* name;
+    void (*function)();
+};
+
+std::vector<TestCase>& Registry();
+
+struct Registrar {
+    Registrar(const char* suite, const char* name, void (*function)()) { Registry().push_back({ suite, name, function }); }
+};
+
+// Reports a failed expectation, the test goes on.
+void Fail(const char* file, int line, const char* expression);
+
+}  // namespace falcon_ui::test
+
+#define FALCON_UI_TEST(suite, name)                                                                        \
+    static void suite##_##name();                                                                          \
+    static const falcon_ui::test::Registrar suite##_##name##_registrar(#suite, #name, &suite##_##name);    \
+    static void suite##_##name()
+
+#define FALCON_UI_EXPECT(condition)                                              \
+    do {                                                                         \
+        if (!(condition)) falcon_ui::test::Fail(__FILE__, __LINE__, #condition); \
+    } while (false)
@@ -0,0 +1,51 @@
+// Runs the tests registered with FALCON_UI_TEST (see UnitTest.h).
+//
+//   falcon_ui_tests [SUITE]
+//
+// Prints one line per test and returns 1 if any expectation failed.
+
+#include <cstdio>
+#include <cstring>
+
+#include "UnitTest.h"
+
+
+namespace falcon_ui::test {
+
+namespace {
+int g_failures = 0;
+}  // namespace
+
+std::vector<TestCase>& Registry() {
+    static std::vector<TestCase> registry;
+    return registry;
+}
+
+void Fail(const char* file, int line, const char* expression) {
+    ++g_failures;
+    std::fprintf(stderr, "%s:%d: expected %s\n", file, line, expression);
+}
+
+}  // namespace falcon_ui::test
+
+
+int main(int argc, char** argv) {
+    using namespace falcon_ui::test;
+    const char* suite = argc > 1 ? argv[1] : nullptr;
+    int run = 0, failed = 0;
+    for (const auto& test : Registry()) {
+        if (suite != nullptr && std::strcmp(suite, test.suite) != 0) continue;
+        const int failures = g_failures;
+        test.function();
+        ++run;
+        const bool passed = g_failures == failures;
+        failed += !passed;
+        std::printf("[%s] %s.%s\n", passed ? "  OK  " : " FAIL ", test.suite, test.name);
+    }
+    if (run == 0) {
+        std::fprintf(stderr, "No tests in suite %s\n", suite != nullptr ? suite : "(all)");
+        return 1;
+    }
+    std::printf("%d tests, %d failed\n", run, failed);
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,635 @@
+// dear imgui: Renderer Backend for a CPU rasterizer (no GPU, no graphics API)
+// Renders ImDrawData into a 32-bit framebuffer in memory, for previews, thumbnails and tests on machines without a GPU.
+// This can be used without a Platform Backend: set io.DisplaySize (and io.DeltaTime) yourself before ImGui::NewFrame().
+
+// Implemented features:
+//  [X] Renderer: User texture binding. Use 'ImGui_ImplSoftraster_Texture*' as ImTextureID. Read the FAQ about ImTextureID!
+//  [X] Renderer: Support for large meshes (64k+ vertices) with 16-bit indices, and 32-bit indices (ImDrawIdx).
+//  [X] Renderer: Textured (nearest filtering), alpha blended triangles with clip rectangles.
+
+// How it works:
+// - The triangles of all the draw lists are set up once per frame: edge equations and attribute (color, uv) planes,
+//   with the bounding box clipped by the clip rectangle and the framebuffer.
+// - Each triangle is binned to the tiles it overlaps, keeping the submission order in every tile.
+// - The tiles are rendered in parallel, each by one thread, so no pixel is ever shared between threads.
+//   Inside a tile the triangles are rasterized kLanes pixels at a time (4 with SSE2, 8 with AVX2).
+// - Blending matches imgui_impl_dx11: color = src * src_alpha + dst * (1 - src_alpha), alpha = src_alpha + dst_alpha * (1 - src_alpha).
+// - Pixel centers are at +0.5 and shared edges follow the top-left rule, so the two triangles of a quad never blend the
+//   same pixel twice.
+// - User callbacks are called while setting up the triangles, before any pixel is drawn.
+
+#include "imgui.h"
+#include "imgui_impl_softraster.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <math.h>
+#include <mutex>
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX2__)
+#define IMGUI_SOFTRASTER_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMGUI_SOFTRASTER_SSE2
+#include <emmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// SIMD helpers
+//-----------------------------------------------------------------------------
+
+namespace
+{
+
+#if defined(IMGUI_SOFTRASTER_AVX2)
+
+constexpr int kLanes = 8;
+typedef __m256  VecF;
+typedef __m256i VecI;
+
+inline VecF  VSet(float f)                  { return _mm256_set1_ps(f); }
+inline VecF  VLaneOffsets()                 { return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+inline VecF  VAdd(VecF a, VecF b)           { return _mm256_add_ps(a, b); }
+inline VecF  VSub(VecF a, VecF b)           { return _mm256_sub_ps(a, b); }
+inline VecF  VMul(VecF a, VecF b)           { return _mm256_mul_ps(a, b); }
+inline VecF  VMin(VecF a, VecF b)           { return _mm256_min_ps(a, b); }
+inline VecF  VMax(VecF a, VecF b)           { return _mm256_max_ps(a, b); }
+inline VecF  VCmpGt(VecF a, VecF b)         { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline VecF  VCmpEq(VecF a, VecF b)         { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+inline VecF  VAnd(VecF a, VecF b)           { return _mm256_and_ps(a, b); }
+inline VecF  VOr(VecF a, VecF b)            { return _mm256_or_ps(a, b); }
+inline int   VMoveMask(VecF a)              { return _mm256_movemask_ps(a); }
+inline VecI  VRound(VecF a)                 { return _mm256_cvtps_epi32(a); }
+inline VecI  VTruncate(VecF a)              { return _mm256_cvttps_epi32(a); }
+inline VecF  VToFloat(VecI a)               { return _mm256_cvtepi32_ps(a); }
+inline VecI  VSetI(int i)                   { return _mm256_set1_epi32(i); }
+inline VecI  VAndI(VecI a, VecI b)          { return _mm256_and_si256(a, b); }
+inline VecI  VOrI(VecI a, VecI b)           { return _mm256_or_si256(a, b); }
+inline VecI  VShiftRight(VecI a, int n)     { return _mm256_srli_epi32(a, n); }
+inline VecI  VShiftLeft(VecI a, int n)      { return _mm256_slli_epi32(a, n); }
+inline VecI  VLoad(const ImU32* p)          { return _mm256_loadu_si256((const __m256i*)p); }
+inline void  VStore(ImU32* p, VecI a)       { _mm256_storeu_si256((__m256i*)p, a); }
+inline VecI  VGather(const ImU32* base, VecI index) { return _mm256_i32gather_epi32((const int*)base, index, 4); }
+
+#elif defined(IMGUI_SOFTRASTER_SSE2)
+
+constexpr int kLanes = 4;
+typedef __m128  VecF;
+typedef __m128i VecI;
+
+inline VecF  VSet(float f)                  { return _mm_set1_ps(f); }
+inline VecF  VLaneOffsets()                 { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+inline VecF  VAdd(VecF a, VecF b)           { return _mm_add_ps(a, b); }
+inline VecF  VSub(VecF a, VecF b)           { return _mm_sub_ps(a, b); }
+inline VecF  VMul(VecF a, VecF b)           { return _mm_mul_ps(a, b); }
+inline VecF  VMin(VecF a, VecF b)           { return _mm_min_ps(a, b); }
+inline VecF  VMax(VecF a, VecF b)           { return _mm_max_ps(a, b); }
+inline VecF  VCmpGt(VecF a, VecF b)         { return _mm_cmpgt_ps(a, b); }
+inline VecF  VCmpEq(VecF a, VecF b)         { return _mm_cmpeq_ps(a, b); }
+inline VecF  VAnd(VecF a, VecF b)           { return _mm_and_ps(a, b); }
+inline VecF  VOr(VecF a, VecF b)            { return _mm_or_ps(a, b); }
+inline int   VMoveMask(VecF a)              { return _mm_movemask_ps(a); }
+inline VecI  VRound(VecF a)                 { return _mm_cvtps_epi32(a); }
+inline VecI  VTruncate(VecF a)              { return _mm_cvttps_epi32(a); }
+inline VecF  VToFloat(VecI a)               { return _mm_cvtepi32_ps(a); }
+inline VecI  VSetI(int i)                   { return _mm_set1_epi32(i); }
+inline VecI  VAndI(VecI a, VecI b)          { return _mm_and_si128(a, b); }
+inline VecI  VOrI(VecI a, VecI b)           { return _mm_or_si128(a, b); }
+inline VecI  VShiftRight(VecI a, int n)     { return _mm_srli_epi32(a, n); }
+inline VecI  VShiftLeft(VecI a, int n)      { return _mm_slli_epi32(a, n); }
+inline VecI  VLoad(const ImU32* p)          { return _mm_loadu_si128((const __m128i*)p); }
+inline void  VStore(ImU32* p, VecI a)       { _mm_storeu_si128((__m128i*)p, a); }
+inline VecI  VGather(const ImU32* base, VecI index)
+{
+    alignas(16) int32_t i[4];
+    _mm_store_si128((__m128i*)i, index);
+    return _mm_setr_epi32((int)base[i[0]], (int)base[i[1]], (int)base[i[2]], (int)base[i[3]]);
+}
+
+#else
+
+// Portable fallback, plain loops the compiler may vectorize.
+constexpr int kLanes = 4;
+struct VecF { float v[kLanes]; };
+struct VecI { uint32_t v[kLanes]; };
+
+#define IMGUI_SOFTRASTER_LANES(EXPR) for (int l = 0; l < kLanes; l++) { EXPR; }
+inline uint32_t MaskBits(bool b)            { return b ? 0xFFFFFFFFu : 0u; }
+inline float BitsToFloat(uint32_t u)        { float f; memcpy(&f, &u, 4); return f; }
+inline uint32_t FloatToBits(float f)        { uint32_t u; memcpy(&u, &f, 4); return u; }
+
+inline VecF  VSet(float f)                  { VecF r; IMGUI_SOFTRASTER_LANES(r.v[l] = f) return r; }
+inline VecF  VLaneOffsets()                 { VecF r; IMGUI_SOFTRASTER_LANES(r.v[l] = (float)l) return r; }
+inline VecF  VAdd(VecF a, VecF b)           { VecF r; IMGUI_SOFTRASTER_LANES(r.v[l] = a.v[l] + b.v[l]) return r; }
+inline VecF  VSub(VecF a, VecF b)           { VecF r; IMGUI_SOFTRASTER_LANES(r.v[l] = a.v[l] - b.v[l]) return r; }
+inline VecF  VMul(VecF a, VecF b)           { VecF r; IMGUI_SOFTRASTER_LANES(r.v[l] = a.v[l] * b.v[l]) return r; }
+inline VecF  VMin(VecF a, VecF b)           { VecF r; IMGUI_SOFTRASTER_LANES(r.v[l] = a.v[l] < b.v[l] ? a.v[l] : b.v[l]) return r; }
+inline VecF  VMax(VecF a, VecF b)           { VecF r; IMGUI_SOFTRASTER_LANES(r.v[l] = a.v[l] > b.v[l] ? a.v[l] : b.v[l]) return r; }
+inline VecF  VCmpGt(VecF a, VecF b)         { VecF r; IMGUI_SOFTRASTER_LANES(r.v[l] = BitsToFloat(MaskBits(a.v[l] > b.v[l]))) return r; }
+inline VecF  VCmpEq(VecF a, VecF b)         { VecF r; IMGUI_SOFTRASTER_LANES(r.v[l] = BitsToFloat(MaskBits(a.v[l] == b.v[l]))) return r; }
+inline VecF  VAnd(VecF a, VecF b)           { VecF r; IMGUI_SOFTRASTER_LANES(r.v[l] = BitsToFloat(FloatToBits(a.v[l]) & FloatToBits(b.v[l]))) return r; }
+inline VecF  VOr(VecF a, VecF b)            { VecF r; IMGUI_SOFTRASTER_LANES(r.v[l] = BitsToFloat(FloatToBits(a.v[l]) | FloatToBits(b.v[l]))) return r; }
+inline int   VMoveMask(VecF a)              { int r = 0; IMGUI_SOFTRASTER_LANES(r |= (int)(FloatToBits(a.v[l]) >> 31) << l) return r; }
+inline VecI  VRound(VecF a)                 { VecI r; IMGUI_SOFTRASTER_LANES(r.v[l] = (uint32_t)(int32_t)lrintf(a.v[l])) return r; }
+inline VecI  VTruncate(VecF a)              { VecI r; IMGUI_SOFTRASTER_LANES(r.v[l] = (uint32_t)(int32_t)a.v[l]) return r; }
+inline VecF  VToFloat(VecI a)               { VecF r; IMGUI_SOFTRASTER_LANES(r.v[l] = (float)(int32_t)a.v[l]) return r; }
+inline VecI  VSetI(int i)                   { VecI r; IMGUI_SOFTRASTER_LANES(r.v[l] = (uint32_t)i) return r; }
+inline VecI  VAndI(VecI a, VecI b)          { VecI r; IMGUI_SOFTRASTER_LANES(r.v[l] = a.v[l] & b.v[l]) return r; }
+inline VecI  VOrI(VecI a, VecI b)           { VecI r; IMGUI_SOFTRASTER_LANES(r.v[l] = a.v[l] | b.v[l]) return r; }
+inline VecI  VShiftRight(VecI a, int n)     { VecI r; IMGUI_SOFTRASTER_LANES(r.v[l] = a.v[l] >> n) return r; }
+inline VecI  VShiftLeft(VecI a, int n)      { VecI r; IMGUI_SOFTRASTER_LANES(r.v[l] = a.v[l] << n) return r; }
+inline VecI  VLoad(const ImU32* p)          { VecI r; IMGUI_SOFTRASTER_LANES(r.v[l] = p[l]) return r; }
+inline void  VStore(ImU32* p, VecI a)       { IMGUI_SOFTRASTER_LANES(p[l] = a.v[l]) }
+inline VecI  VGather(const ImU32* base, VecI index) { VecI r; IMGUI_SOFTRASTER_LANES(r.v[l] = base[index.v[l]]) return r; }
+#undef IMGUI_SOFTRASTER_LANES
+
+#endif
+
+template<typename T> inline T Min(T a, T b) { return a < b ? a : b; }
+template<typename T> inline T Max(T a, T b) { return a > b ? a : b; }
+// Also maps NaN to lo, so the result is always safe to convert to int.
+inline int ClampToInt(float f, int lo, int hi) { return f >= (float)hi ? hi : (f > (float)lo ? (int)f : lo); }
+
+inline VecF VMaskFromBool(bool b)           { return VCmpGt(VSet(b ? 1.0f : 0.0f), VSet(0.5f)); }
+inline VecF VUnpackChannel(VecI pixels, int channel) { return VToFloat(VAndI(VShiftRight(pixels, channel * 8), VSetI(0xFF))); }
+
+inline VecI VPack(VecF r, VecF g, VecF b, VecF a)
+{
+    const VecF zero = VSet(0.0f), max = VSet(255.0f);
+    const VecI ri = VRound(VMin(VMax(r, zero), max));
+    const VecI gi = VRound(VMin(VMax(g, zero), max));
+    const VecI bi = VRound(VMin(VMax(b, zero), max));
+    const VecI ai = VRound(VMin(VMax(a, zero), max));
+    return VOrI(VOrI(ri, VShiftLeft(gi, 8)), VOrI(VShiftLeft(bi, 16), VShiftLeft(ai, 24)));
+}
+
+// Tiles are a multiple of kLanes wide, so the pixel groups of a tile never touch another tile.
+constexpr int kTileSize = 64;
+static_assert(kTileSize % kLanes == 0, "Tiles must be made of whole pixel groups");
+
+enum TriangleAttribute { Attr_R, Attr_G, Attr_B, Attr_A, Attr_U, Attr_V, Attr_COUNT };
+
+enum TriangleFlags
+{
+    TriangleFlags_ConstantColor = 1 << 0,   // Same color on the 3 vertices.
+    TriangleFlags_Textured      = 1 << 1,   // The texture is sampled per pixel (otherwise it is folded in the color).
+};
+
+// Everything is relative to the first vertex (Ref), which keeps the float math precise far from the origin.
+struct Triangle
+{
+    float   RefX, RefY;
+    // Edge functions w = A * dx + B * dy + C, positive inside.
+    float   EdgeA[3], EdgeB[3], EdgeC[3];
+    bool    EdgeInclusive[3];           // Top-left rule: pixels exactly on the edge belong to the triangle.
+    // Attribute planes: value = Dx * dx + Dy * dy + C. Colors are 0-255, uv are in texels.
+    float   AttrDx[Attr_COUNT], AttrDy[Attr_COUNT], AttrC[Attr_COUNT];
+    int     MinX, MinY, MaxX, MaxY;     // Pixels to test, clipped (max exclusive).
+    int     Flags;
+    const ImGui_ImplSoftraster_Texture* Texture;
+};
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+// Backend data
+//-----------------------------------------------------------------------------
+
+struct ImGui_ImplSoftraster_Data
+{
+    std::vector<ImU32>                  FontPixels;
+    ImGui_ImplSoftraster_Texture        FontTexture;
+    bool                                FontTextureCreated;
+
+    // Frame being rendered.
+    ImGui_ImplSoftraster_Framebuffer    Target;
+    std::vector<Triangle>               Triangles;
+    std::vector<std::vector<int>>       Bins;       // Triangle indices per tile, in submission order.
+    int                                 TilesX, TilesY;
+
+    // Worker threads, woken up once per frame.
+    std::vector<std::thread>            Workers;
+    std::mutex                          Mutex;
+    std::condition_variable             StartCondition;
+    std::condition_variable             DoneCondition;
+    unsigned                            Generation;
+    int                                 BusyWorkers;
+    bool                                Quit;
+    std::atomic<int>                    NextTile;
+
+    ImGui_ImplSoftraster_Data() : FontTexture(), FontTextureCreated(false), Target(), TilesX(0), TilesY(0), Generation(0), BusyWorkers(0), Quit(false), NextTile(0) {}
+};
+
+// Backend data stored in io.BackendRendererUserData to allow support for multiple Dear ImGui contexts
+static ImGui_ImplSoftraster_Data* ImGui_ImplSoftraster_GetBackendData()
+{
+    return ImGui::GetCurrentContext() ? (ImGui_ImplSoftraster_Data*)ImGui::GetIO().BackendRendererUserData : nullptr;
+}
+
+//-----------------------------------------------------------------------------
+// Triangle setup and binning
+//-----------------------------------------------------------------------------
+
+static ImU32 ImGui_ImplSoftraster_Sample(const ImGui_ImplSoftraster_Texture* texture, float u, float v)
+{
+    int x = (int)(u * texture->Width), y = (int)(v * texture->Height);
+    x = x < 0 ? 0 : (x >= texture->Width ? texture->Width - 1 : x);
+    y = y < 0 ? 0 : (y >= texture->Height ? texture->Height - 1 : y);
+    return texture->Pixels[y * texture->Width + x];
+}
+
+static void ImGui_ImplSoftraster_SetupTriangle(ImGui_ImplSoftraster_Data* bd, const ImDrawVert& v0, const ImDrawVert& v1, const ImDrawVert& v2,
+    const ImVec2& offset, const ImVec2& scale, int clip_x0, int clip_y0, int clip_x1, int clip_y1, const ImGui_ImplSoftraster_Texture* texture)
+{
+    const float x0 = (v0.pos.x - offset.x) * scale.x, y0 = (v0.pos.y - offset.y) * scale.y;
+    const float x1 = (v1.pos.x - offset.x) * scale.x - x0, y1 = (v1.pos.y - offset.y) * scale.y - y0;
+    const float x2 = (v2.pos.x - offset.x) * scale.x - x0, y2 = (v2.pos.y - offset.y) * scale.y - y0;
+    float area = x1 * y2 - x2 * y1;
+    if (area == 0.0f || !isfinite(area) || !isfinite(x0) || !isfinite(y0))
+        return;
+
+    // Pixels whose center (+0.5) is in the bounding box.
+    const float min_x = x0 + Min(0.0f, Min(x1, x2)), max_x = x0 + Max(0.0f, Max(x1, x2));
+    const float min_y = y0 + Min(0.0f, Min(y1, y2)), max_y = y0 + Max(0.0f, Max(y1, y2));
+    const int px0 = ClampToInt(ceilf(min_x - 0.5f), clip_x0, clip_x1);
+    const int py0 = ClampToInt(ceilf(min_y - 0.5f), clip_y0, clip_y1);
+    const int px1 = ClampToInt(floorf(max_x - 0.5f) + 1.0f, clip_x0, clip_x1);
+    const int py1 = ClampToInt(floorf(max_y - 0.5f) + 1.0f, clip_y0, clip_y1);
+    if (px0 >= px1 || py0 >= py1)
+        return;
+
+    Triangle t;
+    t.RefX = x0;
+    t.RefY = y0;
+    // Edges 1->2, 2->0 and 0->1 in coordinates relative to v0: w_i is the barycentric weight of vertex i times area.
+    t.EdgeA[0] = -(y2 - y1); t.EdgeB[0] = x2 - x1;  t.EdgeC[0] = -(t.EdgeA[0] * x1 + t.EdgeB[0] * y1);
+    t.EdgeA[1] = y2;         t.EdgeB[1] = -x2;      t.EdgeC[1] = 0.0f;
+    t.EdgeA[2] = -y1;        t.EdgeB[2] = x1;       t.EdgeC[2] = 0.0f;
+    if (area < 0.0f)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            t.EdgeA[i] = -t.EdgeA[i];
+            t.EdgeB[i] = -t.EdgeB[i];
+            t.EdgeC[i] = -t.EdgeC[i];
+        }
+        area = -area;
+    }
+    // With y down, the inside of a left edge is towards +x and the inside of a top edge towards +y.
+    for (int i = 0; i < 3; i++)
+        t.EdgeInclusive[i] = t.EdgeA[i] > 0.0f || (t.EdgeA[i] == 0.0f && t.EdgeB[i] > 0.0f);
+
+    const ImVec2 tex_size = texture ? ImVec2((float)texture->Width, (float)texture->Height) : ImVec2(0.0f, 0.0f);
+    float values[3][Attr_COUNT];
+    const ImDrawVert* vertices[3] = { &v0, &v1, &v2 };
+    for (int i = 0; i < 3; i++)
+    {
+        const ImU32 col = vertices[i]->col;
+        values[i][Attr_R] = (float)((col >> 0) & 0xFF);
+        values[i][Attr_G] = (float)((col >> 8) & 0xFF);
+        values[i][Attr_B] = (float)((col >> 16) & 0xFF);
+        values[i][Attr_A] = (float)((col >> 24) & 0xFF);
+        values[i][Attr_U] = vertices[i]->uv.x * tex_size.x;
+        values[i][Attr_V] = vertices[i]->uv.y * tex_size.y;
+    }
+
+    // value(p) = value0 + (value1 - value0) * w1 / area + (value2 - value0) * w2 / area
+    const float inv_area = 1.0f / area;
+    for (int a = 0; a < Attr_COUNT; a++)
+    {
+        const float d1 = (values[1][a] - values[0][a]) * inv_area, d2 = (values[2][a] - values[0][a]) * inv_area;
+        t.AttrDx[a] = d1 * t.EdgeA[1] + d2 * t.EdgeA[2];
+        t.AttrDy[a] = d1 * t.EdgeB[1] + d2 * t.EdgeB[2];
+        t.AttrC[a] = values[0][a] + d1 * t.EdgeC[1] + d2 * t.EdgeC[2];
+    }
+
+    t.Flags = 0;
+    if (v0.col == v1.col && v0.col == v2.col)
+        t.Flags |= TriangleFlags_ConstantColor;
+    t.Texture = texture;
+    if (texture)
+    {
+        if (v0.uv.x == v1.uv.x && v0.uv.x == v2.uv.x && v0.uv.y == v1.uv.y && v0.uv.y == v2.uv.y)
+        {
+            // Most of the UI (everything but text and images) samples the white pixel of the font atlas: fold the
+            // texel in the color planes.
+            const ImU32 texel = ImGui_ImplSoftraster_Sample(texture, v0.uv.x, v0.uv.y);
+            for (int a = Attr_R; a <= Attr_A; a++)
+            {
+                const float k = (float)((texel >> (a * 8)) & 0xFF) / 255.0f;
+                t.AttrDx[a] *= k;
+                t.AttrDy[a] *= k;
+                t.AttrC[a] *= k;
+            }
+        }
+        else
+        {
+            t.Flags |= TriangleFlags_Textured;
+        }
+    }
+    t.MinX = px0; t.MinY = py0; t.MaxX = px1; t.MaxY = py1;
+
+    const int index = (int)bd->Triangles.size();
+    bd->Triangles.push_back(t);
+    for (int ty = py0 / kTileSize; ty <= (py1 - 1) / kTileSize; ty++)
+        for (int tx = px0 / kTileSize; tx <= (px1 - 1) / kTileSize; tx++)
+            bd->Bins[ty * bd->TilesX + tx].push_back(index);
+}
+
+//-----------------------------------------------------------------------------
+// Rasterization
+//-----------------------------------------------------------------------------
+
+// Draws the part of t inside the tile [tile_x0, tile_x1) x [tile_y0, tile_y1).
+static void ImGui_ImplSoftraster_RasterizeTriangle(const ImGui_ImplSoftraster_Framebuffer& fb, const Triangle& t, int tile_x0, int tile_y0, int tile_x1, int tile_y1)
+{
+    const int x0 = Max(t.MinX, tile_x0), x1 = Min(t.MaxX, tile_x1);
+    const int y0 = Max(t.MinY, tile_y0), y1 = Min(t.MaxY, tile_y1);
+    if (x0 >= x1 || y0 >= y1)
+        return;
+    // Groups start at multiples of kLanes from the tile start.
+    const int group_x0 = tile_x0 + ((x0 - tile_x0) / kLanes) * kLanes;
+
+    const VecF zero = VSet(0.0f);
+    const VecF lane_offsets = VLaneOffsets();
+    const VecF first_x = VSet((float)x0), end_x = VSet((float)x1);
+    const VecF center_offset = VSet(0.5f - t.RefX);
+    VecF edge_a[3], edge_inclusive[3];
+    for (int i = 0; i < 3; i++)
+    {
+        edge_a[i] = VSet(t.EdgeA[i]);
+        edge_inclusive[i] = VMaskFromBool(t.EdgeInclusive[i]);
+    }
+    VecF attr_dx[Attr_COUNT];
+    for (int a = 0; a < Attr_COUNT; a++)
+        attr_dx[a] = VSet(t.AttrDx[a]);
+    const bool constant_color = (t.Flags & TriangleFlags_ConstantColor) != 0;
+    const bool textured = (t.Flags & TriangleFlags_Textured) != 0;
+    const VecF inv_255 = VSet(1.0f / 255.0f), one = VSet(1.0f);
+
+    for (int y = y0; y < y1; y++)
+    {
+        const float dy = (float)y + 0.5f - t.RefY;
+        VecF edge_row[3], attr_row[Attr_COUNT];
+        for (int i = 0; i < 3; i++)
+            edge_row[i] = VSet(t.EdgeB[i] * dy + t.EdgeC[i]);
+        for (int a = 0; a < Attr_COUNT; a++)
+            attr_row[a] = VSet(t.AttrDy[a] * dy + t.AttrC[a]);
+        ImU32* row = fb.Pixels + (size_t)y * fb.Stride;
+
+        for (int gx = group_x0; gx < x1; gx += kLanes)
+        {
+            const VecF px = VAdd(VSet((float)gx), lane_offsets);
+            const VecF dx = VAdd(px, center_offset);
+            VecF inside = VAnd(VOr(VCmpGt(px, first_x), VCmpEq(px, first_x)), VCmpGt(end_x, px));
+            for (int i = 0; i < 3; i++)
+            {
+                const VecF w = VAdd(VMul(edge_a[i], dx), edge_row[i]);
+                inside = VAnd(inside, VOr(VCmpGt(w, zero), VAnd(VCmpEq(w, zero), edge_inclusive[i])));
+            }
+            if (VMoveMask(inside) == 0)
+                continue;
+
+            VecF r, g, b, a;
+            if (constant_color)
+            {
+                r = attr_row[Attr_R]; g = attr_row[Attr_G]; b = attr_row[Attr_B]; a = attr_row[Attr_A];
+            }
+            else
+            {
+                r = VAdd(VMul(attr_dx[Attr_R], dx), attr_row[Attr_R]);
+                g = VAdd(VMul(attr_dx[Attr_G], dx), attr_row[Attr_G]);
+                b = VAdd(VMul(attr_dx[Attr_B], dx), attr_row[Attr_B]);
+                a = VAdd(VMul(attr_dx[Attr_A], dx), attr_row[Attr_A]);
+            }
+            if (textured)
+            {
+                const VecF max_u = VSet((float)(t.Texture->Width - 1)), max_v = VSet((float)(t.Texture->Height - 1));
+                const VecF u = VMin(VMax(VAdd(VMul(attr_dx[Attr_U], dx), attr_row[Attr_U]), zero), max_u);
+                const VecF v = VMin(VMax(VAdd(VMul(attr_dx[Attr_V], dx), attr_row[Attr_V]), zero), max_v);
+                // Truncation is floor for the clamped, positive coordinates. The index fits a float exactly below 2^24 texels.
+                const VecF index = VAdd(VMul(VToFloat(VTruncate(v)), VSet((float)t.Texture->Width)), VToFloat(VTruncate(u)));
+                const VecI texels = VGather(t.Texture->Pixels, VTruncate(index));
+                r = VMul(r, VMul(VUnpackChannel(texels, 0), inv_255));
+                g = VMul(g, VMul(VUnpackChannel(texels, 1), inv_255));
+                b = VMul(b, VMul(VUnpackChannel(texels, 2), inv_255));
+                a = VMul(a, VMul(VUnpackChannel(texels, 3), inv_255));
+            }
+            // Pixels outside the triangle get a zero alpha, which leaves them untouched.
+            a = VAnd(a, inside);
+            const VecF alpha = VMul(a, inv_255);
+            const VecF inv_alpha = VSub(one, alpha);
+
+            ImU32* dst = row + gx;
+            const bool full_group = gx + kLanes <= fb.Width;
+            alignas(32) ImU32 partial[kLanes] = {};
+            if (!full_group)
+                memcpy(partial, dst, sizeof(ImU32) * (fb.Width - gx));
+            const VecI dst_pixels = VLoad(full_group ? dst : partial);
+            const VecI out = VPack(
+                VAdd(VMul(r, alpha), VMul(VUnpackChannel(dst_pixels, 0), inv_alpha)),
+                VAdd(VMul(g, alpha), VMul(VUnpackChannel(dst_pixels, 1), inv_alpha)),
+                VAdd(VMul(b, alpha), VMul(VUnpackChannel(dst_pixels, 2), inv_alpha)),
+                VAdd(a, VMul(VUnpackChannel(dst_pixels, 3), inv_alpha)));
+            if (full_group)
+            {
+                VStore(dst, out);
+            }
+            else
+            {
+                VStore(partial, out);
+                memcpy(dst, partial, sizeof(ImU32) * (fb.Width - gx));
+            }
+        }
+    }
+}
+
+// Renders tiles until there are none left. Called by the render thread and the workers.
+static void ImGui_ImplSoftraster_RenderTiles(ImGui_ImplSoftraster_Data* bd)
+{
+    const int tile_count = bd->TilesX * bd->TilesY;
+    for (int tile = bd->NextTile.fetch_add(1); tile < tile_count; tile = bd->NextTile.fetch_add(1))
+    {
+        const int tile_x0 = (tile % bd->TilesX) * kTileSize, tile_y0 = (tile / bd->TilesX) * kTileSize;
+        const int tile_x1 = Min(tile_x0 + kTileSize, bd->Target.Width), tile_y1 = Min(tile_y0 + kTileSize, bd->Target.Height);
+        for (int index : bd->Bins[tile])
+            ImGui_ImplSoftraster_RasterizeTriangle(bd->Target, bd->Triangles[index], tile_x0, tile_y0, tile_x1, tile_y1);
+    }
+}
+
+static void ImGui_ImplSoftraster_WorkerMain(ImGui_ImplSoftraster_Data* bd)
+{
+    unsigned generation = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(bd->Mutex);
+            bd->StartCondition.wait(lock, [&] { return bd->Quit || bd->Generation != generation; });
+            if (bd->Quit)
+                return;
+            generation = bd->Generation;
+        }
+        ImGui_ImplSoftraster_RenderTiles(bd);
+        std::lock_guard<std::mutex> lock(bd->Mutex);
+        if (--bd->BusyWorkers == 0)
+            bd->DoneCondition.notify_one();
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Functions
+//-----------------------------------------------------------------------------
+
+void ImGui_ImplSoftraster_RenderDrawData(ImDrawData* draw_data, const ImGui_ImplSoftraster_Framebuffer& framebuffer)
+{
+    ImGui_ImplSoftraster_Data* bd = ImGui_ImplSoftraster_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Did you call ImGui_ImplSoftraster_Init()?");
+    if (framebuffer.Pixels == nullptr || framebuffer.Width <= 0 || framebuffer.Height <= 0 || draw_data->TotalVtxCount == 0)
+        return;
+    IM_ASSERT(framebuffer.Stride >= framebuffer.Width);
+
+    bd->Target = framebuffer;
+    bd->TilesX = (framebuffer.Width + kTileSize - 1) / kTileSize;
+    bd->TilesY = (framebuffer.Height + kTileSize - 1) / kTileSize;
+    bd->Triangles.clear();
+    if ((int)bd->Bins.size() < bd->TilesX * bd->TilesY)
+        bd->Bins.resize(bd->TilesX * bd->TilesY);
+    for (std::vector<int>& bin : bd->Bins)
+        bin.clear();
+
+    // Will project scissor/clipping rectangles into framebuffer space
+    const ImVec2 clip_off = draw_data->DisplayPos;         // (0,0) unless using multi-viewports
+    const ImVec2 clip_scale = draw_data->FramebufferScale; // (1,1) unless using retina display which are often (2,2)
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+        {
+            const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
+            if (pcmd->UserCallback != nullptr)
+            {
+                // User callback, registered via ImDrawList::AddCallback()
+                // (ImDrawCallback_ResetRenderState is a special callback value used by the user to request the renderer to reset render state.)
+                // There is no render state to reset here.
+                if (pcmd->UserCallback != ImDrawCallback_ResetRenderState)
+                    pcmd->UserCallback(cmd_list, pcmd);
+                continue;
+            }
+
+            // Project scissor/clipping rectangles into framebuffer space
+            const int clip_x0 = ClampToInt((pcmd->ClipRect.x - clip_off.x) * clip_scale.x, 0, framebuffer.Width);
+            const int clip_y0 = ClampToInt((pcmd->ClipRect.y - clip_off.y) * clip_scale.y, 0, framebuffer.Height);
+            const int clip_x1 = ClampToInt((pcmd->ClipRect.z - clip_off.x) * clip_scale.x, 0, framebuffer.Width);
+            const int clip_y1 = ClampToInt((pcmd->ClipRect.w - clip_off.y) * clip_scale.y, 0, framebuffer.Height);
+            if (clip_x1 <= clip_x0 || clip_y1 <= clip_y0)
+                continue;
+
+            const ImGui_ImplSoftraster_Texture* texture = (const ImGui_ImplSoftraster_Texture*)pcmd->GetTexID();
+            const ImDrawVert* vtx = cmd_list->VtxBuffer.Data + pcmd->VtxOffset;
+            const ImDrawIdx* idx = cmd_list->IdxBuffer.Data + pcmd->IdxOffset;
+            for (unsigned int i = 0; i + 2 < pcmd->ElemCount; i += 3)
+                ImGui_ImplSoftraster_SetupTriangle(bd, vtx[idx[i]], vtx[idx[i + 1]], vtx[idx[i + 2]], clip_off, clip_scale, clip_x0, clip_y0, clip_x1, clip_y1, texture);
+        }
+    }
+    if (bd->Triangles.empty())
+        return;
+
+    // Wake the workers up and render along with them.
+    bd->NextTile = 0;
+    {
+        std::lock_guard<std::mutex> lock(bd->Mutex);
+        bd->BusyWorkers = (int)bd->Workers.size();
+        bd->Generation++;
+    }
+    bd->StartCondition.notify_all();
+    ImGui_ImplSoftraster_RenderTiles(bd);
+    std::unique_lock<std::mutex> lock(bd->Mutex);
+    bd->DoneCondition.wait(lock, [bd] { return bd->BusyWorkers == 0; });
+}
+
+bool ImGui_ImplSoftraster_CreateDeviceObjects()
+{
+    ImGui_ImplSoftraster_Data* bd = ImGui_ImplSoftraster_GetBackendData();
+    if (bd->FontTextureCreated)
+        ImGui_ImplSoftraster_InvalidateDeviceObjects();
+
+    // Build texture atlas
+    ImGuiIO& io = ImGui::GetIO();
+    unsigned char* pixels;
+    int width, height;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+    // The atlas may be rebuilt by the application, keep a copy.
+    bd->FontPixels.resize((size_t)width * height);
+    memcpy(bd->FontPixels.data(), pixels, bd->FontPixels.size() * sizeof(ImU32));
+    bd->FontTexture.Pixels = bd->FontPixels.data();
+    bd->FontTexture.Width = width;
+    bd->FontTexture.Height = height;
+    bd->FontTextureCreated = true;
+
+    // Store our identifier
+    io.Fonts->SetTexID((ImTextureID)&bd->FontTexture);
+    return true;
+}
+
+void ImGui_ImplSoftraster_InvalidateDeviceObjects()
+{
+    ImGui_ImplSoftraster_Data* bd = ImGui_ImplSoftraster_GetBackendData();
+    if (!bd || !bd->FontTextureCreated)
+        return;
+    bd->FontPixels.clear();
+    bd->FontTexture = ImGui_ImplSoftraster_Texture();
+    bd->FontTextureCreated = false;
+    ImGui::GetIO().Fonts->SetTexID(nullptr);
+}
+
+bool ImGui_ImplSoftraster_Init(int thread_count)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    IM_ASSERT(io.BackendRendererUserData == nullptr && "Already initialized a renderer backend!");
+
+    // Setup backend capabilities flags
+    ImGui_ImplSoftraster_Data* bd = IM_NEW(ImGui_ImplSoftraster_Data)();
+    io.BackendRendererUserData = (void*)bd;
+    io.BackendRendererName = "imgui_impl_softraster";
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;  // We can honor the ImDrawCmd::VtxOffset field, allowing for large meshes.
+
+    if (thread_count <= 0)
+        thread_count = Max(1, (int)std::thread::hardware_concurrency());
+    for (int i = 1; i < thread_count; i++)
+        bd->Workers.emplace_back(ImGui_ImplSoftraster_WorkerMain, bd);
+    return true;
+}
+
+void ImGui_ImplSoftraster_Shutdown()
+{
+    ImGui_ImplSoftraster_Data* bd = ImGui_ImplSoftraster_GetBackendData();
+    IM_ASSERT(bd != nullptr && "No renderer backend to shutdown, or already shutdown?");
+    ImGuiIO& io = ImGui::GetIO();
+
+    {
+        std::lock_guard<std::mutex> lock(bd->Mutex);
+        bd->Quit = true;
+    }
+    bd->StartCondition.notify_all();
+    for (std::thread& worker : bd->Workers)
+        worker.join();
+
+    ImGui_ImplSoftraster_InvalidateDeviceObjects();
+    io.BackendRendererName = nullptr;
+    io.BackendRendererUserData = nullptr;
+    IM_DELETE(bd);
+}
+
+void ImGui_ImplSoftraster_NewFrame()
+{
+    ImGui_ImplSoftraster_Data* bd = ImGui_ImplSoftraster_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Did you call ImGui_ImplSoftraster_Init()?");
+
+    if (!bd->FontTextureCreated)
+        ImGui_ImplSoftraster_CreateDeviceObjects();
+}
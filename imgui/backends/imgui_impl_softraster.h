@@ -0,0 +1,41 @@
+// dear imgui: Renderer Backend for a CPU rasterizer (no GPU, no graphics API)
+// Renders ImDrawData into a 32-bit framebuffer in memory, for previews, thumbnails and tests on machines without a GPU.
+// This can be used without a Platform Backend: set io.DisplaySize (and io.DeltaTime) yourself before ImGui::NewFrame().
+
+// Implemented features:
+//  [X] Renderer: User texture binding. Use 'ImGui_ImplSoftraster_Texture*' as ImTextureID. Read the FAQ about ImTextureID!
+//  [X] Renderer: Support for large meshes (64k+ vertices) with 16-bit indices, and 32-bit indices (ImDrawIdx).
+//  [X] Renderer: Textured (nearest filtering), alpha blended triangles with clip rectangles.
+// The inner loops use SSE2, or AVX2 when the compiler targets it (/arch:AVX2, -mavx2), with a portable fallback.
+// The framebuffer is split in tiles which are rendered by a pool of threads.
+
+#pragma once
+#include "imgui.h"      // IMGUI_IMPL_API
+
+// Pixels use the layout of ImU32 colors (see IM_COL32), alpha in the high byte. Rows are tightly packed.
+struct ImGui_ImplSoftraster_Texture
+{
+    const ImU32*    Pixels;
+    int             Width;
+    int             Height;
+};
+
+// Render target, same pixel layout as the textures. Rows are Stride pixels apart.
+struct ImGui_ImplSoftraster_Framebuffer
+{
+    ImU32*          Pixels;
+    int             Width;
+    int             Height;
+    int             Stride;
+};
+
+// thread_count: threads rendering the tiles (the calling one included), 0 for one per core.
+IMGUI_IMPL_API bool     ImGui_ImplSoftraster_Init(int thread_count = 0);
+IMGUI_IMPL_API void     ImGui_ImplSoftraster_Shutdown();
+IMGUI_IMPL_API void     ImGui_ImplSoftraster_NewFrame();
+// Blends draw_data over the framebuffer (clear it first if needed). Returns when the whole frame is rendered.
+IMGUI_IMPL_API void     ImGui_ImplSoftraster_RenderDrawData(ImDrawData* draw_data, const ImGui_ImplSoftraster_Framebuffer& framebuffer);
+
+// Use if you want to reset your rendering device without losing Dear ImGui state.
+IMGUI_IMPL_API void     ImGui_ImplSoftraster_InvalidateDeviceObjects();
+IMGUI_IMPL_API bool     ImGui_ImplSoftraster_CreateDeviceObjects();
@@ -1,10 +1,14 @@
 // Please keep headers sorted.
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 
+#ifdef _WIN32
 #define NOMINMAX
 #include <d3d11.h>
 #include <Windows.h>
@@ -12,35 +16,38 @@
 
 #include "backends/imgui_impl_dx11.h"
 #include "backends/imgui_impl_win32.h"
+#include "DiffPanel.h"
+#include "DiscoveryCatalog.h"
 #include "FalconWindow.h"
+#include "FileWatcher.h"
+#include "FrameProfiler.h"
+#include "FrameProfilerOverlay.h"
+#include "FrameScheduler.h"
 #include "Header.h"
 #include "imgui.h"
-
-
+#include "JobSystem.h"
+#include "ModelCache.h"
+#include "ResourceArchive.h"
+#include "ScfWriter.h"
+#include "TextSearchPanel.h"
+#include "TextureCache.h"
+#include "UsagesPanel.h"
+#endif
+#include "GenericUI.h"
+#include "HeadlessUI.h"
+#include "Tracing.h"
+
+
+#ifdef _WIN32
 // Forward declare message handler from imgui_impl_win32.cpp (outside of anonymous namespace). See imgui_impl_win32.h.
 extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam);
+#endif
 
 namespace {
 
-// The UI abstraction is contained here. Subclasses implement the look and feel.
-class GenericUI {
-public:
-  virtual ~GenericUI() {}
-
-  // Fires up any initialization of the UI and runs until the program ends.
-  virtual void Run() = 0;
-
-protected:
-  // Used for PickOptions.
-  struct SelectionState {
-    int selection = -1;
-    bool selected = false;
-  };
-
-private:
-  virtual std::string PickOption(SelectionState& selection_state, const std::string& title, const std::vector<std::string>& options) = 0;
-};
+using falcon_ui::GenericUI;
 
+#ifdef _WIN32
 // Data
 static ID3D11Device* g_pd3dDevice = nullptr;
 static ID3D11DeviceContext* g_pd3dDeviceContext = nullptr;
@@ -217,14 +224,27 @@ public:
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO();
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard; // Enable some options
+    {
+        // The renderer would build it on the first frame, built here it shows up on its own in the traces.
+        FALCON_UI_TRACE_SCOPE("Font atlas build");
+        io.Fonts->Build();
+    }
     // Initialize Platform + Renderer backends (here: using imgui_impl_win32.cpp + imgui_impl_dx11.cpp)
     ImGui_ImplWin32_Init(hwnd_);
     ImGui_ImplDX11_Init(g_pd3dDevice, g_pd3dDeviceContext);
+    texture_backend_ = std::make_unique<falcon_ui::D3D11TextureBackend>(g_pd3dDevice, g_pd3dDeviceContext);
+    texture_cache_ = std::make_unique<falcon_ui::TextureCache>(*texture_backend_);
 
     // Event loop.
     // Main loop
     bool done = false;
     while (!done) {
+        // Blocks until there is input, a watched file changed or ImGui needs another frame.
+        {
+            FALCON_UI_TRACE_SCOPE("WaitForNextFrame");
+            frame_scheduler_.WaitForNextFrame();
+        }
+
         // Poll and handle messages (inputs, window resize, etc.)
         // See the WndProc() function below for our to dispatch events to the Win32 backend.
         MSG msg;
@@ -238,9 +258,12 @@ public:
         }
 
         DoImGuiFrame();
+        RequestImGuiFrames();
     }
 
     // Cleanup
+    texture_cache_.reset();
+    texture_backend_.reset();
     ImGui_ImplDX11_Shutdown();
     ImGui_ImplWin32_Shutdown();
     ImGui::DestroyContext();
@@ -251,23 +274,49 @@ public:
   }
 
   void DoImGuiFrame() {
+    falcon_ui::FrameProfiler::Get().BeginFrame();
+    // Destroyed after run_on_exit, so the frame includes the rendering.
+    falcon_ui::ScopedFrameTimer frame_timer(falcon_ui::FramePhase::FRAME);
+    FALCON_UI_TRACE_SCOPE("Frame");
+
+    // Files edited since the last frame are reloaded before anything is drawn.
+    ReloadChangedFiles();
+
+    // The archives opened and the images decoded since the last frame, so nothing drawn this frame waits for them.
+    OpenArchives();
+    {
+        falcon_ui::ScopedFrameTimer timer(falcon_ui::FramePhase::TEXTURE_UPLOAD);
+        texture_cache_->Update();
+    }
+
     // Start the Dear ImGui frame
-    ImGui_ImplDX11_NewFrame();
-    ImGui_ImplWin32_NewFrame();
-    ImGui::NewFrame();
+    {
+        falcon_ui::ScopedFrameTimer timer(falcon_ui::FramePhase::NEW_FRAME);
+        ImGui_ImplDX11_NewFrame();
+        ImGui_ImplWin32_NewFrame();
+        ImGui::NewFrame();
+    }
 
     struct RunOnExit {
       RunOnExit(WindowUI& thiz) : thiz_(thiz) {}
       ~RunOnExit() {
+        FALCON_UI_TRACE_SCOPE("Render");
         ImGui::End();
 
         // Rendering
-        ImGui::Render();
+        {
+            falcon_ui::ScopedFrameTimer timer(falcon_ui::FramePhase::RENDER);
+            ImGui::Render();
+        }
         const float clear_color_with_alpha[4] = { thiz_.clear_color_.x * thiz_.clear_color_.w, thiz_.clear_color_.y * thiz_.clear_color_.w, thiz_.clear_color_.z * thiz_.clear_color_.w, thiz_.clear_color_.w };
-        g_pd3dDeviceContext->OMSetRenderTargets(1, &g_mainRenderTargetView, NULL);
-        g_pd3dDeviceContext->ClearRenderTargetView(g_mainRenderTargetView, clear_color_with_alpha);
-        ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
-        g_pSwapChain->Present(0, 0); // Present without vsync
+        {
+            falcon_ui::ScopedFrameTimer timer(falcon_ui::FramePhase::RENDER_DRAW_DATA);
+            g_pd3dDeviceContext->OMSetRenderTargets(1, &g_mainRenderTargetView, NULL);
+            g_pd3dDeviceContext->ClearRenderTargetView(g_mainRenderTargetView, clear_color_with_alpha);
+            ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
+        }
+        falcon_ui::ScopedFrameTimer timer(falcon_ui::FramePhase::PRESENT);
+        g_pSwapChain->Present(1, 0); // Present with vsync
       }
       WindowUI& thiz_;
     } run_on_exit(*this);
@@ -275,14 +324,42 @@ public:
     if (show_demo_window_) {
         ImGui::ShowDemoWindow(&show_demo_window_);
     }
+    if (show_frame_timing_) {
+        frame_profiler_overlay_.Draw(&show_frame_timing_);
+    }
+    if (show_usages_) {
+        usages_panel_.Draw(&show_usages_, falcon_install_dir_);
+    }
+    if (show_text_search_) {
+        text_search_panel_.Draw(&show_text_search_);
+    }
+    if (show_diff_) {
+        diff_panel_.Draw(&show_diff_, falcon_installs_, catalog_);
+    }
 
     // End will be called by run_on_exit destructor.
     ImGui::Begin("Falcon UI Editor");
 
     // Show a simple window that we create ourselves. We use a Begin/End pair to create a named window.
     {
+        falcon_ui::ScopedFrameTimer pick_flow_timer(falcon_ui::FramePhase::PICK_FLOW);
+
         // TODO remove this.
         ImGui::Checkbox("Demo Window", &show_demo_window_);      // Edit bools storing our window open/close state
+        ImGui::SameLine();
+        ImGui::Checkbox("Frame Timing", &show_frame_timing_);
+        ImGui::SameLine();
+        ImGui::Checkbox("Find Usages", &show_usages_);
+        ImGui::SameLine();
+        ImGui::Checkbox("Search Text", &show_text_search_);
+        ImGui::SameLine();
+        ImGui::Checkbox("Compare Theaters", &show_diff_);
+
+        const auto& frame_stats = frame_scheduler_.GetStats();
+        ImGui::Text("%.0f fps, CPU %.1f%%, idle %.0f%%", frame_stats.frames_per_second, frame_stats.cpu_usage * 100.0, frame_stats.idle_fraction * 100.0);
+        const auto texture_stats = texture_cache_->GetStats();
+        ImGui::Text("Textures: %zu MB of %zu MB (%zu atlas pages), %zu loading", texture_stats.bytes >> 20, texture_stats.budget >> 20, texture_stats.atlas_pages,
+            texture_stats.pending);
 
         if (ImGui::Button("Test Main")) {
             selected_install_state_.selected = true;
@@ -311,8 +388,7 @@ public:
           
         // Pick theater.
         if (!selected_theater_state_.selected) {
-        std::vector<std::string> theaters = ListTheaters(falcon_install_dir_);
-        falcon_theater_ = PickOption(selected_theater_state_, "Pick Theater", theaters);
+        falcon_theater_ = PickOption(selected_theater_state_, "Pick Theater", catalog_.Theaters(falcon_install_dir_));
         return;
         }
 
@@ -342,36 +418,76 @@ public:
         SetupWindow();
         return;
         } else {
-        window_.Draw();
+        falcon_ui::ScopedFrameTimer timer(falcon_ui::FramePhase::WINDOW_DRAW, window_label_);
+        window_.Draw(texture_cache_.get());
         }
+        DrawEditControls();
     }
   }
 
 private:
+  // The UI sets are the window lists found in the Art folder of the theater (see internal_resolution.h for the ones the
+  // game loads: LoadMainWindow, LoadTacticalWindows...).
   std::string PickUISet() {
-      // Hardcoded, see internal_resolution.h:
-      // static void LoadMainWindow();
-      // static void LoadTacticalWindows();
-      // static void LoadCampaignWindows();
-      // static void LoadDogFightWindows();
-      // static void LoadSetupWindows();
-      // static void LoadCampaignSelectWindows();
-      // static void LoadTacEngSelectWindows();
-      // static void LoadInstantActionWindows();
-      // static void LoadPlannerWindows();
-      // static void LoadTacticalReferenceWindows();
-      // static void LoadLogBookWindows();
-      // static void LoadCommWindows();
-      std::string data_dir = falcon_install_dir_ + DataDirForTheater(falcon_theater_);
-      std::vector<std::string> ui_set = {
-          "Main", "Tactical???", "Campaign", "Dogfight", "Setup", "Campaign Select", "Tactical Engagement", "Instant Action", "Planner", "Tactical Reference", "Logbook", "Comms"
-      };
-      return PickOption(selected_theater_state_, "Pick UI", ui_set);
+      return PickOption(selected_ui_set_state_, "Pick UI", catalog_.UISets(falcon_install_dir_ + DataDirForTheater(falcon_theater_)));
   }
 
-  // Picks a window of the UI set (for example, the main window is composed of several sets).
+  // Picks a window of the UI set (for example, the main window is composed of several sets). Shows the header of the
+  // window under the selection, which is loaded ahead in the preview lane, so it is often ready once picked.
   std::string PickWindow(const std::string& ui_set) {
-      return PickOption(selected_window_state_, "Pick Window", GetWindowList(falcon_install_dir_ + DataDirForTheater(falcon_theater_) + '\\', ui_set));
+      const auto& windows = catalog_.Windows(falcon_install_dir_ + DataDirForTheater(falcon_theater_), ui_set);
+      const auto picked = PickOption(selected_window_state_, "Pick Window", windows);
+      const auto selection = selected_window_state_.selection;
+      if (selection >= 0 && selection < static_cast<int>(windows.size())) {
+          const auto path = WindowPath(windows[selection]);
+          // Read from the first bytes of the file, the whole window is only loaded by the preview below.
+          if (const auto& header = catalog_.Header(path); header.has_value()) {
+              const auto& symbols = falcon_ui::SymbolTable::Global();
+              const auto label = symbols.Name(header->label);
+              const auto ctype = symbols.Name(header->ctype);
+              ImGui::Text("%.*s %.*s, %d x %d", static_cast<int>(label.size()), label.data(), static_cast<int>(ctype.size()), ctype.data(), header->width, header->height);
+          } else {
+              ImGui::TextUnformatted("Not a window");
+          }
+          if (path != preview_path_) {
+              // The load of the window selected before is of no use anymore. Cancelled rather than waited for here.
+              preview_load_.Cancel();
+              if (preview_load_.Valid()) cancelled_loads_.push_back(std::move(preview_load_));
+              preview_path_ = path;
+              preview_load_ = LoadWindowJob(falcon_ui::JobPriority::PREVIEW, path);
+          }
+      }
+      return picked;
+  }
+
+  // Moves the picked element of the shown window, and writes the window back to its file. Only edited elements are
+  // written from their records, the rest of the file is kept byte for byte (see ScfWriter.h).
+  void DrawEditControls() {
+      const auto& model = window_.Model();
+      if (model.elements.size() < 2) return;
+      ImGui::SliderInt("Element", &edit_element_, 1, static_cast<int>(model.elements.size()) - 1);
+      edit_element_ = std::clamp(edit_element_, 1, static_cast<int>(model.elements.size()) - 1);
+      const auto& element = model.elements[edit_element_];
+      const auto* setup = element.attribute_count > 0 ? &model.attributes[element.first_attribute] : nullptr;
+      if (setup != nullptr && setup->tag == falcon_ui::Tag::SETUP && setup->setup.int_count >= 2) {
+          int position[2] = { setup->setup.ints[0], setup->setup.ints[1] };
+          if (ImGui::InputInt2("Position", position, ImGuiInputTextFlags_EnterReturnsTrue)) {
+              window_.MoveElement(edit_element_, position[0], position[1]);
+          }
+      } else {
+          ImGui::TextUnformatted("The element has no position");
+      }
+
+      ImGui::BeginDisabled(!window_.Edited());
+      if (ImGui::Button("Save")) {
+          // The watcher then reloads the window from the written file, which clears the edits.
+          save_failed_ = !falcon_ui::SaveWindow(window_.Model(), window_.Source(), window_path_);
+      }
+      ImGui::EndDisabled();
+      if (save_failed_) {
+          ImGui::SameLine();
+          ImGui::TextUnformatted("Unable to save the window");
+      }
   }
 
   std::string PickOption(SelectionState& selection_state, const std::string& title, const std::vector<std::string>& options) override {
@@ -388,11 +504,111 @@ private:
     return "";
   }
 
+  std::string WindowPath(const std::string& window) const {
+      return NativePath(falcon_install_dir_ + DataDirForTheater(falcon_theater_) + "\\" + window);
+  }
+
+  // Loads the picked window in the interactive lane, taking over the preview load if it is the same window, and shows
+  // it once loaded. Called every frame until then.
   void SetupWindow() {
-      window_.SetupFromFile(falcon_install_dir_ + DataDirForTheater(falcon_theater_) + "\\" + window_selected_);
+      if (!window_load_.Valid()) {
+          window_path_ = WindowPath(window_selected_);
+          FALCON_UI_TRACE_SCOPE_DETAIL("SetupWindow", window_path_);
+          // The images of the theater, in the archives of its Art folder (see OpenArchives).
+          archives_wanted_ = WindowPath("art");
+          window_label_ = falcon_ui::FrameProfiler::Get().Label(window_path_);
+          file_watcher_.Watch(window_path_);
+          if (window_path_ == preview_path_ && preview_load_.Valid()) {
+              window_load_ = std::move(preview_load_);
+              // Unless started, it waits behind the other previews while the user now waits for it.
+              falcon_ui::JobSystem::Get().Reprioritize(window_load_, falcon_ui::JobPriority::INTERACTIVE);
+          } else {
+              preview_load_.Cancel();
+              window_load_ = LoadWindowJob(falcon_ui::JobPriority::INTERACTIVE, window_path_);
+          }
+          preview_path_.clear();
+      }
+      if (!window_load_.Ready()) {
+          ImGui::TextUnformatted("Loading...");
+          return;
+      }
+      window_ = window_load_.Get();
+  }
+
+  // Opens the archives of the Art folder of the picked window in a job, and hands them to the texture cache once open.
+  // Opening maps them and reads their index, the images are decoded by the texture cache as they are drawn. Called every
+  // frame: a theater picked while the archives of the previous one open has its own opened next.
+  void OpenArchives() {
+      if (archives_load_.Ready()) {
+          texture_cache_->SetArchives(archives_load_.Get());
+      }
+      if (archives_load_.Valid() || archives_wanted_ == archives_dir_) {
+          return;
+      }
+      archives_dir_ = archives_wanted_;
+      archives_load_ = falcon_ui::JobSystem::Get().Submit(falcon_ui::JobPriority::INTERACTIVE, [dir = archives_dir_](const falcon_ui::CancellationToken&) {
+          return falcon_ui::OpenResourceArchives(dir);
+      });
+  }
+
+  falcon_ui::JobFuture<falcon_ui::Window> LoadWindowJob(falcon_ui::JobPriority priority, const std::string& path) {
+      return falcon_ui::JobSystem::Get().Submit(priority, [this, path](const falcon_ui::CancellationToken& token) {
+          falcon_ui::Window window;
+          // Loads are not interrupted once started.
+          if (!token.Cancelled()) model_cache_.Load(path, window);
+          return window;
+      });
+  }
+
+  // Drops the cancelled loads which finished.
+  void PruneCancelledLoads() {
+      std::erase_if(cancelled_loads_, [](const falcon_ui::JobFuture<falcon_ui::Window>& load) { return load.Ready(); });
+  }
+
+  // ImGui changes what it draws without new input in a few cases, asks the scheduler for the frames they need.
+  void RequestImGuiFrames() {
+      const ImGuiIO& io = ImGui::GetIO();
+      // Dragging, holding a button...
+      if (ImGui::IsAnyItemActive() || ImGui::IsAnyMouseDown()) {
+          frame_scheduler_.RequestFrames(1);
+      }
+      // Tooltips show up once the mouse rests on an item for the hover delay.
+      const auto since_input = std::chrono::steady_clock::now() - frame_scheduler_.LastInputTime();
+      if (ImGui::IsAnyItemHovered() && since_input < std::chrono::duration<float>(io.HoverDelayNormal + 0.05f)) {
+          frame_scheduler_.RequestFrameIn(std::chrono::milliseconds(50));
+      }
+      // The text cursor blinks with a period of 1.2 s, visible for 0.8 s of it.
+      if (io.WantTextInput && io.ConfigInputTextCursorBlink) {
+          frame_scheduler_.RequestFrameIn(std::chrono::milliseconds(400));
+      }
+      // The usages, search and compare panels pick up the results of their background work, SetupWindow the loaded
+      // window, OpenArchives the archives and the texture cache the decoded images.
+      PruneCancelledLoads();
+      if ((show_usages_ && usages_panel_.Indexing()) || (show_text_search_ && text_search_panel_.Busy()) || (show_diff_ && diff_panel_.Comparing()) ||
+          window_load_.Valid() || !cancelled_loads_.empty() || archives_load_.Valid() || texture_cache_->Pending()) {
+          frame_scheduler_.RequestFrameIn(std::chrono::milliseconds(100));
+      }
+  }
+
+  // Re-reads the lists, re-indexes and re-parses the shown window when their files changed on disk. The new model
+  // replaces the old one only if it is good, so a half saved file keeps the last good version on screen. The shown
+  // window keeps no hold on its file (see SourceBuffer::Read), so editors may save it in place or replace it.
+  void ReloadChangedFiles() {
+      for (const auto& path : file_watcher_.PollChanges()) {
+          if (catalog_.Invalidate(path)) continue;
+          usages_panel_.OnFileChanged(path);
+          if (path != window_path_) continue;
+          falcon_ui::Window window;
+          model_cache_.Load(path, window);
+          if (window.Good()) window_ = std::move(window);
+      }
   }
 
   bool show_demo_window_ = true;
+  bool show_frame_timing_ = false;
+  bool show_usages_ = false;
+  bool show_text_search_ = false;
+  bool show_diff_ = false;
   ImVec4 clear_color_ = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
 
   SelectionState selected_install_state_;
@@ -400,26 +616,89 @@ private:
   std::string falcon_install_dir_;
   SelectionState selected_theater_state_;
   std::string falcon_theater_;
+  SelectionState selected_ui_set_state_;
   std::string ui_set_selected_;
   SelectionState selected_window_state_;
   std::string window_selected_;
   bool window_setup_done_ = false;
+  std::string window_path_;
+  // Names window_path_ in the frame timings.
+  uint32_t window_label_ = 0;
+  // The element DrawEditControls edits, and whether the last save failed.
+  int edit_element_ = 1;
+  bool save_failed_ = false;
   falcon_ui::Window window_;
+  falcon_ui::ModelCache model_cache_;
+  falcon_ui::FileWatcher file_watcher_;
+  // Declared after the watcher, which it uses until destroyed.
+  falcon_ui::DiscoveryCatalog catalog_{ &file_watcher_ };
+  falcon_ui::Win32FrameBackend frame_backend_;
+  falcon_ui::FrameScheduler frame_scheduler_{ frame_backend_, &file_watcher_ };
+  falcon_ui::FrameProfilerOverlay frame_profiler_overlay_;
+  // Declared after the cache, the destructors of the loads cancel them and wait for them.
+  falcon_ui::JobFuture<falcon_ui::Window> window_load_;
+  std::string preview_path_;
+  falcon_ui::JobFuture<falcon_ui::Window> preview_load_;
+  std::vector<falcon_ui::JobFuture<falcon_ui::Window>> cancelled_loads_;
+  // Declared after the cache and the watcher, its destructor cancels the indexing which uses them and waits for it.
+  falcon_ui::UsagesPanel usages_panel_{ &file_watcher_, &model_cache_ };
+  falcon_ui::DiffPanel diff_panel_{ &model_cache_ };
+  falcon_ui::TextSearchPanel text_search_panel_{ falcon_ui::ModelCache::DefaultDirectory() / "text_search.f4ti" };
+  // Created with the D3D device, and destroyed before it.
+  std::unique_ptr<falcon_ui::D3D11TextureBackend> texture_backend_;
+  std::unique_ptr<falcon_ui::TextureCache> texture_cache_;
+  // The Art folder of the picked window, and the one texture_cache_ has the archives of or archives_load_ opens.
+  std::string archives_wanted_;
+  std::string archives_dir_;
+  falcon_ui::JobFuture<std::vector<std::shared_ptr<const falcon_ui::ResourceArchive>>> archives_load_;
 
   HWND hwnd_ = nullptr;
 };
+#endif  // _WIN32
+
+
+#ifdef _WIN32
+// The editor links for the Windows subsystem, so it starts without a console: the validation writes to the one of the
+// command prompt it was started from. Streams redirected to a file or a pipe are kept. cmd does not wait for Windows
+// subsystem programs, use start /wait to get the exit code (CI runners and PowerShell pipelines wait).
+void AttachParentConsole() {
+  const bool out_missing = _fileno(stdout) < 0;
+  const bool err_missing = _fileno(stderr) < 0;
+  if ((!out_missing && !err_missing) || !AttachConsole(ATTACH_PARENT_PROCESS)) return;
+  FILE* stream = nullptr;
+  if (out_missing && freopen_s(&stream, "CONOUT$", "w", stdout) == 0) std::cout.clear();
+  if (err_missing && freopen_s(&stream, "CONOUT$", "w", stderr) == 0) std::cerr.clear();
+}
+#endif
 
-
-// This is the main UI entry (factory). It is the one which picks which UI it should start.
+// This is the main UI entry (factory). It is the one which picks which UI it should start: the editor, or the headless
+// validation with --validate (see HeadlessUI.h), which is the only one outside Windows.
 std::unique_ptr<GenericUI> CreateUI(int argc, char** argv) {
-  return std::make_unique<WindowUI>();
+#ifdef _WIN32
+  if (!falcon_ui::HeadlessUI::Requested(argc, argv)) return std::make_unique<WindowUI>();
+  AttachParentConsole();
+#endif
+  return std::make_unique<falcon_ui::HeadlessUI>(argc, argv);
 }
 
 }  // namespace
 
 
 int main(int argc, char** argv) {
+  // --trace <file>: records the session into file as a Chrome trace (open it in chrome://tracing or ui.perfetto.dev).
+  std::string trace_path;
+  for (int i = 1; i + 1 < argc; ++i) {
+    if (std::string_view(argv[i]) == "--trace") trace_path = argv[i + 1];
+  }
+  FALCON_UI_TRACE_THREAD_NAME("UI");
+  if (!trace_path.empty()) falcon_ui::Tracer::Get().Start();
+
   auto ifg = CreateUI(argc, argv);
   ifg->Run();
-  return 0;
+
+  if (!trace_path.empty()) {
+    falcon_ui::Tracer::Get().Stop();
+    if (!falcon_ui::Tracer::Get().WriteJsonFile(trace_path)) std::cerr << "Unable to write the trace to " << trace_path << std::endl;
+  }
+  return ifg->ExitCode();
 }
\ No newline at end of file